@@ -12,15 +12,28 @@
 #define TUNE_MODE_MIDGAME true
 #define TUNE_PROBCUT false
 #define USE_SIMD false
+// defaults of SearchOptions, which Engine::set_search_options changes at runtime
 #define USE_MPC true
 #define USE_ETC true
 #define LOCK_TT false
+#define COLLECT_TELEMETRY false
+#define USE_ASPIRATION true
+#define USE_OPENING_BOOK true
+#define USE_WLD_SEARCH true
+
+// set by CMake. Without libtorch, the evaluation can only be trained with EvalBuilder::train_sparse
+#ifndef USE_TORCH
+#define USE_TORCH true
+#endif
 
-constexpr int ETC_DEPTH = 14;
-constexpr int MPC_DEPTH = 20;
+constexpr int ETC_DEPTH = 14;  // default of SearchOptions::etcDepth
+constexpr int MPC_DEPTH = 20;  // deepest node ProbCut can be calibrated for, and the default of SearchOptions::mpcDepth
 
 constexpr int MAX_MPC_LEVEL = 5;
 
+// ProbCut samples a thread collects before appending them to the sample file
+constexpr size_t PROBCUT_BUFFER_SIZE = 1024;
+
 constexpr int MPC_LEVEL_74 = 0;
 constexpr int MPC_LEVEL_88 = 1;
 constexpr int MPC_LEVEL_93 = 2;
@@ -56,6 +69,8 @@ constexpr int HASH_BITS = 28;
 constexpr int MID_TO_END_DEPTH = 13;
 constexpr int END_SEARCH_DEPTH = 20;
 constexpr int PERFECT_SEARCH_DEPTH = 16;
+constexpr int WLD_SEARCH_DEPTH = 20;  // empties at which the outcome is proven, without ProbCut, before the exact score
+constexpr int WLD_PRESEARCH_DEPTH = 10;  // deepest selective iteration searched before the outcome is proven
 constexpr int END_FAST_DEPTH = 0;
 
 constexpr int HASH_MOVE_VALUE = 1000000;
@@ -65,6 +80,38 @@ constexpr int SECOND_HASH_MOVE_SCORE = 1000000;
 
 constexpr uint8_t MAX_DEPTH = 64;
 
+// number of nodes between clock reads while searching
+constexpr int SEARCH_POLL_INTERVAL = 256;
+
+// iterative deepening searches the root with a window around the previous iteration's value from this depth on
+constexpr int ASPIRATION_DEPTH = 5;
+constexpr int ASPIRATION_WINDOW = 4;
+
+// opening book: moves from the start of each logbook game that go in the book, and games needed for a book move
+constexpr int BOOK_MAX_PLY = 20;
+constexpr int BOOK_MIN_COUNT = 3;
+
+// training datasets are decoded in chunks of consecutive games, and the positions of a phase are trained on in chunks of
+// consecutive positions, with batches built ahead of the optimizer
+constexpr uint64_t TRAINING_CHUNK_SIZE = 1024;
+constexpr uint64_t POSITION_CHUNK_SIZE = 4096;
+constexpr int DATA_LOADER_THREADS = 4;
+constexpr int BATCH_QUEUE_CAPACITY = 4;
+
+// deduplicating a dataset sorts one bucket of about this many bytes of positions in memory per thread. Every bucket
+// file is open at once while the positions are scattered
+constexpr uint64_t DEDUP_BUCKET_SIZE = 256ULL << 20;
+constexpr uint64_t DEDUP_MAX_BUCKETS = 512;
+
+// combining batches shuffles one bucket of about this many bytes of games in memory per thread. Every bucket file is
+// open at once while the games are scattered, each with a buffer of SHUFFLE_BUFFER_SIZE bytes per thread
+constexpr uint64_t SHUFFLE_BUCKET_SIZE = 256ULL << 20;
+constexpr uint64_t SHUFFLE_MAX_BUCKETS = 512;
+constexpr uint64_t SHUFFLE_BUFFER_SIZE = 64ULL << 10;
+
+// transcripts are ingested into feature batches of this many games, which are parsed in parallel
+constexpr uint64_t TRANSCRIPT_CHUNK_SIZE = 4096;
+
 // pass move coordinates. This move should never be
 // legal since the center 4 squares start occupied.
 constexpr uint8_t I_PASS = 27;
@@ -79,7 +126,8 @@ constexpr uint64_t LEGAL_UNDEFINED = 1ULL << 28;
 // A bitboard of squares that can be legal moves (every square but the middle 4)
 constexpr uint64_t POSSIBLE_LEGALS = 0xffffffe7e7ffffff;
 
-#define MPC_DATA_FILEPATH "/Users/benjaminlee/Desktop/Othello/assets/ProbCut/mpc.txt"
+#define MPC_DATA_FILEPATH "/Users/benjaminlee/Desktop/Othello/assets/ProbCut/mpc.bin"
+#define PROBCUT_PARAMS_FILEPATH "/Users/benjaminlee/Desktop/Othello/assets/ProbCut/probcut.txt"
 #define LOGBOOK_FILEPATH "/Users/benjaminlee/Desktop/Othello/assets/Evaluation/logbook.gam"
 
 #define TORCH_MODEL_DIRECTORY "/Users/benjaminlee/Desktop/Othello/assets/Evaluation/Torch Models/"
@@ -92,9 +140,16 @@ constexpr uint64_t POSSIBLE_LEGALS = 0xffffffe7e7ffffff;
 #define WEIGHT_DIRECTORY "/Users/benjaminlee/Desktop/Othello/assets/Evaluation/"
 #define TRANSCRIPT_DIRECTORY "/Users/benjaminlee/Desktop/Othello/assets/Evaluation/Transcripts/"
 #define BINARY_DATASET_DIRECTORY "/Users/benjaminlee/Desktop/Othello/assets/Evaluation/Binary Datasets/"
+#define TRANSCRIPT_MANIFEST_FILEPATH BINARY_DATASET_DIRECTORY "manifest.txt"
 #define COMBINED_DATASET_DIRECTORY "/Users/benjaminlee/Desktop/Othello/assets/Evaluation/Binary Datasets New/"
+#define MOVE_DATASET_EXTENSION ".moves"
+#define POSITION_STORE_EXTENSION ".positions"
+#define POSITION_DATASET_EXTENSION ".unique"
 #define LOSS_DIRECTORY "/Users/benjaminlee/Desktop/Othello/assets/Evaluation/Losses/"
 #define HASH_FILE "/Users/benjaminlee/Desktop/Othello/assets/Hash/hash.txt"
+#define BOOK_FILEPATH "/Users/benjaminlee/Desktop/Othello/assets/Book/book.bin"
+#define TELEMETRY_FILEPATH "/Users/benjaminlee/Desktop/Othello/assets/Telemetry/telemetry.jsonl"
+#define OPENINGS_FILEPATH "/Users/benjaminlee/Desktop/Othello/assets/Openings/openings.txt"
 
 
 #endif //OTHELLO_CONST_H
@@ -0,0 +1,322 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "OpeningBook.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../Bit.h"
+#include "../../Game/WthorDatabase.h"
+
+namespace engine {
+    constexpr char BOOK_MAGIC[4] = {'O', 'B', 'K', '1'};
+    constexpr uint32_t BOOK_VERSION = 1;
+
+    OpeningBook::~OpeningBook() {
+        this->unload();
+    }
+
+    void OpeningBook::unload() {
+        if (this->mapping != nullptr)
+            munmap(this->mapping, this->mappingSize);
+        this->mapping = nullptr;
+        this->mappingSize = 0;
+        this->buckets = nullptr;
+        this->entries = nullptr;
+        this->numEntries = 0;
+        this->numBucketBits = 0;
+    }
+
+    bool OpeningBook::load(const std::string &filepath) {
+        this->unload();
+
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "could not open opening book " << filepath << std::endl;
+            return false;
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+            std::cerr << "invalid opening book " << filepath << std::endl;
+            close(fd);
+            return false;
+        }
+
+        auto size = (size_t)st.st_size;
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            std::cerr << "could not map opening book " << filepath << std::endl;
+            return false;
+        }
+
+        auto header = (const Header *)data;
+        auto numBuckets = header->numBucketBits < 32 ? (size_t)1 << header->numBucketBits : 0;
+        auto expectedSize = sizeof(Header) + (numBuckets + 1) * sizeof(uint32_t) + (size_t)header->numEntries * sizeof(Entry);
+        if (std::memcmp(header->magic, BOOK_MAGIC, 4) != 0 || header->version != BOOK_VERSION ||
+            numBuckets == 0 || size != expectedSize) {
+            std::cerr << "invalid opening book " << filepath << std::endl;
+            munmap(data, size);
+            return false;
+        }
+
+        this->mapping = data;
+        this->mappingSize = size;
+        this->numEntries = header->numEntries;
+        this->numBucketBits = header->numBucketBits;
+        this->buckets = (const uint32_t *)((const char *)data + sizeof(Header));
+        this->entries = (const Entry *)(this->buckets + numBuckets + 1);
+        return true;
+    }
+
+    bool OpeningBook::probe(const Board &board, BookMove *result) const {
+        if (this->entries == nullptr)
+            return false;
+
+        int symmetry;
+        auto canonical = OpeningBook::canonicalize(board, &symmetry);
+        auto bucket = OpeningBook::get_bucket(canonical.P, canonical.O, this->numBucketBits);
+
+        for (auto i = this->buckets[bucket]; i < this->buckets[bucket + 1]; ++i) {
+            auto &entry = this->entries[i];
+            if (entry.P == canonical.P && entry.O == canonical.O) {
+                auto moveMask = OpeningBook::transform(1ULL << entry.move, symmetry, true);
+                if (!(board.get_legal_moves() & moveMask))
+                    return false;  // only possible with a corrupt book
+
+                result->move = bit::bitboard_to_coord(moveMask);
+                result->score = entry.score;
+                result->count = entry.count;
+                result->depth = entry.depth;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t OpeningBook::transform(uint64_t bitboard, int symmetry, bool inverse) {
+        switch (symmetry) {
+            case 1:
+                return inverse ? bit::rotate_270(bitboard) : bit::rotate_90(bitboard);
+            case 2:
+                return bit::rotate_180(bitboard);
+            case 3:
+                return inverse ? bit::rotate_90(bitboard) : bit::rotate_270(bitboard);
+            case 4:
+                return bit::mirror_horizontal(bitboard);
+            case 5:
+                return bit::mirror_vertical(bitboard);
+            case 6:
+                return bit::mirror_d7(bitboard);
+            case 7:
+                return bit::mirror_d9(bitboard);
+            default:
+                return bitboard;
+        }
+    }
+
+    Board OpeningBook::canonicalize(const Board &board, int *symmetry) {
+        Board best = board;
+        *symmetry = 0;
+        for (int s = 1; s < 8; ++s) {
+            Board b(OpeningBook::transform(board.P, s), OpeningBook::transform(board.O, s));
+            if (b.P < best.P || (b.P == best.P && b.O < best.O)) {
+                best = b;
+                *symmetry = s;
+            }
+        }
+        return best;
+    }
+
+    uint_fast8_t OpeningBook::canonicalize_move(const Board &board, const Board &canonical, uint_fast8_t x) {
+        uint_fast8_t best = 64;
+        for (int s = 0; s < 8; ++s) {
+            if (OpeningBook::transform(board.P, s) != canonical.P || OpeningBook::transform(board.O, s) != canonical.O)
+                continue;
+            auto y = (uint_fast8_t)std::countr_zero(OpeningBook::transform(1ULL << x, s));
+            best = std::min(best, y);
+        }
+        return best;
+    }
+
+    struct BoardHash {
+        size_t operator()(const std::pair<uint64_t, uint64_t> &b) const {
+            return OpeningBook::get_bucket(b.first, b.second, 63);
+        }
+    };
+
+    struct MoveStats {
+        uint8_t move;
+        uint32_t count;
+        long long scoreSum;
+    };
+
+    bool OpeningBook::build(const std::string &logbookPath, const std::string &filepath, int maxPly, int minCount) {
+        // collect every (canonical position, move) pair of the first maxPly moves, with the final score of each game
+        std::unordered_map<std::pair<uint64_t, uint64_t>, std::vector<MoveStats>, BoardHash> positions;
+        int numGames = 0;
+        auto addGame = [&](const uint8_t *squares, int numMoves, int blackScore) {
+            Board board;
+            bool blackToMove = true;
+            for (int i = 0; i < numMoves && i < maxPly; ++i) {
+                if (board.get_legal_moves() == 0) {
+                    board.pass();
+                    blackToMove = !blackToMove;
+                }
+
+                uint_fast8_t x = squares[i];
+                if (x >= 64 || !(board.get_legal_moves() & (1ULL << x)))
+                    break; // corrupt transcript, keep what we have so far
+
+                int symmetry;
+                auto canonical = OpeningBook::canonicalize(board, &symmetry);
+                auto move = OpeningBook::canonicalize_move(board, canonical, x);
+                auto score = blackToMove ? blackScore : -blackScore;
+
+                auto &moves = positions[{canonical.P, canonical.O}];
+                auto it = std::find_if(moves.begin(), moves.end(), [move](const MoveStats &m) {
+                    return m.move == move;
+                });
+                if (it == moves.end())
+                    moves.push_back({(uint8_t)move, 1, score});
+                else {
+                    ++it->count;
+                    it->scoreSum += score;
+                }
+
+                board.play_move(Move(board, x));
+                blackToMove = !blackToMove;
+            }
+            ++numGames;
+        };
+
+        auto extension = logbookPath.size() >= 4 ? logbookPath.substr(logbookPath.size() - 4) : "";
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension == ".wtb") {
+            WthorDatabase database;
+            if (!database.load(logbookPath))
+                return false;
+
+            uint8_t squares[WthorDatabase::MAX_MOVES];
+            for (uint64_t g = 0; g < database.size(); ++g) {
+                auto game = database.get_game(g);
+                addGame(squares, WthorDatabase::decode(game, squares), game.get_disc_difference());
+            }
+        } else {
+            std::ifstream logbook(logbookPath);
+            if (!logbook) {
+                std::cerr << "could not open logbook " << logbookPath << std::endl;
+                return false;
+            }
+
+            std::string line;
+            while (std::getline(logbook, line)) {
+                auto colon = line.find(':');
+                if (colon == std::string::npos)
+                    continue;
+                int blackScore;
+                try {
+                    blackScore = std::stoi(line.substr(colon + 1));
+                } catch (const std::exception &) {
+                    continue;
+                }
+
+                uint8_t squares[WthorDatabase::MAX_MOVES];
+                int numMoves = 0;
+                std::string moveSequence;
+                for (char c: line.substr(0, colon))
+                    if (c != '+' && c != '-')
+                        moveSequence += c;
+                for (size_t i = 0; i + 1 < moveSequence.size() && numMoves < WthorDatabase::MAX_MOVES; i += 2)
+                    squares[numMoves++] = std::tolower(moveSequence[i]) - 'a' + ((moveSequence[i + 1] - '1') << 3);
+
+                addGame(squares, numMoves, blackScore);
+            }
+        }
+
+        // keep the best scoring move of each position among the moves that were played often enough
+        std::vector<Entry> entries;
+        for (auto &[key, moves]: positions) {
+            const MoveStats *best = nullptr;
+            for (auto &m: moves) {
+                if ((int)m.count < minCount)
+                    continue;
+                if (best == nullptr || m.scoreSum * best->count > best->scoreSum * m.count ||
+                    (m.scoreSum * best->count == best->scoreSum * m.count && m.count > best->count))
+                    best = &m;
+            }
+            if (best == nullptr)
+                continue;
+
+            auto score = (int)std::lround((double)best->scoreSum / best->count);
+            entries.push_back({key.first, key.second, best->count, best->move,
+                               (int8_t)std::clamp(score, -SCORE_MAX, SCORE_MAX), 0, 0});
+        }
+
+        std::cout << "opening book: " << numGames << " games, " << positions.size() << " positions, "
+                  << entries.size() << " book moves" << std::endl;
+        return OpeningBook::write(filepath, entries);
+    }
+
+    bool OpeningBook::read(const std::string &filepath, std::vector<Entry> &entries) {
+        OpeningBook book;
+        if (!book.load(filepath))
+            return false;
+        entries.assign(book.entries, book.entries + book.numEntries);
+        return true;
+    }
+
+    bool OpeningBook::write(const std::string &filepath, std::vector<Entry> entries) {
+        // about one entry per bucket
+        uint32_t numBucketBits = std::max(1, (int)std::bit_width(entries.size()));
+        std::sort(entries.begin(), entries.end(), [numBucketBits](const Entry &a, const Entry &b) {
+            auto ba = OpeningBook::get_bucket(a.P, a.O, numBucketBits);
+            auto bb = OpeningBook::get_bucket(b.P, b.O, numBucketBits);
+            if (ba != bb)
+                return ba < bb;
+            return a.P < b.P || (a.P == b.P && a.O < b.O);
+        });
+
+        std::vector<uint32_t> buckets(((size_t)1 << numBucketBits) + 1, 0);
+        for (auto &entry: entries)
+            ++buckets[OpeningBook::get_bucket(entry.P, entry.O, numBucketBits) + 1];
+        for (size_t i = 1; i < buckets.size(); ++i)
+            buckets[i] += buckets[i - 1];
+
+        // write a temporary file and rename it over the book, so a reader never sees a partial book
+        auto tmpFilepath = filepath + ".tmp";
+        std::ofstream out(tmpFilepath, std::ios::binary);
+        if (!out) {
+            std::cerr << "could not write opening book " << tmpFilepath << std::endl;
+            return false;
+        }
+        Header header{};
+        std::memcpy(header.magic, BOOK_MAGIC, 4);
+        header.version = BOOK_VERSION;
+        header.numEntries = (uint32_t)entries.size();
+        header.numBucketBits = numBucketBits;
+        out.write((const char *)&header, sizeof(Header));
+        out.write((const char *)buckets.data(), (std::streamsize)(buckets.size() * sizeof(uint32_t)));
+        out.write((const char *)entries.data(), (std::streamsize)(entries.size() * sizeof(Entry)));
+        out.close();
+
+        if (!out || std::rename(tmpFilepath.c_str(), filepath.c_str()) != 0) {
+            std::cerr << "could not write opening book " << filepath << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,156 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_OPENINGBOOK_H
+#define OTHELLO_OPENINGBOOK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../Const.h"
+#include "../../Game/Board.h"
+
+namespace engine {
+
+    /**
+     * @brief a book reply to a position
+     */
+    struct BookMove {
+        uint_fast8_t move = I_PASS;  // square to play
+        int score = 0;               // value of the move for the side to move: a search value or the mean final score
+        uint32_t count = 0;          // number of games that played the move
+        int depth = 0;               // depth of the search that scored the move, or 0 if the score comes from games
+    };
+
+    /**
+     * @brief read-only opening book, memory-mapped from a file built by OpeningBook::build.
+     *
+     * Positions are stored in a canonical orientation (the smallest of the 8 symmetries), so transpositions and
+     * mirrored openings share an entry. The file is a header, a bucket index and the entries sorted by bucket, so a
+     * lookup hashes the canonical board and scans a single bucket that holds about one entry.
+     */
+    class OpeningBook {
+    public:
+        OpeningBook() = default;
+        ~OpeningBook();
+
+        OpeningBook(const OpeningBook&) = delete;
+        OpeningBook& operator=(const OpeningBook&) = delete;
+
+        /**
+         * @brief memory-map a book file
+         * @param filepath: path of the book file
+         * @return whether the book was loaded
+         */
+        bool load(const std::string &filepath = BOOK_FILEPATH);
+
+        /**
+         * @brief look up the book move of a position
+         * @param board: the position, from the point of view of the side to move
+         * @param result: receives the book move if there is one
+         * @return whether the position is in the book
+         */
+        bool probe(const Board &board, BookMove *result) const;
+
+        [[nodiscard]] inline bool is_loaded() const {
+            return this->entries != nullptr;
+        }
+
+        [[nodiscard]] inline uint32_t size() const {
+            return this->numEntries;
+        }
+
+        /**
+         * @brief build a book file from a logbook of expert games
+         * @param logbookPath: games in the format +d3-c5+f6...:+12, scored for black, or a WTHOR database (.wtb)
+         * @param filepath: path of the book file to write
+         * @param maxPly: number of moves from the start of each game that are added to the book
+         * @param minCount: minimum number of games that must have played a move for it to be a book move
+         * @return whether the book was written
+         */
+        static bool build(const std::string &logbookPath = LOGBOOK_FILEPATH, const std::string &filepath = BOOK_FILEPATH,
+                          int maxPly = BOOK_MAX_PLY, int minCount = BOOK_MIN_COUNT);
+
+        /**
+         * @brief orient a position canonically
+         * @param board: the position
+         * @param symmetry: receives the symmetry that maps the position to its canonical orientation
+         * @return the canonical position
+         */
+        static Board canonicalize(const Board &board, int *symmetry);
+
+        /**
+         * @brief map a move to the canonical orientation. Positions with symmetries of their own have several
+         * equivalent moves, so the smallest one is used to keep them in a single entry.
+         * @param board: the position
+         * @param canonical: the canonical position, as returned by canonicalize
+         * @param x: the move on the original board
+         * @return the move on the canonical board
+         */
+        static uint_fast8_t canonicalize_move(const Board &board, const Board &canonical, uint_fast8_t x);
+
+        /**
+         * @brief apply one of the 8 board symmetries to a bitboard
+         * @param bitboard: the bitboard to transform
+         * @param symmetry: index of the symmetry, 0 being the identity
+         * @param inverse: apply the inverse of the symmetry instead
+         * @return the transformed bitboard
+         */
+        static uint64_t transform(uint64_t bitboard, int symmetry, bool inverse = false);
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint32_t numEntries;
+            uint32_t numBucketBits;
+        };
+
+        struct Entry {
+            uint64_t P;
+            uint64_t O;
+            uint32_t count;
+            uint8_t move;     // in the canonical orientation
+            int8_t score;
+            uint8_t depth;
+            uint8_t padding;
+        };
+
+        /**
+         * @brief read every entry of a book file
+         * @param filepath: path of the book file
+         * @param entries: receives the entries
+         * @return whether the book was read
+         */
+        static bool read(const std::string &filepath, std::vector<Entry> &entries);
+
+        /**
+         * @brief write a book file. The file is replaced atomically, so it can be rewritten while engines use it.
+         * @param filepath: path of the book file
+         * @param entries: the entries, in any order
+         * @return whether the book was written
+         */
+        static bool write(const std::string &filepath, std::vector<Entry> entries);
+
+        static inline uint32_t get_bucket(uint64_t P, uint64_t O, uint32_t numBucketBits) {
+            // splitmix64 finalizer
+            uint64_t h = P * 0x9E3779B97F4A7C15ULL ^ O;
+            h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+            h ^= h >> 31;
+            return (uint32_t)(h >> (64 - numBucketBits));
+        }
+
+    private:
+        void unload();
+
+        void *mapping = nullptr;
+        size_t mappingSize = 0;
+        const uint32_t *buckets = nullptr;
+        const Entry *entries = nullptr;
+        uint32_t numEntries = 0;
+        uint32_t numBucketBits = 0;
+    };
+}
+
+#endif //OTHELLO_OPENINGBOOK_H
@@ -4,116 +4,169 @@
 
 #include "Engine.h"
 #include <thread>
+#include <fstream>
+#include <mutex>
+#include <cmath>
 
 namespace engine {
     SearchResult Engine::search(const Game &game, double maxTime, Verbose verbose) {
-        // set up timing
+        SearchLimits limits(maxTime);
+        return this->search(game, limits, verbose);
+    }
+
+    SearchResult Engine::search(const Game &game, SearchLimits &limits, Verbose verbose,
+                                const SearchProgressCallback &callback) {
         auto search = SearchNode(game.get_bitboard());
         bool passed = game.get_last_move().is_pass();
         constexpr auto showProgressModes = Verbose::ALL | Verbose::PROGRESS;
 
-        // make timer thread
-        bool *running = new bool(true);
-        bool *completed = new bool(false);
-        Engine::make_timer_thread(maxTime, running).detach();
+        search.start();
+        if (this->play_book_move(&search)) {
+            auto result = SearchResult(&search);
+            print_stats(result, verbose);
+            return result;
+        }
 
         // obtain search results from an iterative deepening search
+        auto result = iterative_deepening_search(&search, passed, verbose & showProgressModes, &limits, nullptr, callback);
+
+        print_stats(result, verbose);
+        return result;
+    }
+
+    std::future<SearchResult> Engine::search_async(const Game &game, std::shared_ptr<SearchLimits> limits,
+                                                   SearchProgressCallback callback) {
+        return this->get_search_thread().submit([this, game, limits = std::move(limits), callback = std::move(callback)]() {
+            this->update();
+            return this->search(game, *limits, Verbose::NONE, callback);
+        });
+    }
+
+    ThreadPool &Engine::get_search_thread() {
+        std::call_once(this->searchThreadFlag, [this]() {
+            this->searchThread = std::make_unique<ThreadPool>(1);
+        });
+        return *this->searchThread;
+    }
+
+    SearchResult Engine::search(const Game &game, const GameClock &clock, Verbose verbose) {
+        auto search = SearchNode(game.get_bitboard());
+        bool passed = game.get_last_move().is_pass();
+        constexpr auto showProgressModes = Verbose::ALL | Verbose::PROGRESS;
+
+        SearchLimits limits;
+        TimeManager timeManager(clock, search.discCount);
+
         search.start();
-        auto result = iterative_deepening_search(&search,
-                                                 MAX_DEPTH, passed,
-                                                 verbose & showProgressModes,
-                                                 running, completed);
-        if (*running)
-            *running = false;
-        else {
-            delete running;
+        if (this->play_book_move(&search)) {
+            auto result = SearchResult(&search);
+            print_stats(result, verbose);
+            return result;
         }
-
-        delete completed;
+        timeManager.start(limits);
+        auto result = iterative_deepening_search(&search, passed, verbose & showProgressModes, &limits, &timeManager);
 
         print_stats(result, verbose);
         return result;
     }
 
     SearchResult Engine::search(SearchNode* search, bool passed, double maxTime, Verbose verbose) {
-        // set up timing
         constexpr auto showProgressModes = Verbose::ALL | Verbose::PROGRESS;
-
-        // make timer thread
-        bool *running = new bool(true);
-        bool *completed = new bool(false);
-        Engine::make_timer_thread(maxTime, running).detach();
+        SearchLimits limits(maxTime);
 
         // obtain search results from an iterative deepening search
         search->start();
-        auto result = iterative_deepening_search(search,
-                                                 MAX_DEPTH, passed,
-                                                 verbose & showProgressModes,
-                                                 running, completed);
-        if (*running)
-            *running = false;
-        else {
-            delete running;
-        }
-
-        delete completed;
+        auto result = iterative_deepening_search(search, passed, verbose & showProgressModes, &limits);
 
         print_stats(result, verbose);
         return result;
     }
 
-    SearchTask* Engine::search_task(const Game &game, Verbose verbose) {
-        auto task = new SearchTask(game);
+    std::unique_ptr<SearchTask> Engine::search_task(const Game &game, Verbose verbose) {
+        auto task = std::make_unique<SearchTask>(game);
         auto passed = game.get_last_move().is_pass();
-        this->continue_search_task(task, passed, verbose);
+        this->continue_search_task(task.get(), passed, verbose);
         return task;
     }
 
     void Engine::continue_search_task(engine::SearchTask *task, bool passed, engine::Engine::Verbose verbose) {
-        if (task->search->board.get_disc_count() > 40)
-            task->search->isEndgame = true;
+        this->continue_search_task_timed(task, passed, std::numeric_limits<double>::infinity(), verbose);
+    }
+
+    void Engine::continue_search_task_timed(engine::SearchTask *task, bool passed, double maxTime, engine::Engine::Verbose verbose) {
+        this->run_search_task(task, passed, maxTime, std::nullopt, verbose);
+    }
+
+    void Engine::continue_search_task_clocked(engine::SearchTask *task, bool passed, const GameClock &clock, engine::Engine::Verbose verbose) {
+        this->run_search_task(task, passed, std::numeric_limits<double>::infinity(), clock, verbose);
+    }
+
+    void Engine::run_search_task(SearchTask *task, bool passed, double maxTime, std::optional<GameClock> clock,
+                                 Verbose verbose) {
+        // stop the previous run and queue the new one on the search thread, so that this never blocks
+        auto run = task->schedule(maxTime);
 
-        auto thread = std::thread([task, verbose, this, passed]() {
+        this->get_search_thread().submit([task, run, verbose, this, passed, maxTime, clock]() {
             constexpr auto showProgressModes = Verbose::ALL | Verbose::PROGRESS;
-            std::cout << "continuing search..." << std::endl;
-            // wait for the previous search to finish
-            while (!*task->completed) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (!task->begin(run)) {
+                task->finish(run, task->get_result());
+                return;
             }
+            std::cout << "continuing search..." << std::endl;
 
+            auto node = task->search.get();
+            if (node->board.get_disc_count() > 40)
+                node->isEndgame = true;
             this->update();
 
+            // searches that have to return a move play from the book when they can. Open-ended analysis searches don't.
+            bool isBookMove = (clock || std::isfinite(maxTime)) && this->play_book_move(node);
+            std::unique_ptr<TimeManager> timeManager;
+            if (clock && !isBookMove) {
+                timeManager = std::make_unique<TimeManager>(*clock, node->discCount);
+                timeManager->start(*run.limits);
+            }
+
             // obtain search results from an iterative deepening search
-            task->start();
-            auto result = iterative_deepening_search(task->search,
-                                                     MAX_DEPTH, passed,
-                                                     verbose & showProgressModes,
-                                                     task->running, task->completed);
-            task->stop();
+            auto result = isBookMove ? task->get_result()
+                                     : iterative_deepening_search(node, passed, verbose & showProgressModes,
+                                                                  run.limits.get(), timeManager.get(),
+                                                                  [task, &run](const SearchResult &progress) {
+                                                                      task->report(run, progress);
+                                                                  });
             print_stats(result, verbose);
 
-            // enable next search
-            task->complete();
+            // publish the result, which also lets the next run start
+            task->finish(run, result);
             std::cout << "async search completed" << std::endl;
         });
-        thread.detach();
     }
 
-    void Engine::continue_search_task_timed(engine::SearchTask *task, bool passed, double maxTime, engine::Engine::Verbose verbose) {
-        this->continue_search_task(task, passed, verbose);
-        Engine::make_timer_thread(maxTime, task->running, false).detach();
+    bool Engine::load_opening_book(const std::string &filepath) {
+        auto book = std::make_shared<OpeningBook>();
+        if (!book->load(filepath))
+            return false;
+        std::cout << "loaded opening book with " << book->size() << " positions" << std::endl;
+        this->openingBook = book;
+        return true;
+    }
+
+    bool Engine::play_book_move(SearchNode *node) {
+        BookMove bookMove;
+        if (!this->probe_opening_book(node->board, &bookMove))
+            return false;
+
+        node->move = Move(node->board, bookMove.move);
+        node->value = bookMove.score;
+        node->depth = 0;
+        node->stop();
+        return true;
     }
 
     SearchResult Engine::search_to_depth(const Game &game, int depth, Verbose verbose, double maxTime) {
         auto search = SearchNode(game.get_bitboard());
-        auto running = new bool(true);
-        auto completed = new bool(false);
-        Engine::make_timer_thread(maxTime, running).detach();
-        auto result = this->iterative_deepening_search(&search, depth, game.get_last_move().is_pass(), verbose,
-                                                       running, completed);
-        delete running;
-        delete completed;
-        return result;
+        SearchLimits limits(maxTime, depth);
+        return this->iterative_deepening_search(&search, game.get_last_move().is_pass(), verbose, &limits);
     }
 
     void Engine::print_stats(SearchResult &result, Verbose verbose) {
@@ -129,7 +182,9 @@ namespace engine {
             std::cout << "\033[1mSearch Results:\033[0m\n";
             if (verbose & showValueModes) {
                 std::cout << "\t\033[3mValue:\t\t\t\033[0m";
-                if (result.value >= WIN)
+                if (result.mode == SearchMode::WLD)
+                    std::cout << (result.value > 0 ? "proven win" : "proven loss") << '\n';
+                else if (result.value >= WIN)
                     std::cout << "win by " << result.value - WIN << '\n';
                 else if (result.value <= LOSS)
                     std::cout << "lose by " << LOSS - result.value << '\n';
@@ -157,32 +212,28 @@ namespace engine {
         }
     }
 
+#if COLLECT_TELEMETRY
+    /**
+     * @brief append the per-iteration telemetry of a search to a JSON lines file
+     * @param root: the root position of the search
+     * @param result: the search result
+     * @param filepath: the file to append to
+     */
+    void Engine::export_telemetry(const Board &root, const SearchResult &result, const std::string &filepath) {
+        static std::mutex fileMtx;
+        std::lock_guard<std::mutex> lock(fileMtx);
+
+        std::ofstream file(filepath, std::ios::app);
+        if (!file.is_open()) {
+            std::cerr << "Error: could not open file " << filepath << std::endl;
+            return;
+        }
 
-    std::thread Engine::make_timer_thread(double duration, bool*& running, bool deleteRunningOnCompletion, bool waitToStart) {
-        if (running == nullptr)
-            running = new bool(true);
-        std::thread timer([running, duration, deleteRunningOnCompletion, waitToStart] {
-            // wait for the search to start
-            if (waitToStart) {
-                while (!*running) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                }
-            }
-
-            auto endTime = std::chrono::high_resolution_clock::now() + std::chrono::duration<double>(duration);
-
-            while (*running && std::chrono::high_resolution_clock::now() < endTime) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(5));
-            }
-
-            if (*running)
-                *running = false;
-
-            else if (deleteRunningOnCompletion)
-                delete running;
-        });
-
-        return timer;
+        for (auto &iteration: result.telemetry) {
+            file << "{\"P\":\"" << std::hex << root.P << "\",\"O\":\"" << root.O << std::dec << "\",\"iteration\":";
+            iteration.write_json(file);
+            file << "}\n";
+        }
     }
-
+#endif
 }
\ No newline at end of file
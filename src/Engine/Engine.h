@@ -8,19 +8,38 @@
 #include "../Game/Game.h"
 #include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include "../Const.h"
 #include "Masks.h"
 #include "Search/SearchStructs.h"
 #include "Evaluation/Evaluation.h"
 #include "Evaluation/StaticEvaluations.h"
 #include "Search/TranspositionTable.h"
+#include "Search/SearchOptions.h"
+#include "Search/TimeManager.h"
+#include "Book/OpeningBook.h"
+#include "ThreadPool.h"
 #include "../Bit.h"
 #include "../Util.h"
 
+namespace tools {
+    class Benchmark;
+}
+
 namespace engine {
     class Engine {
     public:
-        Engine() = default;
+        /**
+         * @param numHashBits: size of the transposition table, as a power of 2 number of entries. Engines that run in
+         * parallel each have their own table, so they should use fewer bits than HASH_BITS.
+         */
+        explicit Engine(int numHashBits = HASH_BITS) :
+                transpositionTable(numHashBits) {}
+
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
 
         enum Verbose: int {
             ALL = 1,         // search stats, evaluation at each iteration, final value, best move
@@ -35,66 +54,190 @@ namespace engine {
         };
 
         SearchResult search(const Game &game, double maxTime = 3, Verbose verbose = Verbose::ALL);
+        SearchResult search(const Game &game, SearchLimits &limits, Verbose verbose = Verbose::ALL,
+                            const SearchProgressCallback &callback = nullptr);
+        SearchResult search(const Game &game, const GameClock &clock, Verbose verbose = Verbose::ALL);
         SearchResult search(SearchNode* node, bool passed, double maxTime = 3, Verbose verbose = Verbose::ALL);
-        SearchTask* search_task(const Game &game, Verbose verbose = Verbose::ALL);
+        /**
+         * @brief search a position on the engine's search thread. Searches run one at a time, in the order they were
+         * requested, so a search requested while another runs starts once that one is stopped or done.
+         *
+         * @param game: the position to search
+         * @param limits: limits of the search. Call stop() on them to cancel it. A time limit counts from when it was
+         * set, including the time the search spends queued
+         * @param callback: called on the search thread with the result of each completed iteration
+         * @return the result, once the search has ended
+         */
+        std::future<SearchResult> search_async(const Game &game, std::shared_ptr<SearchLimits> limits,
+                                               SearchProgressCallback callback = nullptr);
+
+        std::unique_ptr<SearchTask> search_task(const Game &game, Verbose verbose = Verbose::ALL);
         void continue_search_task(SearchTask* task, bool passed, Verbose verbose = Verbose::ALL);
         void continue_search_task_timed(engine::SearchTask *task, bool passed, double maxTime = 3, engine::Engine::Verbose verbose = Verbose::ALL);
+        void continue_search_task_clocked(engine::SearchTask *task, bool passed, const GameClock &clock, engine::Engine::Verbose verbose = Verbose::ALL);
 
         /** call this function after a move has been played to update the transposition table's age */
         inline void update() {
-            this->transpositionTable.happy_birthday();
+            if (this->searchOptions.lockTT)
+                this->transpositionTable.happy_birthday<true>();
+            else
+                this->transpositionTable.happy_birthday<false>();
         }
 
         inline void clear_transposition_table() {
             this->transpositionTable.clear();
         }
 
+        /**
+         * @brief load an opening book, which search consults before searching
+         * @param filepath: path of the book file
+         * @return whether the book was loaded
+         */
+        bool load_opening_book(const std::string &filepath = BOOK_FILEPATH);
+
+        /**
+         * @brief look up a position in the opening book
+         * @param board: the position
+         * @param result: receives the book move if there is one
+         * @return whether the position is in the book
+         */
+        inline bool probe_opening_book(const Board &board, BookMove *result) const {
+            return USE_OPENING_BOOK && this->openingBook != nullptr && this->openingBook->probe(board, result);
+        }
+
+        /** share an opening book that is already loaded, or pass nullptr to stop using the book */
+        inline void set_opening_book(std::shared_ptr<const OpeningBook> book) {
+            this->openingBook = std::move(book);
+        }
+
+        /**
+         * @brief evaluate positions with other weights than the default ones loaded by init()
+         * @param weights: the weights, or nullptr for the default weights
+         */
+        inline void set_evaluation_weights(std::shared_ptr<const eval::EvaluationWeights> weights) {
+            this->evaluationWeights = std::move(weights);
+        }
+
+        /**
+         * @brief switch search features on or off. Takes effect at the next search, so don't call it while one runs.
+         * @param options: the options
+         */
+        inline void set_search_options(const SearchOptions &options) {
+            this->searchOptions = options;
+            this->searchOptions.mpcDepth = std::clamp(options.mpcDepth, 0, MPC_DEPTH);
+        }
+
+        [[nodiscard]] inline const SearchOptions &get_search_options() const {
+            return this->searchOptions;
+        }
+
         SearchResult search_to_depth(const Game &game, int depth, Verbose verbose = Verbose::ALL, double maxTime = 86400);
 
-        static std::thread make_timer_thread(double duration, bool*& running, bool deleteRunningOnCompletion = true, bool waitToStart = true);
+        /**
+         * @brief score the root moves of a position by iterative deepening.
+         *
+         * The best numPV moves are searched with a full window and get exact scores. Every other move is checked with a
+         * null window against the numPV-th best score, and only re-searched if it beats it; otherwise its score is an
+         * upper bound. All moves share the transposition table, which also provides the principal variations.
+         *
+         * @param game: the position to analyze
+         * @param numPV: number of moves to score exactly. Pass the number of legal moves to score all of them exactly
+         * @param limits: search limits
+         * @param callback: called with the ranked lines after every completed iteration
+         * @return the root moves of the last completed iteration, best first. Empty if there are no legal moves
+         */
+        std::vector<AnalysisLine> analyze(const Game &game, int numPV, SearchLimits &limits, const AnalysisCallback &callback = nullptr);
+
         static void print_stats(SearchResult& result, Verbose verbose);
-        void collect_prob_cut_data(int numGames, int numThreads = 1);
-        static void probcut_init();
+        #if COLLECT_TELEMETRY
+            static void export_telemetry(const Board& root, const SearchResult& result, const std::string& filepath = TELEMETRY_FILEPATH);
+        #endif
+        static bool collect_prob_cut_data(int numGames, int numThreads, int maxDepth,
+                                          const std::string &filepath = MPC_DATA_FILEPATH, int numHashBits = 18);
+
+        /**
+         * @brief compute the ProbCut margins from a parameter file written by OthelloProbCut, or from the default
+         * parameters if there is no file
+         * @param filepath: path of the parameter file
+         */
+        static void probcut_init(const std::string &filepath = PROBCUT_PARAMS_FILEPATH);
 
     private:
-        SearchResult iterative_deepening_search(SearchNode* node, int maxDepth, bool pass, bool useVerbose, bool* running, bool* completed);
-
-        std::pair<int, int> first_pv_search(SearchNode* node, int depth, int alpha, int beta, bool pass, uint64_t legalMask, bool isEndSearch, bool* running);
-        int pv_search(SearchNode* node, int depth, int alpha, int beta, bool pass, uint64_t legalMask, bool isEndSearch, bool* running);
+        friend class tools::Benchmark;
+
+        SearchResult iterative_deepening_search(SearchNode* node, bool pass, bool useVerbose, SearchLimits* limits, TimeManager* timeManager = nullptr,
+                                                const SearchProgressCallback &callback = nullptr);
+        void run_search_task(SearchTask *task, bool passed, double maxTime, std::optional<GameClock> clock, Verbose verbose);
+        static uint_fast8_t get_iteration_selectivity(int numEmpty, int depth);
+        bool play_book_move(SearchNode *node);
+        std::vector<Move> get_pv_line(Board board, int maxLength);
+
+        // the search itself is templated on a SearchPolicy, chosen from the search options once per search
+        template<typename Policy>
+        SearchResult iterative_deepening_search(SearchNode* node, bool pass, bool useVerbose, SearchLimits* limits, TimeManager* timeManager,
+                                                const SearchProgressCallback &callback);
+        template<typename Policy>
+        std::vector<AnalysisLine> analyze(const Game &game, int numPV, SearchLimits &limits, const AnalysisCallback &callback);
+
+        template<typename Policy>
+        std::pair<int, int> first_pv_search(SearchNode* node, int depth, int alpha, int beta, bool pass, std::vector<RootMove>& rootMoves, bool isEndSearch, SearchLimits *limits);
+        template<typename Policy>
+        int pv_search(SearchNode* node, int depth, int alpha, int beta, bool pass, uint64_t legalMask, bool isEndSearch, SearchLimits *limits);
         int alpha_beta1(SearchNode* node, int alpha, int beta, bool pass, uint64_t legalMask);
 
-        int null_window_search(SearchNode* node, int depth, int alpha, bool pass, uint64_t legalMask, bool isEndSearch, bool* running);
+        template<typename Policy>
+        int null_window_search(SearchNode* node, int depth, int alpha, bool pass, uint64_t legalMask, bool isEndSearch, SearchLimits *limits);
         int alpha_beta_nws1(SearchNode* node, int alpha, bool pass, uint64_t legalMask);
 
-        int end_search_nws(SearchNode* node, int alpha, bool pass, uint64_t legalMask, bool* running);
+        template<typename Policy>
+        int end_search_nws(SearchNode* node, int alpha, bool pass, uint64_t legalMask, SearchLimits *limits);
 
         int last4(SearchNode* node, int alpha, int beta);
         int last3(SearchNode* node, int alpha, int beta, uint_fast8_t x1, uint_fast8_t x2, uint_fast8_t x3, int sort3, Board board);
         int last2(SearchNode* node, int alpha, int beta, uint_fast8_t x1, uint_fast8_t x2, Board board);
         int last1(SearchNode* node, uint_fast8_t x, uint64_t P);
 
+        template<typename Policy>
         void evaluate_move_list(SearchNode* node, int depth, int alpha, int beta, std::vector<MoveEval>& moveList,
-                                const uint_fast8_t hashMoves[], bool* running);
-        void evaluate_move_list(SearchNode* node, int depth, int alpha, int beta, std::vector<MoveEval>& moveList, bool* running);
-        void evaluate_move_list_nws(SearchNode* node, int depth, int alpha, std::vector<MoveEval>& moveList, uint_fast8_t hashMoves[], bool *running);
+                                const uint_fast8_t hashMoves[], SearchLimits *limits);
+        template<typename Policy>
+        void evaluate_move_list(SearchNode* node, int depth, int alpha, int beta, std::vector<MoveEval>& moveList, SearchLimits *limits);
+        template<typename Policy>
+        void evaluate_move_list_nws(SearchNode* node, int depth, int alpha, std::vector<MoveEval>& moveList, uint_fast8_t hashMoves[], SearchLimits *limits);
         void evaluate_move_list_end(SearchNode* node, std::vector<MoveEval>& moveList);
         void evaluate_move_list_end_nws(SearchNode* node, std::vector<MoveEval>& moveList);
         void evaluate_move_list_end_fast(SearchNode* node, std::vector<MoveEval>& moveList);
 
-        void move_evaluate(SearchNode* node, int depth, int alpha, int beta, MoveEval* moveEval, bool* running);
-        void move_evaluate_nws(SearchNode* node, int depth, int alpha, int beta, MoveEval* moveEval, bool *running);
+        template<typename Policy>
+        void move_evaluate(SearchNode* node, int depth, int alpha, int beta, MoveEval* moveEval, SearchLimits *limits);
+        template<typename Policy>
+        void move_evaluate_nws(SearchNode* node, int depth, int alpha, int beta, MoveEval* moveEval, SearchLimits *limits);
         void move_evaluate_end(SearchNode* node, MoveEval* moveEval);
         void move_evaluate_end_nws(SearchNode* node, MoveEval* moveEval);
         void move_evaluate_end_fast(SearchNode* node, MoveEval* moveEval);
 
         static void swap_next_best_move(std::vector<MoveEval>& moveList, int i);
 
-        bool probcut(SearchNode *node, int depth, int alpha, int beta, uint64_t legalMask, int* v, bool passed, bool isEndSearch, bool* running);
+        template<typename Policy>
+        bool probcut(SearchNode *node, int depth, int alpha, int beta, uint64_t legalMask, int* v, bool passed, bool isEndSearch, SearchLimits *limits);
 
+        template<typename Policy>
         bool etc(SearchNode* node, std::vector<MoveEval>& moveList, int depth, int* alpha, int beta, int* v, int* cutoffs);
+        template<typename Policy>
         bool etc_nws(SearchNode* node, std::vector<MoveEval>& moveList, int depth, int alpha, int* v, int* cutoffs);
 
+        /**
+         * @return the thread that runs the asynchronous searches, started on first use so that engines that only
+         * search synchronously don't own an idle thread
+         */
+        ThreadPool& get_search_thread();
+
         TranspositionTable transpositionTable;
+        SearchOptions searchOptions;
+        std::shared_ptr<const OpeningBook> openingBook;
+        std::shared_ptr<const eval::EvaluationWeights> evaluationWeights;
+        std::once_flag searchThreadFlag;
+        std::unique_ptr<ThreadPool> searchThread;  // runs the asynchronous searches. Last, so it is joined before the rest is destroyed
     };
 }
 
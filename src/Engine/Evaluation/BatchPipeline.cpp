@@ -0,0 +1,206 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "BatchPipeline.h"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include "Evaluation.h"
+
+namespace engine::eval {
+    BatchBuilder::BatchBuilder(int batchSize, std::function<void(Batch&&)> emit) :
+            batchSize(std::max(1, batchSize)),
+            emit(std::move(emit)) {
+        this->reset();
+    }
+
+    BatchBuilder::~BatchBuilder() {
+        delete this->matrixIndices;
+        delete this->matrixValues;
+        delete this->labels;
+    }
+
+    void BatchBuilder::reset() {
+        this->matrixIndices = new std::vector<int64_t>;
+        this->matrixValues = new std::vector<float>;
+        this->labels = new std::vector<float>;
+        this->matrixIndices->reserve((size_t)this->batchSize * NUM_FEATURES * 2);
+        this->matrixValues->reserve((size_t)this->batchSize * NUM_FEATURES);
+        this->labels->reserve(this->batchSize);
+        this->row = 0;
+    }
+
+    void BatchBuilder::add(const int *featureIndices, float value) {
+        // set the label
+        this->labels->push_back(value);
+
+        // one entry per distinct feature, counting repeats
+        int occurences = 1;
+        for (int i = 0; i < NUM_FEATURES; ++i) {
+            // check if the next feature is the same
+            if (i + 1 < NUM_FEATURES && featureIndices[i] == featureIndices[i + 1]) {
+                ++occurences;
+            } else {
+                this->matrixIndices->emplace_back(this->row);
+                this->matrixIndices->emplace_back((int64_t)featureIndices[i]);
+                this->matrixValues->emplace_back((float)occurences);
+
+                if (featureIndices[i] >= NUM_PHASE_PARAMS)
+                    std::cerr << "col = " << featureIndices[i] << " >= " << NUM_PHASE_PARAMS << std::endl;
+                occurences = 1;
+            }
+        }
+
+        if (++this->row >= this->batchSize)
+            this->flush();
+    }
+
+    void BatchBuilder::flush() {
+        if (this->row == 0)
+            return;
+
+        auto *indices = this->matrixIndices;
+        auto *values = this->matrixValues;
+        auto *batchLabels = this->labels;
+        indices->shrink_to_fit();
+        values->shrink_to_fit();
+        batchLabels->shrink_to_fit();
+
+        auto nnz = static_cast<int64_t>(values->size());
+        auto torchIndices = torch::from_blob(
+                indices->data(),
+                {2, nnz},
+                {1, 2},
+                [indices](void*) { delete indices; },
+                torch::kInt64
+        );
+        auto torchValues = torch::from_blob(
+                values->data(),
+                {nnz},
+                [values](void*) { delete values; },
+                torch::kFloat32
+        );
+        auto torchLabels = torch::from_blob(
+                batchLabels->data(),
+                {this->row},
+                [batchLabels](void*) { delete batchLabels; },
+                torch::kFloat32
+        );
+        auto torchData = torch::_sparse_coo_tensor_unsafe(
+                torchIndices,
+                torchValues,
+                {this->row, NUM_PHASE_PARAMS},
+                torch::kFloat32
+        );
+
+        // the tensors own the vectors now
+        this->reset();
+        this->emit({torchData, torchLabels});
+    }
+
+    BatchPipeline::BatchPipeline(uint64_t numChunks, int batchSize, Producer producer, int numThreads,
+                                 size_t capacity) :
+            batchSize(batchSize),
+            producer(std::move(producer)),
+            capacity(std::max((size_t)1, capacity)),
+            order(numChunks) {
+        std::iota(this->order.begin(), this->order.end(), 0);
+        this->nextChunk = this->order.size();  // no epoch yet
+
+        for (int i = 0; i < std::max(1, numThreads); ++i)
+            this->threads.emplace_back(&BatchPipeline::worker, this);
+    }
+
+    BatchPipeline::~BatchPipeline() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->shutdown = true;
+        }
+        this->epochStarted.notify_all();
+        this->notFull.notify_all();
+        for (auto &thread: this->threads)
+            thread.join();
+    }
+
+    void BatchPipeline::start_epoch(std::mt19937 &rng) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            std::shuffle(this->order.begin(), this->order.end(), rng);
+            this->nextChunk = 0;
+            this->numBusy = (int)this->threads.size();
+            this->numChunksDone = 0;
+            ++this->epoch;
+        }
+        this->epochStarted.notify_all();
+    }
+
+    bool BatchPipeline::next(Batch &batch) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->notEmpty.wait(lock, [this]() {
+                return !this->queue.empty() || this->numBusy == 0;
+            });
+            if (this->queue.empty())
+                return false;
+
+            batch = std::move(this->queue.front());
+            this->queue.pop_front();
+        }
+        this->notFull.notify_one();
+        return true;
+    }
+
+    void BatchPipeline::worker() {
+        BatchBuilder builder(this->batchSize, [this](Batch &&batch) {
+            this->push(std::move(batch));
+        });
+        uint64_t lastEpoch = 0;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->epochStarted.wait(lock, [this, lastEpoch]() {
+                    return this->shutdown || this->epoch != lastEpoch;
+                });
+                if (this->shutdown)
+                    return;
+                lastEpoch = this->epoch;
+            }
+
+            while (true) {
+                uint64_t chunk;
+                {
+                    std::lock_guard<std::mutex> lock(this->mutex);
+                    if (this->shutdown)
+                        return;
+                    if (this->nextChunk >= this->order.size())
+                        break;
+                    chunk = this->order[this->nextChunk++];
+                }
+                this->producer(chunk, builder);
+                this->numChunksDone.fetch_add(1, std::memory_order_relaxed);
+            }
+            builder.flush();
+
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                --this->numBusy;
+            }
+            this->notEmpty.notify_all();
+        }
+    }
+
+    void BatchPipeline::push(Batch &&batch) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->notFull.wait(lock, [this]() {
+                return this->shutdown || this->queue.size() < this->capacity;
+            });
+            if (this->shutdown)
+                return;
+            this->queue.push_back(std::move(batch));
+        }
+        this->notEmpty.notify_one();
+    }
+}
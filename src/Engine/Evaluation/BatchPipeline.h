@@ -0,0 +1,141 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_BATCHPIPELINE_H
+#define OTHELLO_BATCHPIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "../../Const.h"
+#include "ObservationSink.h"
+
+#ifdef slots
+#undef slots
+#endif
+#include <torch/torch.h>
+#ifdef slots
+#define slots Q_SLOTS
+#endif
+
+namespace engine::eval {
+    using Batch = std::tuple<torch::Tensor, torch::Tensor>;  // sparse feature matrix, labels
+
+    /**
+     * @brief accumulates observations into sparse batches of a fixed number of rows, and hands each batch on as soon
+     * as it is full
+     */
+    class BatchBuilder : public ObservationSink {
+    public:
+        /**
+         * @param batchSize: number of observations per batch
+         * @param emit: receives every full batch
+         */
+        BatchBuilder(int batchSize, std::function<void(Batch&&)> emit);
+        ~BatchBuilder() override;
+
+        BatchBuilder(const BatchBuilder&) = delete;
+        BatchBuilder& operator=(const BatchBuilder&) = delete;
+
+        void add(const int *featureIndices, float value) override;
+
+        /**
+         * @brief hand on the observations added since the last batch, if there are any
+         */
+        void flush();
+
+    private:
+        void reset();
+
+        int batchSize;
+        std::function<void(Batch&&)> emit;
+
+        // owned by the tensors once a batch is emitted
+        std::vector<int64_t> *matrixIndices = nullptr;
+        std::vector<float> *matrixValues = nullptr;
+        std::vector<float> *labels = nullptr;
+        int64_t row = 0;
+    };
+
+    /**
+     * @brief streams training batches from background threads.
+     *
+     * The dataset is split into chunks, which producer threads decode into batches while the optimizer works on the
+     * batches before them. The batches wait in a queue of bounded capacity, so at most (capacity + numThreads) batches
+     * exist at a time however large the dataset is, and the producers only run ahead of the optimizer by that much.
+     * Every epoch decodes the chunks again, in a new random order.
+     */
+    class BatchPipeline {
+    public:
+        using Producer = ChunkDecoder;
+
+        /**
+         * @param numChunks: number of chunks in the dataset
+         * @param batchSize: number of observations per batch. The last batch of each thread in an epoch can be smaller
+         * @param producer: decodes a chunk. Called from several threads at once
+         * @param numThreads: number of producer threads
+         * @param capacity: maximum number of decoded batches waiting for the optimizer
+         */
+        BatchPipeline(uint64_t numChunks, int batchSize, Producer producer, int numThreads = DATA_LOADER_THREADS,
+                      size_t capacity = BATCH_QUEUE_CAPACITY);
+        ~BatchPipeline();
+
+        BatchPipeline(const BatchPipeline&) = delete;
+        BatchPipeline& operator=(const BatchPipeline&) = delete;
+
+        /**
+         * @brief start decoding an epoch. The previous epoch must have been read to its end.
+         * @param rng: shuffles the order of the chunks
+         */
+        void start_epoch(std::mt19937 &rng);
+
+        /**
+         * @brief wait for the next batch of the epoch
+         * @param batch: receives the batch
+         * @return false once the epoch has no batches left
+         */
+        bool next(Batch &batch);
+
+        [[nodiscard]] inline uint64_t get_num_chunks() const {
+            return this->order.size();
+        }
+
+        /**
+         * @return number of chunks decoded so far in the current epoch
+         */
+        [[nodiscard]] inline uint64_t get_num_chunks_done() const {
+            return this->numChunksDone.load(std::memory_order_relaxed);
+        }
+
+    private:
+        void worker();
+        void push(Batch &&batch);
+
+        int batchSize;
+        Producer producer;
+        size_t capacity;
+
+        std::mutex mutex;
+        std::condition_variable epochStarted;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+        std::deque<Batch> queue;
+        std::vector<uint64_t> order;     // chunks of the current epoch
+        size_t nextChunk = 0;            // index in order of the next chunk to decode
+        int numBusy = 0;                 // producers that haven't finished the current epoch
+        uint64_t epoch = 0;
+        std::atomic<uint64_t> numChunksDone = 0;
+        bool shutdown = false;
+        std::vector<std::thread> threads;
+    };
+}
+
+#endif //OTHELLO_BATCHPIPELINE_H
@@ -1,9 +1,14 @@
 #include "EvalBuilder.h"
+#include <bit>
+#include <cmath>
 #include <iostream>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 #include <random>
+#include <sys/stat.h>
 #include "qcustomplot.h"
 
 constexpr unsigned short FEATURES_PASS = -1;
@@ -282,18 +287,30 @@ namespace engine::eval {
 
     // PARSING GAME FILES
 
-    int EvalBuilder::count_transcripts() {
-        auto dirIter = std::filesystem::directory_iterator(TRANSCRIPT_DIRECTORY);
-        return (int)std::count_if(
-                begin(dirIter),
-                end(dirIter),
-                [](auto& entry) { return entry.is_regular_file(); }
-        ) - 1;
+    /**
+     * @return names of the game files in TRANSCRIPT_DIRECTORY, in order: text transcripts (.txt) and WTHOR
+     * databases (.wtb)
+     */
+    std::vector<std::string> EvalBuilder::list_transcripts() {
+        std::vector<std::string> names;
+        std::error_code error;
+        for (auto &entry: std::filesystem::directory_iterator(TRANSCRIPT_DIRECTORY, error))
+            if (entry.is_regular_file() && (entry.path().extension() == ".txt" || is_wthor(entry.path().string())))
+                names.push_back(entry.path().filename().string());
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    bool EvalBuilder::is_wthor(const std::string& filepath) {
+        auto extension = std::filesystem::path(filepath).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        return extension == ".wtb";
     }
 
     void EvalBuilder::reformat_logbook() {
-        // get the number of files in the transcript directory to avoid overwriting
-        auto fileNumber = EvalBuilder::count_transcripts();
+        // get the number of transcripts in the transcript directory to avoid overwriting
+        const auto names = EvalBuilder::list_transcripts();
+        auto fileNumber = (int)std::count_if(names.begin(), names.end(), [](auto &name) { return !is_wthor(name); });
 
         // shuffle the logbook file
         std::ifstream logbook(LOGBOOK_FILEPATH);
@@ -349,66 +366,41 @@ namespace engine::eval {
             outfile.close();
     }
 
-    void EvalBuilder::reformat_transcripts() {
-        auto numTranscripts = EvalBuilder::count_transcripts();
-        std::string tmpFilepath = TRANSCRIPT_DIRECTORY "tmp.txt";
-        std::ostringstream fileName;
-        std::ifstream inFile;
-        std::ofstream outFile;
-
-        std::string line;
-
-        for (int i = 0; i < numTranscripts; ++i) {
-            fileName.str("");
-            fileName << TRANSCRIPT_DIRECTORY << std::setfill('0') << std::setw(7) << i << ".txt";
-            inFile.open(fileName.str());
-
-            // count number of lines
-            int lineCount = 0;
-            while (std::getline(inFile, line))
-                ++lineCount;
-
-            // reset cursor in input file
-            inFile.clear();
-            inFile.seekg(0, std::ios::beg);
-
-            // copy the file to a temporary file
-            outFile.open(tmpFilepath);
-            outFile << lineCount << std::endl;
-            outFile << inFile.rdbuf();
-
-            inFile.close();
-            outFile.close();
-
-            // replace the original file with the temporary file
-            std::remove(fileName.str().c_str());
-            std::rename(tmpFilepath.c_str(), fileName.str().c_str());
-
-            std::cout << "finished " << i << " of " << numTranscripts << std::endl;
-        }
-    }
-
     /**
      * @brief parse a game from a transcript
      * @param gameData object to store game data
      * @param transcript game transcript
      * @return number of training examples this will add
      */
-    unsigned int EvalBuilder::parse_game(EvalBuilder::GameData& gameData, const std::string& transcript) {
+    unsigned int EvalBuilder::parse_game(EvalBuilder::GameData& gameData, std::string_view transcript) {
+        uint8_t squares[WthorDatabase::MAX_MOVES];
+        int numMoves = 0;
+        for (int i = 0; i+1 < transcript.size() && numMoves < WthorDatabase::MAX_MOVES; i += 2)
+            squares[numMoves++] = static_cast<uint8_t>((transcript[i] - 'a') + ((transcript[i + 1] - '1') << 3));
+        return parse_game(gameData, squares, numMoves);
+    }
+
+    /**
+     * @brief replay a game from its moves
+     * @param gameData object to store game data
+     * @param squares the moves, with passes left out
+     * @param numMoves number of moves
+     * @return number of training examples this will add
+     */
+    unsigned int EvalBuilder::parse_game(EvalBuilder::GameData& gameData, const uint8_t* squares, int numMoves) {
         // parse moves
         Board board;
         unsigned int numPositions = 0;
         int phase;
 
-        for (int i = 0, numDiscs = 5; i+1 < transcript.size(); i += 2, ++numDiscs) {
+        for (int i = 0, numDiscs = 5; i < numMoves; ++i, ++numDiscs) {
             // pass if no legal moves so that we can keep track of who's turn it is based on number of turns
             if (board.get_legal_moves() == 0) {
                 gameData.positions.push_back(EvalBuilder::IGNORE);
                 board.pass();
             }
-            auto move = (transcript[i] - 'a') + ((transcript[i + 1] - '1') << 3);
 
-            board.play_move(static_cast<uint8_t>(move));
+            board.play_move(squares[i]);
 
             gameData.positions.push_back(board);
 
@@ -448,13 +440,12 @@ namespace engine::eval {
      * @return number of training examples this can make
      */
     unsigned int EvalBuilder::parse_games(std::vector<EvalBuilder::GameData>& games, const std::string& filename, bool verbose) {
-        std::ifstream file(TRANSCRIPT_DIRECTORY + filename);
-
-        std::string line, word;
-
-        // first line has the number of games in the file
-        std::getline(file, line);
-        const int numGames = std::stoi(line);
+        TranscriptFile file;
+        if (!file.load(TRANSCRIPT_DIRECTORY + filename)) {
+            std::cerr << "\nError opening game file \"" << filename << '"' << std::endl;
+            std::exit(1);
+        }
+        const auto numGames = (int)file.size();
 
         util::ProgressBar progressBar(numGames, "Parsing games from '" + filename + '\'');
         if (verbose)
@@ -463,29 +454,57 @@ namespace engine::eval {
         games.resize(numGames);
 
         unsigned int numPositions = 0;
+        for (int i = 0; i < numGames; ++i) {
+            numPositions += parse_game(games[i], file[i]);
 
-        if (file.is_open()) {
-            for (int i = 0; i < numGames; ++i) {
-                if (!std::getline(file, line)) {
-                    std::cerr << "Error reading game file \"" << filename << "\": expected " << numGames
-                              << " games, but only found " << i << std::endl;
-                    std::exit(1);
-                }
+            // verbose
+            if (verbose)
+                progressBar.update(i+1);
+        }
 
-                numPositions += parse_game(games[i], line);
+        return numPositions;
+    }
 
-                // verbose
-                if (verbose)
-                    progressBar.update(i+1);
-            }
-        } else {
-            std::cerr << "\nError opening game file \"" << filename << '"' << std::endl;
-            std::exit(1);
-        }
+    /**
+     * @brief count the entries a position adds to a dataset, and the observations it adds to each phase
+     * @param indices the position's feature indices, with the feature offsets
+     * @param numDiscs number of discs on the board
+     * @param numPhaseEntries entries per phase, incremented
+     * @param numPhaseObservations observations per phase, incremented
+     * @return number of entries
+     */
+    long EvalBuilder::count_position_entries(const int *indices, int numDiscs, long *numPhaseEntries, long *numPhaseObservations) {
+        int previous = -2;
+        long numEntries = 0;
 
-        file.close();
+        #if TUNE_MODE_MIDGAME
+            const int phase = get_phase(numDiscs);
+            const int s1 = std::max(0, phase - 2);
+            const int s5 = std::min(NUM_PHASES - 1, phase + 2);
+            for (int s = s1; s <= s5; ++s)
+                ++numPhaseObservations[s];
+        #endif
 
-        return numPositions;
+        for (int f = 0; f < NUM_FEATURES; ++f) {
+            // count the number of features
+            if (indices[f] != previous) {
+                #if TUNE_MODE_MIDGAME
+                    if (phase == 0 || phase == NUM_PHASES - 1)
+                        numEntries += 3;
+                    else if (phase == 1 || phase == NUM_PHASES - 2)
+                        numEntries += 4;
+                    else
+                        numEntries += 5;
+                    for (int s = s1; s <= s5; ++s)
+                        ++numPhaseEntries[s];
+                #else
+                    ++numPhaseEntries[0];
+                    ++numEntries;
+                #endif
+            }
+            previous = indices[f];
+        }
+        return numEntries;
     }
 
     /**
@@ -498,8 +517,6 @@ namespace engine::eval {
         gameFeatures.value = gameData.value;
         gameFeatures.indices.resize(gameData.positions.size());
 
-        int previous;
-        int phase;
         long numEntries = 0;
         int numDiscs = 4;
         assert(!gameData.positions.empty());
@@ -517,102 +534,225 @@ namespace engine::eval {
             int indices[NUM_FEATURES];
             compute_feature_indices(indices, gameData.positions[i], 0);
 
-            // add the indices to the game features
-            previous = -2;
-
-            #if TUNE_MODE_MIDGAME
-                phase = get_phase(++numDiscs);
-                const int s1 = std::max(0, phase - 2);
-                const int s5 = std::min(NUM_PHASES - 1, phase + 2);
-                for (int s = s1; s <= s5; ++s)
-                    ++numPhaseObservations[s];
-            #endif
-
             for (int f = 0; f < NUM_FEATURES; ++f) {
                 int index = indices[f] - OFFSETS[f];
                 gameFeatures.indices[i][f] = static_cast<unsigned short>(index);
                 if (f < NUM_PATTERN_SYMMETRIES)
                     assert(index < POW3[FEATURES[f].size]);
-
-                // count the number of features
-                if (indices[f] != previous) {
-                    #if TUNE_MODE_MIDGAME
-                        if (phase == 0 || phase == NUM_PHASES - 1)
-                            numEntries += 3;
-                        else if (phase == 1 || phase == NUM_PHASES - 2)
-                            numEntries += 4;
-                        else
-                            numEntries += 5;
-                        for (int s = s1; s <= s5; ++s)
-                            ++numPhaseEntries[s];
-                    #else
-                        ++numPhaseEntries[0];
-                        ++numEntries;
-                    #endif
-                }
-                previous = indices[f];
             }
+            numEntries += count_position_entries(indices, ++numDiscs, numPhaseEntries, numPhaseObservations);
         }
         assert(gameFeatures.numPositions > 0);
         return numEntries;
     }
 
-    void EvalBuilder::init_batches(int maxThreads, int numBatches) {
-        const int numTranscripts = count_transcripts();
-        if (numBatches == -1 || numBatches > numTranscripts)
-            numBatches = numTranscripts;
+    std::string EvalBuilder::get_batch_filepath(int batchIndex) {
+        std::ostringstream filepath;
+        filepath << BINARY_DATASET_DIRECTORY << std::setfill('0') << std::setw(7) << batchIndex << ".bin";
+        return filepath.str();
+    }
 
-        util::ProgressBar progressBar(numBatches, "Initializing batch data ");
-        std::vector<std::thread> threads;
-        std::atomic<int> batchIndex = 0;
-        std::atomic<int> numComplete = 0;
-        std::mutex mtx;
-        std::atomic<bool> printLock = false;
-        threads.reserve(maxThreads);
-        progressBar.start_timer();
-        for (int i = 0; i < maxThreads; ++i) {
-            threads.emplace_back([&batchIndex, &numComplete, &mtx, &printLock, &progressBar, numBatches]() {
-                // get the batch index and increment
-                mtx.lock();
-                int index = batchIndex++;
-                mtx.unlock();
-
-                while (index < numBatches) {
-                    write_batch_data(index);
-                    // print progress
-                    ++numComplete;
-                    if (!printLock) {
-                        printLock = true;
-                        progressBar.update(numComplete);
-                        printLock = false;
-                    }
+    std::vector<EvalBuilder::TranscriptEntry> EvalBuilder::read_manifest() {
+        std::vector<TranscriptEntry> entries;
+        std::ifstream file(TRANSCRIPT_MANIFEST_FILEPATH);
+        TranscriptEntry entry;
+        while (file >> std::quoted(entry.name) >> entry.fileSize >> entry.fileTime >> entry.numGames
+                    >> entry.firstBatch >> entry.numBatches)
+            entries.push_back(entry);
+        return entries;
+    }
 
-                    // get the next batch index and increment
-                    mtx.lock();
-                    index = batchIndex++;
-                    mtx.unlock();
-                }
+    bool EvalBuilder::write_manifest(const std::vector<TranscriptEntry>& entries) {
+        const std::string tmpFilepath = TRANSCRIPT_MANIFEST_FILEPATH ".tmp";
+        std::ofstream file(tmpFilepath);
+        for (auto &entry: entries)
+            file << std::quoted(entry.name) << ' ' << entry.fileSize << ' ' << entry.fileTime << ' ' << entry.numGames
+                 << ' ' << entry.firstBatch << ' ' << entry.numBatches << '\n';
+        file.close();
+
+        if (file.fail() || std::rename(tmpFilepath.c_str(), TRANSCRIPT_MANIFEST_FILEPATH) != 0) {
+            std::cerr << "Error writing " << TRANSCRIPT_MANIFEST_FILEPATH << std::endl;
+            std::remove(tmpFilepath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief parse the games of every transcript file and WTHOR database in TRANSCRIPT_DIRECTORY into feature batches
+     * in BINARY_DATASET_DIRECTORY. The files are memory-mapped and read in place, and their games are split into chunks
+     * of TRANSCRIPT_CHUNK_SIZE games that the threads parse and write as batches independently, so even a single large
+     * file keeps every thread busy. The batches of each file are recorded in the manifest, and files that haven't
+     * changed since they were ingested aren't parsed again.
+     * @param maxThreads number of threads
+     * @return whether every transcript file was ingested
+     */
+    bool EvalBuilder::ingest_transcripts(int maxThreads) {
+        struct Chunk {
+            int fileIndex;
+            uint64_t firstGame;
+            uint64_t lastGame;
+            int batchIndex;
+        };
+
+        // a transcript file or a WTHOR database
+        struct GameFile {
+            TranscriptFile transcripts;
+            WthorDatabase wthor;
+            bool isWthor = false;
+
+            [[nodiscard]] uint64_t size() const {
+                return this->isWthor ? this->wthor.size() : this->transcripts.size();
+            }
+        };
+
+        const auto names = list_transcripts();
+        std::vector<TranscriptEntry> entries;
+        int nextBatch = 0;
+        bool isComplete = true;
+
+        // keep the batches of files that are unchanged, and delete the rest
+        for (auto &entry: read_manifest()) {
+            struct stat st{};
+            bool isCurrent = std::binary_search(names.begin(), names.end(), entry.name) &&
+                             stat((TRANSCRIPT_DIRECTORY + entry.name).c_str(), &st) == 0 &&
+                             (uint64_t)st.st_size == entry.fileSize && (int64_t)st.st_mtime == entry.fileTime;
+            if (isCurrent) {
+                entries.push_back(entry);
+                nextBatch = std::max(nextBatch, entry.firstBatch + entry.numBatches);
+            } else {
+                for (int b = entry.firstBatch; b < entry.firstBatch + entry.numBatches; ++b)
+                    std::remove(get_batch_filepath(b).c_str());
+            }
+        }
+
+        // split the new files into chunks, which are numbered after the batches that are kept
+        std::vector<std::unique_ptr<GameFile>> files;
+        std::vector<TranscriptEntry> newEntries;
+        std::vector<Chunk> chunks;
+        for (auto &name: names) {
+            bool isIngested = std::any_of(entries.begin(), entries.end(), [&name](auto &entry) {
+                return entry.name == name;
             });
+            if (isIngested)
+                continue;
+
+            auto file = std::make_unique<GameFile>();
+            file->isWthor = is_wthor(name);
+            bool isLoaded = file->isWthor ? file->wthor.load(TRANSCRIPT_DIRECTORY + name)
+                                          : file->transcripts.load(TRANSCRIPT_DIRECTORY + name);
+            if (!isLoaded) {
+                isComplete = false;
+                continue;
+            }
+
+            TranscriptEntry entry{name, 0, 0, file->size(), nextBatch, 0};
+            entry.fileSize = file->isWthor ? file->wthor.get_file_size() : file->transcripts.get_file_size();
+            entry.fileTime = file->isWthor ? file->wthor.get_file_time() : file->transcripts.get_file_time();
+            for (uint64_t first = 0; first < file->size(); first += TRANSCRIPT_CHUNK_SIZE) {
+                auto last = std::min(first + TRANSCRIPT_CHUNK_SIZE, file->size());
+                chunks.push_back({(int)files.size(), first, last, entry.firstBatch + entry.numBatches++});
+            }
+            nextBatch += entry.numBatches;
+            newEntries.push_back(entry);
+            files.push_back(std::move(file));
         }
 
-        // wait for threads to finish
-        for (auto &thread : threads)
-            thread.join();
+        std::vector<std::atomic<bool>> isFileFailed(files.size());
+        if (!chunks.empty()) {
+            util::ProgressBar progressBar((int)chunks.size(), "Ingesting transcripts ");
+            std::vector<std::thread> threads;
+            std::atomic<uint64_t> nextChunk = 0;
+            std::atomic<int> numComplete = 0;
+            std::atomic<bool> printLock = false;
+            maxThreads = std::clamp(maxThreads, 1, (int)chunks.size());
+            threads.reserve(maxThreads);
+            progressBar.start_timer();
+
+            for (int t = 0; t < maxThreads; ++t) {
+                threads.emplace_back([&]() {
+                    std::vector<GameData> games;
+                    for (auto i = nextChunk++; i < chunks.size(); i = nextChunk++) {
+                        const auto &chunk = chunks[i];
+                        const auto &file = *files[chunk.fileIndex];
+
+                        games.clear();
+                        long numObservations = 0;
+                        for (auto g = chunk.firstGame; g < chunk.lastGame; ++g) {
+                            GameData game;
+                            if (file.isWthor) {
+                                // a corrupt record's final position isn't the one it was scored at, so it's left out
+                                uint8_t squares[WthorDatabase::MAX_MOVES];
+                                auto record = file.wthor.get_game(g);
+                                auto numMoves = WthorDatabase::decode(record, squares);
+                                if (numMoves == 0 || numMoves != record.get_num_moves())
+                                    continue;
+                                numObservations += parse_game(game, squares, numMoves);
+                            } else {
+                                numObservations += parse_game(game, file.transcripts[g]);
+                            }
+                            games.push_back(std::move(game));
+                        }
+                        if (!write_game_data(get_batch_filepath(chunk.batchIndex), games, numObservations))
+                            isFileFailed[chunk.fileIndex] = true;
+
+                        // print progress
+                        ++numComplete;
+                        if (!printLock) {
+                            printLock = true;
+                            progressBar.update(numComplete);
+                            printLock = false;
+                        }
+                    }
+                });
+            }
+
+            // wait for threads to finish
+            for (auto &thread: threads)
+                thread.join();
+        }
+
+        // a file only goes in the manifest once all of its batches are written
+        for (size_t f = 0; f < newEntries.size(); ++f) {
+            auto &entry = newEntries[f];
+            if (!isFileFailed[f]) {
+                entries.push_back(entry);
+                continue;
+            }
+            isComplete = false;
+            for (int b = entry.firstBatch; b < entry.firstBatch + entry.numBatches; ++b)
+                std::remove(get_batch_filepath(b).c_str());
+        }
+
+        std::sort(entries.begin(), entries.end(), [](auto &a, auto &b) { return a.name < b.name; });
+        return write_manifest(entries) && isComplete;
     }
 
-    void EvalBuilder::write_batch_data(int batchIndex) {
-        std::ostringstream filename;
-        filename.str("");
-        filename << std::setfill('0') << std::setw(7) << batchIndex;
+    /**
+     * @brief write games straight to a binary dataset, without going through a transcript file
+     * @param filepath dataset file. Datasets in COMBINED_DATASET_DIRECTORY can be passed to train()
+     * @param transcripts games, each as a sequence of moves (f5d6c3...)
+     * @return whether the file was written
+     */
+    bool EvalBuilder::write_games(const std::string& filepath, const std::vector<std::string>& transcripts) {
+        std::vector<GameData> games(transcripts.size());
+        long numObservations = 0;
+        for (size_t i = 0; i < transcripts.size(); ++i)
+            numObservations += parse_game(games[i], transcripts[i]);
+        return write_game_data(filepath, games, numObservations);
+    }
 
-        std::vector<GameData> games;
-        long numObservations = parse_games(games, filename.str() + ".txt", false);
+    bool EvalBuilder::write_game_data(const std::string& filepath, const std::vector<GameData>& games, long numObservations) {
         unsigned int numGames = games.size();
         long numEntries = 0;
         long numPhaseEntries[NUM_PHASES] = {0};
         long numPhaseObservations[NUM_PHASES] = {0};
 
-        std::ofstream file(BINARY_DATASET_DIRECTORY + filename.str() + ".bin", std::ios::binary);
+        std::ofstream file(filepath, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error opening file " << filepath << std::endl;
+            return false;
+        }
 
         // write the number of games, training examples, and entries
         file.write(reinterpret_cast<const char *>(&numGames), sizeof(unsigned int));
@@ -651,348 +791,605 @@ namespace engine::eval {
         file.write(reinterpret_cast<const char *>(numPhaseObservations), sizeof(long) * NUM_PHASES);
 
         file.close();
+        return !file.fail();
     }
 
-    void EvalBuilder::combine_batches(int maxThreads, int numBatchesPerBatch, int firstNewBatchIndex) {
-        const int numTranscripts = count_transcripts();
-        const int numBatches = 1 + (numTranscripts - 1) / numBatchesPerBatch; // ceil(numTranscripts / numBatchesPerBatch)
-        const int lastBatchIndex = firstNewBatchIndex + numBatches;
-        maxThreads = std::min(maxThreads, numBatches);
+    /**
+     * @brief shuffle the games of every ingested batch into combined datasets, with an external-memory shuffle. Each
+     * game is scattered to a random bucket file in one streaming pass. Every combined dataset is then made of its own
+     * buckets, each shuffled in memory and written out in turn, so only one bucket per thread is in memory at once. A
+     * random bucket followed by a random order within it is a uniformly random order of every game, so a combined
+     * dataset is a random sample of the games in a random order rather than whole transcript files in their order.
+     * @param maxThreads maximum number of threads
+     * @param numBatchesPerBatch number of ingested batches' worth of games in each combined dataset
+     * @param firstNewBatchIndex number of the first combined dataset
+     * @return whether every combined dataset was written
+     */
+    bool EvalBuilder::combine_batches(int maxThreads, int numBatchesPerBatch, int firstNewBatchIndex) {
+        // the batches of every ingested transcript file
+        std::vector<int> batchIndices;
+        for (auto &entry: read_manifest())
+            for (int b = entry.firstBatch; b < entry.firstBatch + entry.numBatches; ++b)
+                batchIndices.push_back(b);
+        if (batchIndices.empty()) {
+            std::cerr << "No ingested transcripts in " << TRANSCRIPT_MANIFEST_FILEPATH << std::endl;
+            return false;
+        }
 
-        util::ProgressBar progressBar(numBatches, "Combining batches into groups of " + std::to_string(numBatchesPerBatch) + "");
-        progressBar.print();
-        std::vector<std::thread> threads;
-        std::atomic<int> batchIndex = firstNewBatchIndex;
-        std::atomic<int> numComplete = 0;
-        std::mutex mtx;
-        std::atomic<bool> printLock = false;
-        threads.reserve(maxThreads);
-        progressBar.start_timer();
+        uint64_t numBytes = 0;
+        for (int b: batchIndices) {
+            std::error_code error;
+            numBytes += std::filesystem::file_size(get_batch_filepath(b), error);
+            if (error) {
+                std::cerr << "Error opening file " << get_batch_filepath(b) << std::endl;
+                return false;
+            }
+        }
 
-        for (int i = 0; i < maxThreads; ++i) {
-            threads.emplace_back(
-                    [&batchIndex, &numComplete, &mtx, &printLock, &progressBar, firstNewBatchIndex, numTranscripts, lastBatchIndex, numBatchesPerBatch]() {
-
-                        int firstIndex, newIndex;
-                        // get the batch index and increment
-                        mtx.lock();
-                        newIndex = batchIndex++;
-                        mtx.unlock();
-
-                        while (newIndex < lastBatchIndex) {
-                            firstIndex = (newIndex - firstNewBatchIndex) * numBatchesPerBatch;
-                            EvalBuilder::make_combined_batch(firstIndex,
-                                                             std::min(numBatchesPerBatch,
-                                                                      numTranscripts - firstIndex - 1),
-                                                             newIndex);
-                            // print progress
-                            ++numComplete;
-                            if (!printLock) {
-                                printLock = true;
-                                progressBar.update(numComplete);
-                                printLock = false;
-                            }
+        maxThreads = std::max(1, maxThreads);
+        const int numSourceBatches = (int)batchIndices.size();
+        const int numBatches = 1 + (numSourceBatches - 1) / numBatchesPerBatch; // ceil(numSourceBatches / numBatchesPerBatch)
+
+        // enough buckets per combined dataset that each one fits in memory, without too many files open at once
+        const auto numBucketsPerBatch = (int)std::clamp<uint64_t>(numBytes / numBatches / SHUFFLE_BUCKET_SIZE + 1, 1,
+                                                                  std::max<uint64_t>(1, SHUFFLE_MAX_BUCKETS / numBatches));
+        const int numBuckets = numBatches * numBucketsPerBatch;
+        const std::string bucketDirectory = BINARY_DATASET_DIRECTORY "shuffle/";
+        auto getBucketPath = [&bucketDirectory](int b) {
+            return bucketDirectory + std::to_string(b) + ".bin";
+        };
 
-                            // get the next batch index and increment
-                            mtx.lock();
-                            newIndex = batchIndex++;
-                            mtx.unlock();
-                        }
-                    });
-        }
+        std::error_code error;
+        std::filesystem::create_directories(bucketDirectory, error);
+        auto cleanUp = [&bucketDirectory]() {
+            std::error_code error;
+            std::filesystem::remove_all(bucketDirectory, error);
+        };
 
-        // wait for threads to finish
-        for (auto &thread : threads)
-            thread.join();
-    }
+        std::random_device rd;
+        std::atomic<bool> isFailed = false;
 
-    void EvalBuilder::make_combined_batch(int firstBatchIndex, int numBatches, int newBatchIndex) {
-        std::ostringstream oss;
-        oss << COMBINED_DATASET_DIRECTORY << std::setfill('0') << std::setw(7) << newBatchIndex << ".bin";
-        std::ofstream file(oss.str(), std::ios::binary);
+        // scatter every game to a random bucket
+        {
+            std::vector<std::ofstream> buckets(numBuckets);
+            std::vector<std::mutex> bucketLocks(numBuckets);
+            for (int b = 0; b < numBuckets; ++b) {
+                buckets[b].open(getBucketPath(b), std::ios::binary);
+                if (!buckets[b].is_open()) {
+                    std::cerr << "Error opening file " << getBucketPath(b) << std::endl;
+                    cleanUp();
+                    return false;
+                }
+            }
 
-        unsigned int numGames = 0;
-        long numObservations = 0;
-        long numEntries = 0;
-        long numPhaseEntries[NUM_PHASES] = {0};
-        long numPhaseObservations[NUM_PHASES] = {0};
+            util::ProgressBar progressBar(numSourceBatches, "Scattering games ", util::FRACTION);
+            progressBar.print();
 
-        unsigned int numGamesInBatch;
-        long numObservationsInBatch, numEntriesInBatch, numPhaseEntriesInBatch[NUM_PHASES], numPhaseObservationsInBatch[NUM_PHASES];
+            std::atomic<int> nextBatch = 0;
+            std::atomic<int> numComplete = 0;
+            std::atomic<bool> printLock = false;
+            std::vector<std::thread> threads;
+            const int numThreads = std::min(maxThreads, numSourceBatches);
+            threads.reserve(numThreads);
+
+            for (int t = 0; t < numThreads; ++t) {
+                threads.emplace_back([&, seed = rd()]() {
+                    std::mt19937 rng(seed);
+                    std::uniform_int_distribution<int> bucketDistribution(0, numBuckets - 1);
+                    std::vector<std::vector<char>> buffers(numBuckets);
+                    auto flush = [&](int b) {
+                        if (buffers[b].empty())
+                            return;
+                        std::lock_guard<std::mutex> lock(bucketLocks[b]);
+                        buckets[b].write(buffers[b].data(), (std::streamsize)buffers[b].size());
+                        buffers[b].clear();
+                    };
+
+                    FeatureDataset batch;
+                    for (int i = nextBatch++; i < numSourceBatches; i = nextBatch++) {
+                        if (!batch.load(get_batch_filepath(batchIndices[i]))) {
+                            isFailed = true;
+                            continue;
+                        }
 
-        // write the number of games, training examples, and entries
-        file.write(reinterpret_cast<const char *>(&numGames), sizeof(int));
-        file.write(reinterpret_cast<const char *>(&numObservations), sizeof(long));
-        file.write(reinterpret_cast<const char *>(&numEntries), sizeof(long));
-        file.write(reinterpret_cast<const char *>(numPhaseEntries), sizeof(long) * NUM_PHASES);
-        file.write(reinterpret_cast<const char *>(numPhaseObservations), sizeof(long) * NUM_PHASES);
+                        for (uint64_t g = 0; g < batch.size(); ++g) {
+                            // the game's header is the 2 bytes before its records
+                            auto game = batch.get_game(g);
+                            auto begin = game.records - 2;
+                            auto end = game.records + game.numPositions * FeatureDataset::RECORD_SIZE;
 
-        std::vector<int> batchIndices;
-        for (int i = firstBatchIndex; i < firstBatchIndex + numBatches; ++i)
-            batchIndices.push_back(i);
+                            int b = bucketDistribution(rng);
+                            buffers[b].insert(buffers[b].end(), begin, end);
+                            if (buffers[b].size() >= SHUFFLE_BUFFER_SIZE)
+                                flush(b);
+                        }
 
-        // shuffle the batch indices
-        std::random_device rd;
-        std::mt19937 g(rd());
-        std::shuffle(batchIndices.begin(), batchIndices.end(), g);
-
-        // combine the batch data
-        for (auto index: batchIndices) {
-            std::ostringstream batchFilename;
-            batchFilename << BINARY_DATASET_DIRECTORY << std::setfill('0') << std::setw(7) << index << ".bin";
-            std::ifstream batchFile(batchFilename.str(), std::ios::binary);
-            if (!batchFile.is_open()) {
-                std::cerr << "Error opening file " << BINARY_DATASET_DIRECTORY << std::setfill('0') << std::setw(7) << index << ".bin" << std::endl;
-                std::exit(1);
+                        // print progress
+                        ++numComplete;
+                        if (!printLock) {
+                            printLock = true;
+                            progressBar.update(numComplete);
+                            printLock = false;
+                        }
+                    }
+                    for (int b = 0; b < numBuckets; ++b)
+                        flush(b);
+                });
+            }
+            for (auto &thread: threads)
+                thread.join();
+
+            for (auto &bucket: buckets) {
+                bucket.close();
+                if (bucket.fail())
+                    isFailed = true;
+            }
+            if (isFailed) {
+                std::cerr << "Could not scatter the batches to " << bucketDirectory << std::endl;
+                cleanUp();
+                return false;
             }
+        }
 
-            batchFile.read(reinterpret_cast<char *>(&numGamesInBatch), sizeof(int));
-            batchFile.read(reinterpret_cast<char *>(&numObservationsInBatch), sizeof(long));
-            batchFile.read(reinterpret_cast<char *>(&numEntriesInBatch), sizeof(long));
-            batchFile.read(reinterpret_cast<char *>(numPhaseEntriesInBatch), sizeof(long) * NUM_PHASES);
-            batchFile.read(reinterpret_cast<char *>(numPhaseObservationsInBatch), sizeof(long) * NUM_PHASES);
+        // write each combined dataset from its buckets, one dataset per thread at a time
+        util::ProgressBar progressBar(numBatches, "Combining batches into groups of " + std::to_string(numBatchesPerBatch) + " ", util::FRACTION);
+        progressBar.print();
 
-            numGames += numGamesInBatch;
-            numObservations += numObservationsInBatch;
-            numEntries += numEntriesInBatch;
+        std::atomic<int> nextBatch = 0;
+        std::atomic<int> numComplete = 0;
+        std::atomic<bool> printLock = false;
+        std::vector<std::thread> threads;
+        const int numThreads = std::min(maxThreads, numBatches);
+        threads.reserve(numThreads);
+
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, seed = rd()]() {
+                std::mt19937 rng(seed);
+                std::vector<char> games;
+                std::vector<size_t> offsets;
+
+                for (int i = nextBatch++; i < numBatches; i = nextBatch++) {
+                    std::ostringstream oss;
+                    oss << COMBINED_DATASET_DIRECTORY << std::setfill('0') << std::setw(7) << firstNewBatchIndex + i << ".bin";
+                    const auto filepath = oss.str();
+                    const auto tmpFilepath = filepath + ".tmp";
+
+                    std::ofstream file(tmpFilepath, std::ios::binary);
+                    if (!file.is_open()) {
+                        std::cerr << "Error opening file " << tmpFilepath << std::endl;
+                        isFailed = true;
+                        continue;
+                    }
 
-            for (int i = 0; i < NUM_PHASES; ++i) {
-                numPhaseEntries[i] += numPhaseEntriesInBatch[i];
-                numPhaseObservations[i] += numPhaseObservationsInBatch[i];
-            }
+                    unsigned int numGames = 0;
+                    long numObservations = 0;
+                    long numEntries = 0;
+                    long numPhaseEntries[NUM_PHASES] = {0};
+                    long numPhaseObservations[NUM_PHASES] = {0};
+
+                    // write the number of games, training examples, and entries
+                    file.write(reinterpret_cast<const char *>(&numGames), sizeof(int));
+                    file.write(reinterpret_cast<const char *>(&numObservations), sizeof(long));
+                    file.write(reinterpret_cast<const char *>(&numEntries), sizeof(long));
+                    file.write(reinterpret_cast<const char *>(numPhaseEntries), sizeof(long) * NUM_PHASES);
+                    file.write(reinterpret_cast<const char *>(numPhaseObservations), sizeof(long) * NUM_PHASES);
+
+                    bool isBatchFailed = false;
+                    for (int b = i * numBucketsPerBatch; b < (i + 1) * numBucketsPerBatch; ++b) {
+                        const auto bucketPath = getBucketPath(b);
+                        std::error_code sizeError;
+                        auto bucketSize = std::filesystem::file_size(bucketPath, sizeError);
+                        std::ifstream bucket(bucketPath, std::ios::binary);
+                        if (sizeError || !bucket.is_open()) {
+                            isBatchFailed = true;
+                            break;
+                        }
+                        games.resize(bucketSize);
+                        bucket.read(games.data(), (std::streamsize)bucketSize);
+                        bucket.close();
+                        std::remove(bucketPath.c_str());
+
+                        // index the games, then write them in a random order
+                        offsets.clear();
+                        for (size_t offset = 0; offset + 2 <= games.size();) {
+                            offsets.push_back(offset);
+                            offset += 2 + (uint8_t)games[offset] * FeatureDataset::RECORD_SIZE;
+                        }
+                        std::shuffle(offsets.begin(), offsets.end(), rng);
+
+                        for (auto offset: offsets) {
+                            const auto numPositions = (uint8_t)games[offset];
+                            const char *records = games.data() + offset + 2;
+                            file.write(games.data() + offset, (std::streamsize)(2 + numPositions * FeatureDataset::RECORD_SIZE));
+
+                            // the header's counts depend on which games are in the dataset, so they're counted again
+                            ++numGames;
+                            for (int p = 0; p < numPositions; ++p) {
+                                uint16_t patternIndices[NUM_FEATURES];
+                                int indices[NUM_FEATURES];
+                                FeatureDataset::read_record(records + p * FeatureDataset::RECORD_SIZE, patternIndices);
+                                for (int f = 0; f < NUM_FEATURES; ++f)
+                                    indices[f] = patternIndices[f] + OFFSETS[f];
+                                numEntries += count_position_entries(indices, 5 + p, numPhaseEntries, numPhaseObservations);
+
+                                #if TUNE_MODE_MIDGAME
+                                    const int phase = get_phase(5 + p);
+                                    numObservations += std::min(NUM_PHASES - 1, phase + 2) - std::max(0, phase - 2) + 1;
+                                #else
+                                    ++numObservations;
+                                #endif
+                            }
+                        }
+                    }
 
-            // copy the batch data
-            file << batchFile.rdbuf();
-            batchFile.close();
-        }
+                    // update the number of games, training examples, and entries
+                    file.seekp(0, std::ios::beg);
+                    file.write(reinterpret_cast<const char *>(&numGames), sizeof(int));
+                    file.write(reinterpret_cast<const char *>(&numObservations), sizeof(long));
+                    file.write(reinterpret_cast<const char *>(&numEntries), sizeof(long));
+                    file.write(reinterpret_cast<const char *>(numPhaseEntries), sizeof(long) * NUM_PHASES);
+                    file.write(reinterpret_cast<const char *>(numPhaseObservations), sizeof(long) * NUM_PHASES);
+                    file.close();
+
+                    // rename the finished file over the dataset, so a reader never sees a partial dataset
+                    if (isBatchFailed || file.fail() || std::rename(tmpFilepath.c_str(), filepath.c_str()) != 0) {
+                        std::cerr << "Error writing file " << filepath << std::endl;
+                        std::remove(tmpFilepath.c_str());
+                        isFailed = true;
+                    }
 
-        // update the number of games, training examples, and entries
-        file.seekp(0, std::ios::beg);
-        file.write(reinterpret_cast<const char *>(&numGames), sizeof(int));
-        file.write(reinterpret_cast<const char *>(&numObservations), sizeof(long));
-        file.write(reinterpret_cast<const char *>(&numEntries), sizeof(long));
-        file.write(reinterpret_cast<const char *>(numPhaseEntries), sizeof(long) * NUM_PHASES);
-        file.write(reinterpret_cast<const char *>(numPhaseObservations), sizeof(long) * NUM_PHASES);
+                    // print progress
+                    ++numComplete;
+                    if (!printLock) {
+                        printLock = true;
+                        progressBar.update(numComplete);
+                        printLock = false;
+                    }
+                }
+            });
+        }
 
-        file.close();
+        // wait for threads to finish
+        for (auto &thread : threads)
+            thread.join();
+        cleanUp();
+        return !isFailed;
     }
 
-    void EvalBuilder::preprocess_transcripts(int maxThreads, int numFilesPerBatch, bool hasLogbook) {
+    void EvalBuilder::preprocess_transcripts(int maxThreads, int numBatchesPerDataset, bool hasLogbook) {
         if (hasLogbook)
             reformat_logbook();
-        reformat_transcripts();
-        init_batches(maxThreads);
-        combine_batches(maxThreads, numFilesPerBatch, 0);
+        if (!ingest_transcripts(maxThreads))
+            std::cerr << "Some transcript files couldn't be ingested" << std::endl;
+        if (!combine_batches(maxThreads, numBatchesPerDataset, 0))
+            std::cerr << "Some batches couldn't be combined" << std::endl;
     }
 
-    void EvalBuilder::add_training_observation(std::vector<int64_t> *matrixIndices, std::vector<float> *matrixValues, std::vector<float> *labels, int64_t &row, int* featureIndices, float value) {
-        // set the label
-        labels->push_back(value);
+    /**
+     * @brief write every game in TRANSCRIPT_DIRECTORY, from transcripts and WTHOR databases, to a single move dataset
+     * @param filename name of the dataset in COMBINED_DATASET_DIRECTORY. Should end in MOVE_DATASET_EXTENSION so that
+     * train() recognizes it
+     * @return whether the dataset was written
+     */
+    bool EvalBuilder::write_move_dataset(const std::string& filename) {
+        const auto names = list_transcripts();
+        std::vector<std::string> transcripts;
 
-        int occurences = 1;
-        for (int i = 0; i < NUM_FEATURES; ++i) {
-            // check if the next feature is the same
-            if (i+1 < NUM_FEATURES && featureIndices[i] == featureIndices[i + 1]) {
-                ++occurences;
+        util::ProgressBar progressBar((int)names.size(), "Reading transcripts ");
+        progressBar.start_timer();
+        for (int i = 0; i < names.size(); ++i) {
+            if (is_wthor(names[i])) {
+                WthorDatabase database;
+                if (!database.load(TRANSCRIPT_DIRECTORY + names[i]))
+                    return false;
+                for (uint64_t g = 0; g < database.size(); ++g) {
+                    uint8_t squares[WthorDatabase::MAX_MOVES];
+                    auto record = database.get_game(g);
+                    auto numMoves = WthorDatabase::decode(record, squares);
+                    if (numMoves == 0 || numMoves != record.get_num_moves())
+                        continue;
+                    auto &transcript = transcripts.emplace_back();
+                    for (int m = 0; m < numMoves; ++m) {
+                        transcript += (char)('a' + (squares[m] & 7));
+                        transcript += (char)('1' + (squares[m] >> 3));
+                    }
+                }
             } else {
-                matrixIndices->emplace_back(row);
-                matrixIndices->emplace_back((long)featureIndices[i]);
-                matrixValues->emplace_back((float)occurences);
-
-                if (featureIndices[i] >= NUM_PHASE_PARAMS)
-                    std::cerr << "col = " << featureIndices[i] << " >= " << NUM_PHASE_PARAMS
-                              << ", pattern = " << PATTERN_NAMES[FEATURE_TO_PATTERN[i]]
-                              << std::endl;
-                if (row >= labels->size())
-                    std::cerr << "row = " << row << " >= " << labels->size() << std::endl;
-                occurences = 1;
+                TranscriptFile file;
+                if (!file.load(TRANSCRIPT_DIRECTORY + names[i]))
+                    return false;
+                for (uint64_t g = 0; g < file.size(); ++g)
+                    transcripts.emplace_back(file[g]);
             }
+            progressBar.update(i + 1);
         }
-        ++row;
+
+        return MoveDataset::write(COMBINED_DATASET_DIRECTORY + filename, transcripts);
     }
 
-    std::vector<std::tuple<torch::Tensor, torch::Tensor>> EvalBuilder::load_phase_data(int phaseIndex, int batchSize, const std::string& filename) {
-        unsigned int numGames;
-        long numObservations;
-        long numEntries;
-        long numPhaseEntries[NUM_PHASES];
-        long numPhaseObservations[NUM_PHASES];
+    /**
+     * @brief get the positions that are trained on for a phase, as a number of moves from the start of the game
+     * @param phaseIndex the phase
+     * @param startDepth receives the first position
+     * @param endDepth receives the position after the last one
+     */
+    void EvalBuilder::get_phase_depths(int phaseIndex, int &startDepth, int &endDepth) {
+        #if TUNE_MODE_MIDGAME
+            startDepth = get_phase_start_disc_count(std::max(phaseIndex - 2, 0)) - 5;
+            endDepth = get_phase_end_disc_count(std::min(phaseIndex + 2, NUM_PHASES - 1)) - 4;
+        #else
+            startDepth = 59 - END_SEARCH_DEPTH;
+            endDepth = 60;
+        #endif
+    }
 
-        std::ifstream file(COMBINED_DATASET_DIRECTORY + filename, std::ios::binary);
+    /**
+     * @brief memory-map the position store of a training dataset, decoding the dataset into a new store first if it
+     * doesn't have an up to date one. Exits if neither works.
+     * @param datasetFilename name of the dataset in COMBINED_DATASET_DIRECTORY. Move datasets end in
+     * MOVE_DATASET_EXTENSION
+     * @param store receives the positions
+     */
+    void EvalBuilder::open_position_store(const std::string &datasetFilename, PositionStore &store) {
+        auto datasetPath = COMBINED_DATASET_DIRECTORY + datasetFilename;
+        auto storePath = datasetPath + POSITION_STORE_EXTENSION;
+        if (store.load(storePath, datasetPath))
+            return;
 
-        if (!file.is_open()) {
-            std::cerr << "Error opening file " << filename << std::endl;
+        if (!build_position_store(datasetPath, storePath) || !store.load(storePath, datasetPath)) {
+            std::cerr << "could not load position store " << storePath << std::endl;
             std::exit(1);
         }
+    }
 
-        // Read header to get the number of observations and entries
-        file.read(reinterpret_cast<char *>(&numGames), sizeof(int));
-        file.read(reinterpret_cast<char *>(&numObservations), sizeof(long));
-        file.read(reinterpret_cast<char *>(&numEntries), sizeof(long));
-        file.read(reinterpret_cast<char *>(numPhaseEntries), sizeof(long) * NUM_PHASES);
-        file.read(reinterpret_cast<char *>(numPhaseObservations), sizeof(long) * NUM_PHASES);
-        #if (TUNE_MODE_MIDGAME)
-            numEntries = numPhaseEntries[phaseIndex];
-            numObservations = numPhaseObservations[phaseIndex];
-        #endif
+    /**
+     * @brief open the positions a training run reads. By default that is the dataset's position store. A move dataset
+     * can instead be replayed by every phase as it trains, which takes no disk space beyond the dataset but computes
+     * every position's features once per phase and epoch. Exits if the data can't be opened.
+     * @param datasetFilename name of the dataset in COMBINED_DATASET_DIRECTORY
+     * @param usePositionStore whether to train from the position store. Only move datasets can be trained without one
+     * @param store receives the positions, if they are read from the store
+     * @param moveDataset receives the games, if they are replayed
+     * @return whether the games are replayed rather than read from the store
+     */
+    bool EvalBuilder::open_training_data(const std::string &datasetFilename, bool usePositionStore, PositionStore &store,
+                                         MoveDataset &moveDataset) {
+        if (!usePositionStore && datasetFilename.ends_with(MOVE_DATASET_EXTENSION)) {
+            if (!moveDataset.load(COMBINED_DATASET_DIRECTORY + datasetFilename)) {
+                std::cerr << "could not load move dataset " << datasetFilename << std::endl;
+                std::exit(1);
+            }
+            return true;
+        }
 
-        // initialize progress bar
-        util::ProgressBar progressBar((int) numGames,
-                                      "Loading phase " + std::to_string(phaseIndex) + '/' +
-                                      std::to_string(NUM_PHASES - 1),
-                                      util::FRACTION);
-        progressBar.print();
+        if (!usePositionStore)
+            std::cerr << "only move datasets can be trained without a position store, using one" << std::endl;
+        open_position_store(datasetFilename, store);
+        return false;
+    }
 
-        // initialize the linear regression system
-        auto *matrixIndices = new std::vector<int64_t>;
-        auto *matrixValues = new std::vector<float>;
-        auto *labels = new std::vector<float>;
+    /**
+     * @brief decode every position of a dataset into a position store, on every core
+     * @param datasetPath path of the dataset. Move datasets end in MOVE_DATASET_EXTENSION, and deduplicated
+     * datasets in POSITION_DATASET_EXTENSION
+     * @param storePath path of the store file
+     * @return whether the store was written
+     */
+    bool EvalBuilder::build_position_store(const std::string &datasetPath, const std::string &storePath) {
+        FeatureDataset featureDataset;
+        MoveDataset moveDataset;
+        PositionDataset positionDataset;
+        const bool isMoves = datasetPath.ends_with(MOVE_DATASET_EXTENSION);
+        const bool isPositions = datasetPath.ends_with(POSITION_DATASET_EXTENSION);
+        bool isLoaded = isPositions ? positionDataset.load(datasetPath) :
+                        isMoves ? moveDataset.load(datasetPath) : featureDataset.load(datasetPath);
+        if (!isLoaded)
+            return false;
 
-        matrixIndices->reserve(batchSize * NUM_FEATURES * 2);
-        matrixValues->reserve(batchSize * NUM_FEATURES);
-        labels->reserve(batchSize);
+        std::array<uint64_t, PositionStore::NUM_DEPTHS> depthCounts{};
+        uint64_t numGames, chunkSize;
+        if (isPositions) {
+            // each unique position is a record of its own
+            for (int d = 0; d < PositionStore::NUM_DEPTHS; ++d)
+                depthCounts[d] = positionDataset.get_depth_count(d);
+            numGames = positionDataset.size();
+            chunkSize = POSITION_CHUNK_SIZE;
+        } else {
+            // count the positions at each depth from the lengths of the games
+            numGames = isMoves ? moveDataset.size() : featureDataset.size();
+            chunkSize = TRAINING_CHUNK_SIZE;
+            std::array<uint64_t, PositionStore::NUM_DEPTHS + 1> numGamesOfLength{};
+            for (uint64_t g = 0; g < numGames; ++g) {
+                auto length = isMoves ? moveDataset.get_game(g).numMoves : featureDataset.get_game(g).numPositions;
+                ++numGamesOfLength[std::min(length, PositionStore::NUM_DEPTHS)];
+            }
+            uint64_t numLonger = 0;
+            for (int d = PositionStore::NUM_DEPTHS - 1; d >= 0; --d) {
+                numLonger += numGamesOfLength[d + 1];
+                depthCounts[d] = numLonger;
+            }
+        }
 
-        std::vector<std::tuple<torch::Tensor, torch::Tensor>> dataset;
-        dataset.reserve(1 + (numObservations - 1) / batchSize);
+        PositionStore::Builder builder(storePath, depthCounts, datasetPath);
+        if (!builder.is_open())
+            return false;
 
-        // Read the game features
-        int g, f, i;
-        int64_t row = 0;
-        float value;
-        uint8_t numPositions;
-        int8_t v;
+        const auto numChunks = (numGames + chunkSize - 1) / chunkSize;
+        util::ProgressBar progressBar((int) numChunks, "Decoding " + datasetPath.substr(datasetPath.rfind('/') + 1),
+                                      util::FRACTION);
+        progressBar.print();
 
-        // get the depth when the phase data starts and ends
-        #if TUNE_MODE_MIDGAME
-            int startDepth = get_phase_start_disc_count(std::max(phaseIndex - 2, 0)) - 5;
-            int endDepth = get_phase_end_disc_count(std::min(phaseIndex + 2, NUM_PHASES - 1)) - 4;
-        #else
-            int startDepth = 59 - END_SEARCH_DEPTH;
-            int endDepth = 60;
-        #endif
-        const unsigned int stepSize = sizeof(short) * NUM_FEATURES + sizeof(char);
-        const unsigned int startOffset = stepSize * startDepth;
-        int actualEndDepth;
-        unsigned short idx;
-        char negate;
+        std::atomic<uint64_t> nextChunk = 0;
+        std::atomic<int> numComplete = 0;
+        std::atomic<bool> printLock = false;
+        std::vector<std::thread> threads;
+        const int numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+        threads.reserve(numThreads);
+
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&]() {
+                for (auto chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+                    auto firstGame = chunk * chunkSize;
+                    auto lastGame = std::min(numGames, firstGame + chunkSize);
+                    if (isPositions)
+                        add_unique_positions(positionDataset, firstGame, lastGame, builder);
+                    else if (isMoves)
+                        add_move_games(moveDataset, firstGame, lastGame, builder);
+                    else
+                        add_feature_games(featureDataset, firstGame, lastGame, builder);
 
-        int indices[NUM_FEATURES];
+                    // print progress
+                    ++numComplete;
+                    if (!printLock) {
+                        printLock = true;
+                        progressBar.update(numComplete);
+                        printLock = false;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
 
-        for (g = 0; g < numGames; ++g) {
-            // read the number of positions and the value
-            file.read(reinterpret_cast<char *>(&numPositions), sizeof(uint8_t));
-            file.read(reinterpret_cast<char *>(&v), sizeof(int8_t));
+        return builder.commit();
+    }
 
-            if (numPositions < startDepth) {
-                file.seekg(numPositions * stepSize, std::ios::cur);
-                continue;
+    /**
+     * @brief get a decoder of the observations of a phase, which are a contiguous run of the store
+     * @param phaseIndex the phase
+     * @param store the positions of the dataset
+     * @param numChunks receives the number of chunks of the phase
+     * @return decodes chunks of POSITION_CHUNK_SIZE positions. Only valid while the store is loaded
+     */
+    ChunkDecoder EvalBuilder::make_chunk_decoder(int phaseIndex, const PositionStore &store, uint64_t &numChunks) {
+        int startDepth, endDepth;
+        get_phase_depths(phaseIndex, startDepth, endDepth);
+        const auto first = store.get_depth_start(startDepth);
+        const auto last = store.get_depth_start(endDepth);
+        numChunks = (last - first + POSITION_CHUNK_SIZE - 1) / POSITION_CHUNK_SIZE;
+
+        return [&store, first, last](uint64_t chunk, ObservationSink &sink) {
+            int indices[NUM_FEATURES];
+            auto begin = first + chunk * POSITION_CHUNK_SIZE;
+            auto end = std::min(last, begin + POSITION_CHUNK_SIZE);
+            for (auto i = begin; i < end; ++i) {
+                const auto &record = store[i];
+                for (int f = 0; f < NUM_FEATURES; ++f)
+                    indices[f] = (int)record.indices[f] + OFFSETS[f];
+                sink.add(indices, static_cast<float>(record.value));
             }
+        };
+    }
 
-            // skip to the start offset
-            file.seekg(startOffset, std::ios::cur);
+    /**
+     * @brief get a decoder that replays the games of a move dataset and computes the features of a phase's positions
+     * @param phaseIndex the phase
+     * @param dataset the games
+     * @param numChunks receives the number of chunks, of TRAINING_CHUNK_SIZE games each
+     * @return decodes chunks of games. Only valid while the dataset is loaded
+     */
+    ChunkDecoder EvalBuilder::make_chunk_decoder(int phaseIndex, const MoveDataset &dataset, uint64_t &numChunks) {
+        int startDepth, endDepth;
+        get_phase_depths(phaseIndex, startDepth, endDepth);
+        numChunks = (dataset.size() + TRAINING_CHUNK_SIZE - 1) / TRAINING_CHUNK_SIZE;
 
-            value = static_cast<float>(v);
+        return [&dataset, startDepth, endDepth](uint64_t chunk, ObservationSink &sink) {
+            int indices[NUM_FEATURES];
+            auto firstGame = chunk * TRAINING_CHUNK_SIZE;
+            auto lastGame = std::min(dataset.size(), firstGame + TRAINING_CHUNK_SIZE);
+            for (auto g = firstGame; g < lastGame; ++g) {
+                auto game = dataset.get_game(g);
+
+                // replay the game up to the end of the phase, as add_move_games does
+                Board board;
+                bool isBlack = true;
+                auto numMoves = std::min(game.numMoves, endDepth);
+                for (int i = 0; i < numMoves; ++i) {
+                    if (board.get_legal_moves() == 0) {
+                        board.pass();
+                        isBlack = !isBlack;
+                    }
+                    board.play_move(game.moves[i]);
+                    isBlack = !isBlack;
 
-            actualEndDepth = std::min((int)numPositions, endDepth);
+                    if (i >= startDepth) {
+                        compute_feature_indices(indices, board, 0);
+                        sink.add(indices, static_cast<float>(isBlack ? game.value : -game.value));
+                    }
+                }
+            }
+        };
+    }
 
-            // read the feature indices
-            for (i = startDepth; i < actualEndDepth; ++i) {
-                // determine if we negate the value for this position
-                file.read(reinterpret_cast<char *>(&negate), sizeof(char));
+    /**
+     * @brief add the positions of a range of games in a feature dataset to a position store
+     * @param firstGame index of the first game
+     * @param lastGame index after the last game
+     */
+    void EvalBuilder::add_feature_games(const FeatureDataset &dataset, uint64_t firstGame, uint64_t lastGame,
+                                        PositionStore::Builder &builder) {
+        uint16_t indices[NUM_FEATURES];
+
+        for (auto g = firstGame; g < lastGame; ++g) {
+            auto game = dataset.get_game(g);
+            auto numPositions = std::min(game.numPositions, PositionStore::NUM_DEPTHS);
+            for (int i = 0; i < numPositions; ++i) {
+                bool negate = FeatureDataset::read_record(game.records + i * FeatureDataset::RECORD_SIZE, indices);
+                builder.add(i, indices, negate ? -game.value : game.value);
+            }
+        }
+    }
 
-                // read the rest of the indices
-                for (f = 0; f < NUM_FEATURES; ++f) {
-                    file.read(reinterpret_cast<char *>(&idx), sizeof(short));
-                    indices[f] = (int)(idx) + OFFSETS[f];
+    /**
+     * @brief add the positions of a range of games in a move dataset to a position store. The games are replayed
+     * and their features computed.
+     * @param firstGame index of the first game
+     * @param lastGame index after the last game
+     */
+    void EvalBuilder::add_move_games(const MoveDataset &dataset, uint64_t firstGame, uint64_t lastGame,
+                                     PositionStore::Builder &builder) {
+        int indices[NUM_FEATURES];
+        uint16_t patternIndices[NUM_FEATURES];
+
+        for (auto g = firstGame; g < lastGame; ++g) {
+            auto game = dataset.get_game(g);
+
+            // replay the game, scoring each position for the side to move
+            Board board;
+            bool isBlack = true;
+            auto numMoves = std::min(game.numMoves, PositionStore::NUM_DEPTHS);
+            for (int i = 0; i < numMoves; ++i) {
+                if (board.get_legal_moves() == 0) {
+                    board.pass();
+                    isBlack = !isBlack;
                 }
+                board.play_move(game.moves[i]);
+                isBlack = !isBlack;
 
-                add_training_observation(matrixIndices, matrixValues, labels, row, indices, negate ? -value : value);
-
-                // add batch to the dataset
-                if (row >= batchSize) {
-                    matrixIndices->shrink_to_fit();
-                    matrixValues->shrink_to_fit();
-                    labels->shrink_to_fit();
-                    auto nnz = static_cast<int64_t>(matrixValues->size());
-                    auto torchIndices = torch::from_blob(
-                            matrixIndices->data(),
-                            {2, nnz},
-                            {1, 2},
-                            [matrixIndices](void*) { delete matrixIndices; },
-                            torch::kInt64
-                    );
-                    auto torchValues = torch::from_blob(
-                            matrixValues->data(),
-                            {nnz},
-                            [matrixValues](void*) { delete matrixValues; },
-                            torch::kFloat32
-                    );
-                    auto torchLabels = torch::from_blob(
-                            labels->data(),
-                            {static_cast<int64_t>(labels->size())},
-                            [labels](void*) { delete labels; },
-                            torch::kFloat32
-                    );
-                    auto torchData = torch::_sparse_coo_tensor_unsafe(
-                            torchIndices,
-                            torchValues,
-                            {batchSize, NUM_PHASE_PARAMS},
-                            torch::kFloat32
-                    );
-                    dataset.emplace_back(torchData, torchLabels);
-
-                    // reset the batch
-                    matrixIndices = new std::vector<int64_t>;
-                    matrixValues = new std::vector<float>;
-                    labels = new std::vector<float>;
-                    matrixIndices->reserve(batchSize * NUM_FEATURES * 2);
-                    matrixValues->reserve(batchSize * NUM_FEATURES);
-                    labels->reserve(batchSize);
-                    row = 0;
-                }
+                compute_feature_indices(indices, board, 0);
+                for (int f = 0; f < NUM_FEATURES; ++f)
+                    patternIndices[f] = (uint16_t)(indices[f] - OFFSETS[f]);
+                builder.add(i, patternIndices, isBlack ? game.value : -game.value);
             }
-            if (i != numPositions) {
-                file.seekg((numPositions - i) * stepSize, std::ios::cur);
-            }
-            progressBar.update(g + 1);
         }
-        file.close();
+    }
 
-        // add the last batch
-        if (row > 0) {
-            matrixIndices->shrink_to_fit();
-            matrixValues->shrink_to_fit();
-            labels->shrink_to_fit();
-            auto nnz = static_cast<int64_t>(matrixValues->size());
-            auto torchIndices = torch::from_blob(
-                    matrixIndices->data(),
-                    {2, nnz},
-                    {1, 2},
-                    [matrixIndices](void*) { delete matrixIndices; },
-                    torch::kInt64
-            );
-            auto torchValues = torch::from_blob(
-                    matrixValues->data(),
-                    {nnz},
-                    [matrixValues](void*) { delete matrixValues; },
-                    torch::kFloat32
-            );
-            auto torchLabels = torch::from_blob(
-                    labels->data(),
-                    {row},
-                    [labels](void*) { delete labels; },
-                    torch::kFloat32
-            );
-            auto torchData = torch::_sparse_coo_tensor_unsafe(
-                    torchIndices,
-                    torchValues,
-                    {row, NUM_PHASE_PARAMS},
-                    torch::kFloat32
-            );
-            dataset.emplace_back(torchData, torchLabels);
+    void EvalBuilder::add_unique_positions(const PositionDataset &dataset, uint64_t first, uint64_t last,
+                                           PositionStore::Builder &builder) {
+        int indices[NUM_FEATURES];
+        uint16_t patternIndices[NUM_FEATURES];
+
+        for (auto i = first; i < last; ++i) {
+            const auto &record = dataset[i];
+            Board board(record.P, record.O);
+            compute_feature_indices(indices, board, 0);
+            for (int f = 0; f < NUM_FEATURES; ++f)
+                patternIndices[f] = (uint16_t)(indices[f] - OFFSETS[f]);
+
+            // the store's labels are whole discs
+            auto depth = std::clamp(std::popcount(record.P | record.O) - 5, 0, PositionStore::NUM_DEPTHS - 1);
+            builder.add(depth, patternIndices, (int)std::lround(record.value));
         }
-
-        return std::move(dataset);
     }
 
     bool EvalBuilder::has_plateaued(const std::vector<std::pair<int, float>>& data, int sampleSize, float threshold) {
@@ -1022,7 +1419,8 @@ namespace engine::eval {
         return slope > -threshold;
     }
 
-    void EvalBuilder::train_phase(const std::string &datasetFilename, int phaseIndex, int batchSize, int numEpochs,
+#if USE_TORCH
+    void EvalBuilder::train_phase(const ChunkDecoder &decoder, uint64_t numChunks, int phaseIndex, int batchSize, int numEpochs,
                                   bool loadWeights, bool verbose, float learningRate, float lossSlopeThreshold) {
         std::random_device rd;
         std::mt19937 g(rd());
@@ -1054,26 +1452,19 @@ namespace engine::eval {
         model.train();
 
         {
-            auto data = load_phase_data(phaseIndex, batchSize, datasetFilename);
+            // build batches of the phase's positions on background threads while the optimizer runs
+            BatchPipeline pipeline(numChunks, batchSize, decoder);
+
             std::vector<std::pair<int, float>> losses;
             losses.reserve(numEpochs);
 
-            // get number of observations'
-            unsigned int numObservations = 0;
-            for (auto &[X, y]: data) {
-                numObservations += y.size(0);
-                X.to(deviceType);
-                y.to(deviceType);
-            }
-            auto numObservationsFloat = (float) numObservations;
-
             std::cout << "\033[33;1mPHASE " << std::to_string(phaseIndex) << "/" + std::to_string(NUM_PHASES - 1)
                       << "\033[0m" << std::endl;
             int epoch;
             for (epoch = 1; epoch <= numEpochs; ++epoch) {
-                std::shuffle(data.begin(), data.end(), g);
+                pipeline.start_epoch(g);
                 util::ProgressBar progressBar(
-                        (int) data.size(),
+                        (int) pipeline.get_num_chunks(),
                         "\033[32;1mPhase " + std::to_string(phaseIndex) + " Epoch " + std::to_string(epoch) + "/" +
                         std::to_string(numEpochs) + "\033[0m",
                         util::FRACTION,
@@ -1081,7 +1472,13 @@ namespace engine::eval {
                 if (verbose)
                     progressBar.print();
                 float meanLoss = 0;
-                for (auto &[X, y]: data) {
+                int64_t numObservations = 0;
+                Batch batch;
+                while (pipeline.next(batch)) {
+                    auto X = std::get<0>(batch).to(deviceType);
+                    auto y = std::get<1>(batch).to(deviceType);
+                    numObservations += y.size(0);
+
                     optimizer.zero_grad();
                     auto output = model.forward(X).squeeze(1);
                     auto loss = criterion(output, y);
@@ -1089,8 +1486,9 @@ namespace engine::eval {
                     optimizer.step();
                     meanLoss += loss.item().toFloat();
                     if (verbose)
-                        progressBar.update();
+                        progressBar.update((int) pipeline.get_num_chunks_done());
                 }
+                auto numObservationsFloat = (float) std::max(numObservations, (int64_t) 1);
 
                 // print loss
                 meanLoss /= numObservationsFloat;
@@ -1143,10 +1541,25 @@ namespace engine::eval {
      * @param loadWeights whether to load the weights from the file
      * @param verbose whether to print verbose output
      * @param maxThreads the maximum number of threads to use
+     * @param usePositionStore whether to train from the position store, or to replay a move dataset in every phase
      */
-    void EvalBuilder::train(const std::string& datasetFilename, int numEpochs, int batchSize, bool loadWeights, bool verbose, int maxThreads) {
+    void EvalBuilder::train(const std::string& datasetFilename, int numEpochs, int batchSize, bool loadWeights, bool verbose, int maxThreads,
+                            bool usePositionStore) {
         if (!initialized)
             init();
+
+        // every phase reads its window of the same store, or replays the same games
+        PositionStore store;
+        MoveDataset moveDataset;
+        const bool isReplayed = open_training_data(datasetFilename, usePositionStore, store, moveDataset);
+        auto trainPhase = [&](int phase, bool isVerbose, float lossSlopeThreshold) {
+            uint64_t numChunks;
+            auto decoder = isReplayed ? make_chunk_decoder(phase, moveDataset, numChunks)
+                                      : make_chunk_decoder(phase, store, numChunks);
+            train_phase(decoder, numChunks, phase, batchSize, numEpochs, loadWeights, isVerbose, 0.01,
+                        lossSlopeThreshold);
+        };
+
         // train the weights for each phase
         maxThreads = std::min(maxThreads, NUM_PHASES);
 
@@ -1158,15 +1571,14 @@ namespace engine::eval {
 
             for (int i = 0; i < maxThreads; ++i) {
                 threads.emplace_back(
-                        [&phaseIndex, &mtx, maxThreads, datasetFilename, batchSize, numEpochs, loadWeights, verbose]() {
+                        [&phaseIndex, &mtx, &trainPhase, maxThreads, verbose]() {
                             int phase;
                             while (phaseIndex < NUM_PHASES) {
                                 mtx.lock();
                                 phase = phaseIndex++;
                                 mtx.unlock();
                                 if (phase < NUM_PHASES)
-                                    train_phase(datasetFilename, phase, batchSize, numEpochs, loadWeights,
-                                                verbose && maxThreads == 1, 0.01, 0.001);
+                                    trainPhase(phase, verbose && maxThreads == 1, 0.001);
                             }
                         });
             }
@@ -1174,7 +1586,7 @@ namespace engine::eval {
                 thread.join();
         } else if (maxThreads == 1) {
             for (int i = 0; i < NUM_PHASES; ++i) {
-                train_phase(datasetFilename, i, batchSize, numEpochs, loadWeights, verbose, 0.01, 0.0001);
+                trainPhase(i, verbose, 0.0001);
             }
         } else {
             std::cerr << "Invalid number of threads: " << maxThreads << std::endl;
@@ -1187,6 +1599,120 @@ namespace engine::eval {
         // load the weights from the saved tensorflow models and save them
         save_from_model(MODEL_NAME, MODEL_NAME " model");
     }
+#endif
+
+    /**
+     * @brief train the weights with the native sparse trainer, one phase at a time on every thread. Writes the same
+     * raw and post-processed weight files as train.
+     * @param datasetFilename the name of the file with the dataset
+     * @param numEpochs the maximum number of epochs per phase
+     * @param batchSize the number of observations per update
+     * @param loadWeights whether to continue from the raw weight file
+     * @param verbose whether to print verbose output
+     * @param numThreads the number of threads updating the weights at once
+     * @param optimizer the update rule
+     * @param learningRate the step size
+     * @param usePositionStore whether to train from the position store, or to replay a move dataset in every phase
+     */
+    void EvalBuilder::train_sparse(const std::string& datasetFilename, int numEpochs, int batchSize, bool loadWeights,
+                                   bool verbose, int numThreads, SparseTrainer::Optimizer optimizer,
+                                   float learningRate, bool usePositionStore) {
+        if (!initialized)
+            init();
+
+        PositionStore store;
+        MoveDataset moveDataset;
+        const bool isReplayed = open_training_data(datasetFilename, usePositionStore, store, moveDataset);
+
+        auto *weights = new float[NUM_EVAL_PARAMS]{};
+        if (loadWeights) {
+            // the raw file is scaled by EVAL_SCALE, and the model predicts disc differences
+            load(weights, MODEL_NAME " raw.bin");
+            for (int i = 0; i < NUM_EVAL_PARAMS; ++i)
+                weights[i] /= (float)EVAL_SCALE;
+        }
+
+        for (int phase = 0; phase < NUM_PHASES; ++phase) {
+            uint64_t numChunks;
+            auto decoder = isReplayed ? make_chunk_decoder(phase, moveDataset, numChunks)
+                                      : make_chunk_decoder(phase, store, numChunks);
+            train_sparse_phase(weights, decoder, numChunks, phase, batchSize, numEpochs, verbose, numThreads,
+                               optimizer, learningRate, 0.001);
+            save_sparse_checkpoint(weights);
+        }
+
+        std::cout << "\033[1;32mTraining complete.\033[0m" << std::endl;
+        std::cout << "\033[1;33mPost Processing...\033[0m" << std::endl;
+
+        for (int i = 0; i < NUM_EVAL_PARAMS; ++i)
+            weights[i] *= (float)EVAL_SCALE;
+        post_process(weights);
+        save(weights, MODEL_NAME ".bin", true);
+        delete[] weights;
+        std::cout << "Save complete." << std::endl;
+    }
+
+    void EvalBuilder::train_sparse_phase(float* weights, const ChunkDecoder& decoder, uint64_t numChunks,
+                                         int phaseIndex, int batchSize, int numEpochs, bool verbose, int numThreads,
+                                         SparseTrainer::Optimizer optimizer, float learningRate,
+                                         float lossSlopeThreshold) {
+        std::random_device rd;
+        std::mt19937 g(rd());
+
+        SparseTrainer trainer(weights + phaseIndex * NUM_PHASE_PARAMS, NUM_PHASE_PARAMS, optimizer, learningRate,
+                              batchSize, numThreads);
+        std::vector<std::pair<int, float>> losses;
+        losses.reserve(numEpochs);
+
+        std::cout << "\033[33;1mPHASE " << std::to_string(phaseIndex) << "/" + std::to_string(NUM_PHASES - 1)
+                  << "\033[0m" << std::endl;
+        int epoch;
+        for (epoch = 1; epoch <= numEpochs; ++epoch) {
+            util::ProgressBar progressBar(
+                    (int) numChunks,
+                    "\033[32;1mPhase " + std::to_string(phaseIndex) + " Epoch " + std::to_string(epoch) + "/" +
+                    std::to_string(numEpochs) + "\033[0m",
+                    util::FRACTION,
+                    false);
+            if (verbose)
+                progressBar.print();
+
+            auto meanLoss = (float) trainer.train_epoch(decoder, numChunks, g, verbose ? &progressBar : nullptr);
+            losses.emplace_back(epoch, meanLoss);
+            if (!verbose)
+                progressBar.finish();
+            std::cout << "  \033[1;31mLoss = " << meanLoss << "\033[0m" << std::endl;
+
+            // check for plateau in last 10 losses using regression analysis
+            if (has_plateaued(losses, 10, lossSlopeThreshold))
+                break;
+
+            // save checkpoint every 10 epochs
+            if (epoch != numEpochs && epoch % 10 == 0) {
+                std::cout << "\033[1;34mSaving checkpoint at " << epoch << " epochs...\033[0m" << std::endl;
+                save_sparse_checkpoint(weights);
+            }
+        }
+        std::cout << "\033[1;36mPhase " << phaseIndex << " complete after " << std::min(epoch, numEpochs)
+                  << " epochs.\033[0m" << std::endl;
+
+        // save loss history
+        std::ofstream lossFile(LOSS_DIRECTORY "loss" + std::to_string(phaseIndex) + ".txt");
+        for (auto [ep, loss]: losses)
+            lossFile << ep << ':' << loss << std::endl;
+        lossFile.close();
+    }
+
+    /**
+     * @brief save the weights being trained as the raw weight file, which train_sparse can continue from
+     * @param weights the weights of every phase, unscaled
+     */
+    void EvalBuilder::save_sparse_checkpoint(const float* weights) {
+        std::vector<float> scaled(weights, weights + NUM_EVAL_PARAMS);
+        for (auto &w: scaled)
+            w *= (float)EVAL_SCALE;
+        save(scaled.data(), MODEL_NAME " raw.bin", false);
+    }
 
     // POST PROCESSING
 
@@ -1454,6 +1980,7 @@ namespace engine::eval {
 
     // SAVING AND LOADING
 
+#if USE_TORCH
     void EvalBuilder::save_from_model(const std::string& filename, const std::string& modelFilename) {
         auto* weights = new float[NUM_EVAL_PARAMS];
         for (int phase = 0; phase < NUM_PHASES; ++phase) {
@@ -1484,6 +2011,7 @@ namespace engine::eval {
             weights[i] *= (float)EVAL_SCALE;
         }
     }
+#endif
 
     void EvalBuilder::save(const float* weights, const std::string& filename, bool round) {
         std::ofstream outFile(WEIGHT_DIRECTORY + filename, std::ios::binary);
@@ -6,18 +6,31 @@
 #define OTHELLO_EVALBUILDER_H
 
 #include "../../Game/Board.h"
+#include "../../Game/WthorDatabase.h"
 #include "../../Util.h"
 #include "TernaryIndices.h"
 #include "Evaluation.h"
+#include "FeatureDataset.h"
+#include "MoveDataset.h"
+#include "ObservationSink.h"
+#include "PositionDataset.h"
+#include "PositionStore.h"
+#include "SparseTrainer.h"
+#include "TranscriptFile.h"
+#include <string_view>
+#include <thread>
 #include <utility>
 
-#ifdef slots
-#undef slots
-#endif
-#include "LinearModel.h"
-#include <torch/torch.h>
-#ifdef slots
-#define slots Q_SLOTS
+#if USE_TORCH
+    #ifdef slots
+    #undef slots
+    #endif
+    #include "LinearModel.h"
+    #include "BatchPipeline.h"
+    #include <torch/torch.h>
+    #ifdef slots
+    #define slots Q_SLOTS
+    #endif
 #endif
 
 namespace engine::eval {
@@ -33,28 +46,36 @@ namespace engine::eval {
     class EvalBuilder {
     public:
         static void init();
-        static void preprocess_transcripts(int maxThreads, int numFilesPerBatch, bool hasLogbook = false);
-        static void train(const std::string& datasetFilename, int numEpochs = 1000, int batchSize = 120000, bool loadWeights = false, bool verbose = true, int maxThreads = 4);
+        static void preprocess_transcripts(int maxThreads, int numBatchesPerDataset, bool hasLogbook = false);
+        #if USE_TORCH
+        static void train(const std::string& datasetFilename, int numEpochs = 1000, int batchSize = 120000, bool loadWeights = false, bool verbose = true, int maxThreads = 4,
+                          bool usePositionStore = true);
+        #endif
+        static void train_sparse(const std::string& datasetFilename, int numEpochs = 1000, int batchSize = 256, bool loadWeights = false, bool verbose = true,
+                                 int numThreads = (int)std::thread::hardware_concurrency(), SparseTrainer::Optimizer optimizer = SparseTrainer::Optimizer::ADAM, float learningRate = 0.01,
+                                 bool usePositionStore = true);
         static void test(const std::string& weightFile, const std::string& gamesFile, const std::string& windowTitle = "Test Results");
 
         static void load(float* weights, const std::string& filename);
         static void load_short(short* weights, const std::string& filename);
         static void save(const float* weights, const std::string& filename, bool round = true);
+        #if USE_TORCH
         static void save_from_model(const std::string& filename, const std::string& modelFilename);
+        #endif
 
         static void post_process(float* weights);
         static void generate_eval_constants();
 
         static void reformat_logbook();
-        static void reformat_transcripts();
 
         static void print_feature_permutation(const Feature* feature, int index);
         [[nodiscard]] static Board feature_to_board(const Feature* feature, int index);
         [[nodiscard]] static int evaluate(Board board, const short* weights);
 
-        [[nodiscard]] static int count_transcripts();
-        static void init_batches(int maxThreads, int numBatches=-1);
-        static void combine_batches(int maxThreads, int numBatchesPerBatch, int firstNewBatchIndex);
+        static bool ingest_transcripts(int maxThreads);
+        static bool combine_batches(int maxThreads, int numBatchesPerBatch, int firstNewBatchIndex);
+        static bool write_games(const std::string& filepath, const std::vector<std::string>& transcripts);
+        static bool write_move_dataset(const std::string& filename);
 
     private:
         struct GameData {
@@ -64,6 +85,15 @@ namespace engine::eval {
             int8_t value{};
         };
 
+        struct TranscriptEntry {
+            std::string name;         // file name in TRANSCRIPT_DIRECTORY
+            uint64_t fileSize = 0;    // size and modification time of the file when it was ingested
+            int64_t fileTime = 0;
+            uint64_t numGames = 0;
+            int firstBatch = 0;       // its games are in batches [firstBatch, firstBatch + numBatches)
+            int numBatches = 0;
+        };
+
         enum MirrorType {
             NONE = 0,       // asymmetric
             VERTICAL = 1,   // mirror vertical
@@ -97,16 +127,34 @@ namespace engine::eval {
         [[maybe_unused]] static void test_mirrors();
         [[maybe_unused]] static void test_features();
 
+        static long count_position_entries(const int *indices, int numDiscs, long *numPhaseEntries, long *numPhaseObservations);
         static long compute_game_features(GameFeatures& gameFeatures, const GameData& gameData, long *numPhaseEntries, long *numPhaseObservations);
-        static unsigned int parse_game(GameData& gameData, const std::string& transcript);
+        static unsigned int parse_game(GameData& gameData, std::string_view transcript);
+        static unsigned int parse_game(GameData& gameData, const uint8_t* squares, int numMoves);
         static unsigned int parse_games(std::vector<GameData>& games, const std::string& filename, bool verbose = false);
-        static void make_combined_batch(int firstBatchIndex, int numBatches, int newBatchIndex);
-        static void write_batch_data(int batchIndex);
-
-        static void add_training_observation(std::vector<int64_t> *matrixIndices, std::vector<float> *matrixValues, std::vector<float> *labels, int64_t& row, int* featureIndices, float value);
-        static void train_phase(const std::string& datasetFilename, int phaseIndex, int batchSize, int numEpochs, bool loadWeights, bool verbose, float learningRate = 0.01, float lossSlopeThreshold = 0.001);
+        [[nodiscard]] static std::vector<std::string> list_transcripts();
+        [[nodiscard]] static bool is_wthor(const std::string& filepath);
+        [[nodiscard]] static std::vector<TranscriptEntry> read_manifest();
+        static bool write_manifest(const std::vector<TranscriptEntry>& entries);
+        [[nodiscard]] static std::string get_batch_filepath(int batchIndex);
+        static bool write_game_data(const std::string& filepath, const std::vector<GameData>& games, long numObservations);
+
+        #if USE_TORCH
+        static void train_phase(const ChunkDecoder& decoder, uint64_t numChunks, int phaseIndex, int batchSize, int numEpochs, bool loadWeights, bool verbose, float learningRate = 0.01, float lossSlopeThreshold = 0.001);
+        #endif
+        static void train_sparse_phase(float* weights, const ChunkDecoder& decoder, uint64_t numChunks, int phaseIndex, int batchSize, int numEpochs, bool verbose,
+                                       int numThreads, SparseTrainer::Optimizer optimizer, float learningRate, float lossSlopeThreshold);
+        static void save_sparse_checkpoint(const float* weights);
         [[nodiscard]] static bool has_plateaued(const std::vector<std::pair<int, float>>& data, int sampleSize, float threshold = 0.003f);
-        [[nodiscard]] static std::vector<std::tuple<torch::Tensor, torch::Tensor>> load_phase_data(int phaseIndex, int batchSize, const std::string& filename);
+        static void get_phase_depths(int phaseIndex, int& startDepth, int& endDepth);
+        static void open_position_store(const std::string& datasetFilename, PositionStore& store);
+        static bool open_training_data(const std::string& datasetFilename, bool usePositionStore, PositionStore& store, MoveDataset& moveDataset);
+        static bool build_position_store(const std::string& datasetPath, const std::string& storePath);
+        [[nodiscard]] static ChunkDecoder make_chunk_decoder(int phaseIndex, const PositionStore& store, uint64_t& numChunks);
+        [[nodiscard]] static ChunkDecoder make_chunk_decoder(int phaseIndex, const MoveDataset& dataset, uint64_t& numChunks);
+        static void add_feature_games(const FeatureDataset& dataset, uint64_t firstGame, uint64_t lastGame, PositionStore::Builder& builder);
+        static void add_move_games(const MoveDataset& dataset, uint64_t firstGame, uint64_t lastGame, PositionStore::Builder& builder);
+        static void add_unique_positions(const PositionDataset& dataset, uint64_t first, uint64_t last, PositionStore::Builder& builder);
 
         static void interpolate_weights(float* weights);
         static void mirror_weights(float* weights);
@@ -119,7 +167,9 @@ namespace engine::eval {
             return (phase + 1) * NUM_PHASE_DISCS + 4;
         }
 
+        #if USE_TORCH
         static void pt_to_weights(float* weights, const std::string& filename);
+        #endif
 
         static Feature MIRRORED_FEATURES[NUM_PATTERN_SYMMETRIES];
         static int MIRRORED_ORDER[NUM_PATTERNS][MAX_FEATURE_SIZE];
@@ -8,17 +8,14 @@
 #include <fstream>
 
 namespace engine::eval {
-    short EvaluationFeatures::PATTERN_WEIGHTS[2][NUM_PHASES][NUM_PATTERNS][POW3[MAX_FEATURE_SIZE]];     // [reversed][phase][pattern][feature]
-    short EvaluationFeatures::PATTERN_WEIGHTS_END[2][NUM_PATTERNS_END][POW3[MAX_FEATURE_SIZE]];         // [reversed][phase][pattern][feature]
-    short EvaluationFeatures::SURROUND_WEIGHTS[NUM_PHASES][MAX_SURROUND][MAX_SURROUND];                 // [phase][player_surround][opp_surround]
-    short EvaluationFeatures::SCORE_WEIGHTS[NUM_PHASES][SCORE_RANGE][SCORE_RANGE];                      // [phase][player_discs][opp_discs]
+    EvaluationWeights EvaluationFeatures::WEIGHTS;
 
-    void EvaluationFeatures::eval_init(const std::string& filepath, const std::string& filepathEnd) {
+    bool EvaluationWeights::load(const std::string& filepath, const std::string& filepathEnd) {
         std::ifstream file(filepath, std::ios::binary);
 
         if (!file.is_open()) {
             std::cout << "Error opening file: " << filepath << std::endl;
-            exit(1);
+            return false;
         }
 
         std::string weight;
@@ -33,18 +30,18 @@ namespace engine::eval {
                 numPatternPermutations = POW3[numPatternDiscs];
                 for (auto i = 0; i < numPatternPermutations; ++i) {
                     file.read(reinterpret_cast<char *>(&w), sizeof(short));
-                    PATTERN_WEIGHTS[0][phase][pattern][i] = w;
-                    PATTERN_WEIGHTS[1][phase][pattern][get_reversed_index(i, numPatternDiscs)] = w;
+                    this->pattern[0][phase][pattern][i] = w;
+                    this->pattern[1][phase][pattern][EvaluationFeatures::get_reversed_index(i, numPatternDiscs)] = w;
                 }
             }
             for (int p = 0; p < SCORE_RANGE; ++p) {
                 for (int o = 0; o < SCORE_RANGE; ++o) {
-                    file.read(reinterpret_cast<char *>(&SCORE_WEIGHTS[phase][p][o]), sizeof(short));
+                    file.read(reinterpret_cast<char *>(&this->score[phase][p][o]), sizeof(short));
                 }
             }
             for (int p = 0; p < MAX_SURROUND; ++p) {
                 for (int o = 0; o < MAX_SURROUND; ++o) {
-                    file.read(reinterpret_cast<char *>(&SURROUND_WEIGHTS[phase][p][o]), sizeof(short));
+                    file.read(reinterpret_cast<char *>(&this->surround[phase][p][o]), sizeof(short));
                 }
             }
         }
@@ -54,7 +51,7 @@ namespace engine::eval {
 
         if (!file.is_open()) {
             std::cout << "Error opening file: " << filepathEnd << std::endl;
-            exit(1);
+            return false;
         }
 
         for (patternIdx = 0; patternIdx < NUM_PATTERNS_END; ++patternIdx) {
@@ -62,12 +59,18 @@ namespace engine::eval {
             numPatternPermutations = POW3[numPatternDiscs];
             for (auto i = 0; i < numPatternPermutations; ++i) {
                 file.read(reinterpret_cast<char *>(&w), sizeof(short));
-                PATTERN_WEIGHTS_END[0][patternIdx][i] = w;
-                PATTERN_WEIGHTS_END[1][patternIdx][get_reversed_index(i, numPatternDiscs)] = w;
+                this->patternEnd[0][patternIdx][i] = w;
+                this->patternEnd[1][patternIdx][EvaluationFeatures::get_reversed_index(i, numPatternDiscs)] = w;
             }
         }
 
         file.close();
+        return true;
+    }
+
+    void EvaluationFeatures::eval_init(const std::string& filepath, const std::string& filepathEnd) {
+        if (!WEIGHTS.load(filepath, filepathEnd))
+            exit(1);
     }
 
     EvaluationFeatures::EvaluationFeatures(const Board *board) :
@@ -88,8 +91,8 @@ namespace engine::eval {
         auto scoreO = node->discCount - scoreP;
 
         int value = pattern_evaluate(phase) +
-                SURROUND_WEIGHTS[phase][surroundP][surroundO] +
-                SCORE_WEIGHTS[phase][scoreP][scoreO];
+                this->weights->surround[phase][surroundP][surroundO] +
+                this->weights->score[phase][scoreP][scoreO];
 
         value += value >= 0 ? HALF_EVAL_SCALE : -HALF_EVAL_SCALE;
         value >>= EVAL_SCALE_LOG_2;
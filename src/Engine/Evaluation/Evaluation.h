@@ -382,6 +382,25 @@ namespace engine {
             }
         #endif
 
+        /**
+         * @brief weights of the evaluation function. Engines that play with different weights each point their search
+         * nodes at their own set; every other search uses EvaluationFeatures::WEIGHTS.
+         */
+        struct EvaluationWeights {
+            /**
+             * @brief read a midgame weight file and an endgame move ordering weight file
+             * @param filepath: midgame weights
+             * @param filepathEnd: endgame move ordering weights
+             * @return whether both files were read
+             */
+            bool load(const std::string &filepath = WEIGHT_FILEPATH, const std::string &filepathEnd = WEIGHT_FILEPATH_END);
+
+            short pattern[2][NUM_PHASES][NUM_PATTERNS][POW3[MAX_FEATURE_SIZE]];     // [reversed][phase][pattern][feature]
+            short patternEnd[2][NUM_PATTERNS_END][POW3[MAX_FEATURE_SIZE]];          // [reversed][pattern][feature]
+            short surround[NUM_PHASES][MAX_SURROUND][MAX_SURROUND];                 // [phase][player_surround][opp_surround]
+            short score[NUM_PHASES][SCORE_RANGE][SCORE_RANGE];                      // [phase][player_discs][opp_discs]
+        };
+
         class EvaluationFeatures {
         public:
             EvaluationFeatures() = default;
@@ -547,7 +566,7 @@ namespace engine {
             [[nodiscard]] inline int pattern_evaluate(int phase) {
                 int score = 0;
 
-                auto phaseWeights = PATTERN_WEIGHTS[ reversed ][ phase ];
+                auto phaseWeights = this->weights->pattern[ reversed ][ phase ];
 
                 #pragma omp simd
                 for (int i = 0; i < NUM_PATTERN_SYMMETRIES; ++i)
@@ -560,7 +579,7 @@ namespace engine {
                 int score = 0;
                 #pragma omp simd
                 for (int i = 0; i < NUM_PATTERN_SYMMETRIES_END; i++) {
-                    score += PATTERN_WEIGHTS_END[reversed][FEATURE_TO_PATTERN[i]][features[i]];
+                    score += this->weights->patternEnd[reversed][FEATURE_TO_PATTERN[i]][features[i]];
                 }
                 return score;
             }
@@ -591,16 +610,22 @@ namespace engine {
             [[nodiscard]] int mid_evaluate(const SearchNode *node);
             [[nodiscard]] int end_evaluate_move_ordering(SearchNode *node);
 
+            /**
+             * @brief evaluate with other weights than the default ones
+             * @param evaluationWeights: the weights, or nullptr for the default weights. Must outlive the features
+             */
+            inline void set_weights(const EvaluationWeights *evaluationWeights) {
+                this->weights = evaluationWeights != nullptr ? evaluationWeights : &WEIGHTS;
+            }
+
             static void eval_init(const std::string &filepath = WEIGHT_FILEPATH, const std::string &filepathEnd = WEIGHT_FILEPATH_END);
 
-            static short PATTERN_WEIGHTS[2][NUM_PHASES][NUM_PATTERNS][POW3[MAX_FEATURE_SIZE]];     // [reversed][phase][pattern][feature]
-            static short PATTERN_WEIGHTS_END[2][NUM_PATTERNS_END][POW3[MAX_FEATURE_SIZE]];         // [reversed][phase][pattern][feature]
-            static short SURROUND_WEIGHTS[NUM_PHASES][MAX_SURROUND][MAX_SURROUND];                 // [phase][player_surround][opp_surround]
-            static short SCORE_WEIGHTS[NUM_PHASES][SCORE_RANGE][SCORE_RANGE];                      // [phase][player_discs][opp_discs]
+            static EvaluationWeights WEIGHTS;  // default weights, loaded by eval_init
 
             private:
                 int features[NUM_PATTERN_SYMMETRIES]{};
                 bool reversed = false;
+                const EvaluationWeights *weights = &WEIGHTS;
         };
     } //eval
 } // engine
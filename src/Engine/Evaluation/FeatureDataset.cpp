@@ -0,0 +1,78 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "FeatureDataset.h"
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace engine::eval {
+    // numGames, numObservations, numEntries, numPhaseEntries, numPhaseObservations
+    constexpr size_t HEADER_SIZE = sizeof(unsigned int) + sizeof(long) * (2 + 2 * NUM_PHASES);
+
+    FeatureDataset::~FeatureDataset() {
+        this->unload();
+    }
+
+    void FeatureDataset::unload() {
+        if (this->mapping != nullptr)
+            munmap(this->mapping, this->mappingSize);
+        this->mapping = nullptr;
+        this->mappingSize = 0;
+        this->data = nullptr;
+        this->offsets.clear();
+    }
+
+    bool FeatureDataset::load(const std::string &filepath) {
+        this->unload();
+
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "could not open dataset " << filepath << std::endl;
+            return false;
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)HEADER_SIZE) {
+            std::cerr << "invalid dataset " << filepath << std::endl;
+            close(fd);
+            return false;
+        }
+
+        auto size = (size_t)st.st_size;
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "could not map dataset " << filepath << std::endl;
+            return false;
+        }
+        this->mapping = mapped;
+        this->mappingSize = size;
+        this->data = (const char *)mapped;
+
+        unsigned int numGames;
+        std::memcpy(&numGames, this->data, sizeof(unsigned int));
+        std::memcpy(this->numPhaseObservations, this->data + HEADER_SIZE - sizeof(long) * NUM_PHASES,
+                    sizeof(long) * NUM_PHASES);
+
+        // index the games. Only the two bytes in front of each game are touched
+        this->offsets.reserve(numGames);
+        size_t offset = HEADER_SIZE;
+        for (unsigned int g = 0; g < numGames; ++g) {
+            if (offset + 2 > size)
+                break;
+            this->offsets.push_back(offset);
+            offset += 2 + (uint8_t)this->data[offset] * RECORD_SIZE;
+        }
+
+        if (this->offsets.size() != numGames || offset != size) {
+            std::cerr << "invalid dataset " << filepath << std::endl;
+            this->unload();
+            return false;
+        }
+        return true;
+    }
+}
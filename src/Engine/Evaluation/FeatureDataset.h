@@ -0,0 +1,81 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_FEATUREDATASET_H
+#define OTHELLO_FEATUREDATASET_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Evaluation.h"
+
+namespace engine::eval {
+
+    /**
+     * @brief read-only view of a feature dataset written by EvalBuilder, memory-mapped from its file.
+     *
+     * Games in a feature dataset have different lengths, so loading scans the file once to index where each game
+     * starts. After that any game can be read without the ones before it, which lets several threads decode
+     * different parts of the dataset at the same time.
+     */
+    class FeatureDataset {
+    public:
+        static constexpr size_t RECORD_SIZE = sizeof(char) + sizeof(uint16_t) * NUM_FEATURES;
+
+        struct Game {
+            const char *records;  // numPositions records of RECORD_SIZE bytes
+            int numPositions;
+            int8_t value;         // final disc difference, negated in the positions whose record says so
+        };
+
+        FeatureDataset() = default;
+        ~FeatureDataset();
+
+        FeatureDataset(const FeatureDataset&) = delete;
+        FeatureDataset& operator=(const FeatureDataset&) = delete;
+
+        /**
+         * @brief memory-map a dataset file and index its games
+         * @param filepath: path of the dataset file
+         * @return whether the dataset was loaded
+         */
+        bool load(const std::string &filepath);
+
+        [[nodiscard]] inline uint64_t size() const {
+            return this->offsets.size();
+        }
+
+        [[nodiscard]] inline long get_num_phase_observations(int phase) const {
+            return this->numPhaseObservations[phase];
+        }
+
+        [[nodiscard]] inline Game get_game(uint64_t i) const {
+            auto game = this->data + this->offsets[i];
+            return {game + 2, (uint8_t)game[0], (int8_t)game[1]};
+        }
+
+        /**
+         * @brief read a position of a game
+         * @param record: the position's record
+         * @param indices: receives the NUM_FEATURES pattern indices, without the feature offsets
+         * @return whether the value is negated for this position
+         */
+        static inline bool read_record(const char *record, uint16_t *indices) {
+            std::memcpy(indices, record + 1, sizeof(uint16_t) * NUM_FEATURES);
+            return record[0] != 0;
+        }
+
+    private:
+        void unload();
+
+        void *mapping = nullptr;
+        size_t mappingSize = 0;
+        const char *data = nullptr;
+        std::vector<uint64_t> offsets;  // byte offset of each game
+        long numPhaseObservations[NUM_PHASES]{};
+    };
+}
+
+#endif //OTHELLO_FEATUREDATASET_H
@@ -0,0 +1,148 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "MoveDataset.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../Game/Board.h"
+
+namespace engine::eval {
+    constexpr char DATASET_MAGIC[4] = {'O', 'M', 'V', '1'};
+    constexpr uint32_t DATASET_VERSION = 1;
+
+    MoveDataset::~MoveDataset() {
+        this->unload();
+    }
+
+    void MoveDataset::unload() {
+        if (this->mapping != nullptr)
+            munmap(this->mapping, this->mappingSize);
+        this->mapping = nullptr;
+        this->mappingSize = 0;
+        this->offsets = nullptr;
+        this->values = nullptr;
+        this->moves = nullptr;
+        this->numGames = 0;
+        this->numMoves = 0;
+    }
+
+    bool MoveDataset::load(const std::string &filepath) {
+        this->unload();
+
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "could not open dataset " << filepath << std::endl;
+            return false;
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+            std::cerr << "invalid dataset " << filepath << std::endl;
+            close(fd);
+            return false;
+        }
+
+        auto size = (size_t)st.st_size;
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            std::cerr << "could not map dataset " << filepath << std::endl;
+            return false;
+        }
+
+        // games are read in runs of consecutive games when training
+        madvise(data, size, MADV_SEQUENTIAL);
+
+        auto header = (const Header *)data;
+        auto expectedSize = sizeof(Header) + (header->numGames + 1) * sizeof(uint64_t) + header->numGames +
+                            header->numMoves;
+        if (std::memcmp(header->magic, DATASET_MAGIC, 4) != 0 || header->version != DATASET_VERSION ||
+            size != expectedSize) {
+            std::cerr << "invalid dataset " << filepath << std::endl;
+            munmap(data, size);
+            return false;
+        }
+
+        this->mapping = data;
+        this->mappingSize = size;
+        this->numGames = header->numGames;
+        this->numMoves = header->numMoves;
+        this->offsets = (const uint64_t *)((const char *)data + sizeof(Header));
+        this->values = (const int8_t *)(this->offsets + this->numGames + 1);
+        this->moves = (const uint8_t *)(this->values + this->numGames);
+        return true;
+    }
+
+    bool MoveDataset::write(const std::string &filepath, const std::vector<std::string> &transcripts) {
+        std::vector<uint64_t> offsets = {0};
+        std::vector<int8_t> values;
+        std::vector<uint8_t> moves;
+        offsets.reserve(transcripts.size() + 1);
+        values.reserve(transcripts.size());
+        moves.reserve(transcripts.size() * 60);
+
+        int numSkipped = 0;
+        for (auto &transcript: transcripts) {
+            Board board;
+            bool isBlack = true;
+            auto start = moves.size();
+            bool isLegal = true;
+            for (size_t i = 0; i + 1 < transcript.size(); i += 2) {
+                if (board.get_legal_moves() == 0) {
+                    board.pass();
+                    isBlack = !isBlack;
+                }
+
+                auto x = (transcript[i] - 'a') + ((transcript[i + 1] - '1') << 3);
+                if (x < 0 || x >= 64 || !(board.get_legal_moves() & (1ULL << x))) {
+                    isLegal = false;
+                    break;
+                }
+                board.play_move(x);
+                isBlack = !isBlack;
+                moves.push_back((uint8_t)x);
+            }
+
+            if (!isLegal || moves.size() == start) {
+                moves.resize(start);
+                ++numSkipped;
+                continue;
+            }
+            offsets.push_back(moves.size());
+            values.push_back((int8_t)(isBlack ? board.get_disc_difference() : -board.get_disc_difference()));
+        }
+        if (numSkipped > 0)
+            std::cerr << "skipped " << numSkipped << " games with illegal moves" << std::endl;
+
+        // write a temporary file and rename it over the dataset, so a reader never sees a partial dataset
+        auto tmpFilepath = filepath + ".tmp";
+        std::ofstream out(tmpFilepath, std::ios::binary);
+        if (!out) {
+            std::cerr << "could not write dataset " << tmpFilepath << std::endl;
+            return false;
+        }
+        Header header{};
+        std::memcpy(header.magic, DATASET_MAGIC, 4);
+        header.version = DATASET_VERSION;
+        header.numGames = values.size();
+        header.numMoves = moves.size();
+        out.write((const char *)&header, sizeof(Header));
+        out.write((const char *)offsets.data(), (std::streamsize)(offsets.size() * sizeof(uint64_t)));
+        out.write((const char *)values.data(), (std::streamsize)values.size());
+        out.write((const char *)moves.data(), (std::streamsize)moves.size());
+        out.close();
+
+        if (!out || std::rename(tmpFilepath.c_str(), filepath.c_str()) != 0) {
+            std::cerr << "could not write dataset " << filepath << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,83 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_MOVEDATASET_H
+#define OTHELLO_MOVEDATASET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace engine::eval {
+
+    /**
+     * @brief read-only training set of whole games, memory-mapped from a file written by MoveDataset::write.
+     *
+     * A game is stored as its moves, one byte each with passes left out, and its final score, so it takes about 70
+     * bytes instead of the ~120 bytes per position of a feature dataset. The file is a header, an index of where each
+     * game's moves start, the scores and the moves, so any game can be read without scanning the ones before it.
+     * The positions and their features are recomputed by replaying the moves when the dataset is loaded.
+     */
+    class MoveDataset {
+    public:
+        struct Game {
+            const uint8_t *moves;  // squares played, passes left out
+            int numMoves;
+            int8_t value;          // final disc difference for black
+        };
+
+        MoveDataset() = default;
+        ~MoveDataset();
+
+        MoveDataset(const MoveDataset&) = delete;
+        MoveDataset& operator=(const MoveDataset&) = delete;
+
+        /**
+         * @brief memory-map a dataset file
+         * @param filepath: path of the dataset file
+         * @return whether the dataset was loaded
+         */
+        bool load(const std::string &filepath);
+
+        [[nodiscard]] inline uint64_t size() const {
+            return this->numGames;
+        }
+
+        [[nodiscard]] inline uint64_t get_num_moves() const {
+            return this->numMoves;
+        }
+
+        [[nodiscard]] inline Game get_game(uint64_t i) const {
+            return {this->moves + this->offsets[i], (int)(this->offsets[i + 1] - this->offsets[i]), this->values[i]};
+        }
+
+        /**
+         * @brief write a dataset file from transcripts. Games with illegal moves are left out.
+         * @param filepath: path of the dataset file
+         * @param transcripts: games as move sequences (f5d6c3...)
+         * @return whether the file was written
+         */
+        static bool write(const std::string &filepath, const std::vector<std::string> &transcripts);
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint64_t numGames;
+            uint64_t numMoves;
+        };
+
+    private:
+        void unload();
+
+        void *mapping = nullptr;
+        size_t mappingSize = 0;
+        const uint64_t *offsets = nullptr;  // numGames + 1 indices into moves
+        const int8_t *values = nullptr;
+        const uint8_t *moves = nullptr;
+        uint64_t numGames = 0;
+        uint64_t numMoves = 0;
+    };
+}
+
+#endif //OTHELLO_MOVEDATASET_H
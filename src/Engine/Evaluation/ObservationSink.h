@@ -0,0 +1,34 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_OBSERVATIONSINK_H
+#define OTHELLO_OBSERVATIONSINK_H
+
+#include <cstdint>
+#include <functional>
+
+namespace engine::eval {
+
+    /**
+     * @brief receives the training observations decoded from a dataset
+     */
+    class ObservationSink {
+    public:
+        virtual ~ObservationSink() = default;
+
+        /**
+         * @brief add an observation
+         * @param featureIndices: the NUM_FEATURES column indices of the position, sorted
+         * @param value: the label
+         */
+        virtual void add(const int *featureIndices, float value) = 0;
+    };
+
+    /**
+     * @brief decode one chunk of a dataset into a sink. Called from several threads at once
+     */
+    using ChunkDecoder = std::function<void(uint64_t chunk, ObservationSink &sink)>;
+}
+
+#endif //OTHELLO_OBSERVATIONSINK_H
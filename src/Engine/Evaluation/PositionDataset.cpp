@@ -0,0 +1,325 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "PositionDataset.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../Util.h"
+#include "../Book/OpeningBook.h"
+
+namespace engine::eval {
+    constexpr char DATASET_MAGIC[4] = {'O', 'U', 'P', '1'};
+    constexpr uint32_t DATASET_VERSION = 1;
+
+    // positions a thread collects for a bucket before appending them to the bucket's file
+    constexpr size_t BUCKET_BUFFER_SIZE = 1024;
+
+    struct Observation {
+        uint64_t P;
+        uint64_t O;
+        int32_t value;
+        uint32_t padding;
+    };
+
+    static inline uint64_t hash_position(uint64_t P, uint64_t O) {
+        uint64_t h = P * 0x9e3779b97f4a7c15ULL ^ (O + 0x632be59bd9b4e019ULL) * 0xc2b2ae3d27d4eb4fULL;
+        return h ^ (h >> 29);
+    }
+
+    PositionDataset::~PositionDataset() {
+        this->unload();
+    }
+
+    void PositionDataset::unload() {
+        if (this->mapping != nullptr)
+            munmap(this->mapping, this->mappingSize);
+        this->mapping = nullptr;
+        this->mappingSize = 0;
+        this->records = nullptr;
+        this->numPositions = 0;
+        std::fill(this->depthCounts, this->depthCounts + NUM_DEPTHS, 0);
+    }
+
+    bool PositionDataset::load(const std::string &filepath) {
+        this->unload();
+
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "could not open dataset " << filepath << std::endl;
+            return false;
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+            std::cerr << "invalid dataset " << filepath << std::endl;
+            close(fd);
+            return false;
+        }
+
+        auto size = (size_t)st.st_size;
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            std::cerr << "could not map dataset " << filepath << std::endl;
+            return false;
+        }
+
+        auto header = (const Header *)data;
+        if (std::memcmp(header->magic, DATASET_MAGIC, 4) != 0 || header->version != DATASET_VERSION ||
+            size != sizeof(Header) + header->numPositions * sizeof(Record)) {
+            std::cerr << "invalid dataset " << filepath << std::endl;
+            munmap(data, size);
+            return false;
+        }
+
+        this->mapping = data;
+        this->mappingSize = size;
+        this->numPositions = header->numPositions;
+        std::copy(header->depthCounts, header->depthCounts + NUM_DEPTHS, this->depthCounts);
+        this->records = (const Record *)((const char *)data + sizeof(Header));
+        return true;
+    }
+
+    bool PositionDataset::deduplicate(const MoveDataset &dataset, const std::string &filepath, bool augment,
+                                      int numThreads) {
+        numThreads = std::max(1, numThreads);
+
+        // enough buckets that each one fits in memory
+        const auto numBuckets = (int)std::clamp<uint64_t>(
+                dataset.get_num_moves() * sizeof(Observation) / DEDUP_BUCKET_SIZE + 1, 1, DEDUP_MAX_BUCKETS);
+        const auto bucketDirectory = filepath + ".buckets/";
+        auto getBucketPath = [&bucketDirectory](int b) {
+            return bucketDirectory + std::to_string(b) + ".bin";
+        };
+
+        std::error_code error;
+        std::filesystem::create_directories(bucketDirectory, error);
+        auto cleanUp = [&bucketDirectory]() {
+            std::error_code error;
+            std::filesystem::remove_all(bucketDirectory, error);
+        };
+
+        // scatter every position to the bucket of its canonical orientation
+        {
+            std::vector<std::ofstream> buckets(numBuckets);
+            std::vector<std::mutex> bucketLocks(numBuckets);
+            for (int b = 0; b < numBuckets; ++b) {
+                buckets[b].open(getBucketPath(b), std::ios::binary);
+                if (!buckets[b].is_open()) {
+                    std::cerr << "could not write " << getBucketPath(b) << std::endl;
+                    cleanUp();
+                    return false;
+                }
+            }
+
+            const auto numGames = dataset.size();
+            const auto numChunks = (numGames + TRAINING_CHUNK_SIZE - 1) / TRAINING_CHUNK_SIZE;
+            util::ProgressBar progressBar((int)numChunks, "Scattering positions ", util::FRACTION);
+            progressBar.print();
+
+            std::atomic<uint64_t> nextChunk = 0;
+            std::atomic<int> numComplete = 0;
+            std::atomic<bool> printLock = false;
+            std::vector<std::thread> threads;
+            threads.reserve(numThreads);
+
+            for (int t = 0; t < numThreads; ++t) {
+                threads.emplace_back([&]() {
+                    std::vector<std::vector<Observation>> buffers(numBuckets);
+                    auto flush = [&](int b) {
+                        if (buffers[b].empty())
+                            return;
+                        std::lock_guard<std::mutex> lock(bucketLocks[b]);
+                        buckets[b].write((const char *)buffers[b].data(),
+                                         (std::streamsize)(buffers[b].size() * sizeof(Observation)));
+                        buffers[b].clear();
+                    };
+
+                    for (auto chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+                        const auto lastGame = std::min(numGames, (chunk + 1) * TRAINING_CHUNK_SIZE);
+                        for (auto g = chunk * TRAINING_CHUNK_SIZE; g < lastGame; ++g) {
+                            auto game = dataset.get_game(g);
+
+                            // replay the game, scoring each position for the side to move
+                            Board board;
+                            bool isBlack = true;
+                            auto numMoves = std::min(game.numMoves, NUM_DEPTHS);
+                            for (int i = 0; i < numMoves; ++i) {
+                                if (board.get_legal_moves() == 0) {
+                                    board.pass();
+                                    isBlack = !isBlack;
+                                }
+                                board.play_move(game.moves[i]);
+                                isBlack = !isBlack;
+
+                                int symmetry;
+                                auto canonical = OpeningBook::canonicalize(board, &symmetry);
+                                auto b = (int)(hash_position(canonical.P, canonical.O) % numBuckets);
+                                buffers[b].push_back({canonical.P, canonical.O, isBlack ? game.value : -game.value, 0});
+                                if (buffers[b].size() >= BUCKET_BUFFER_SIZE)
+                                    flush(b);
+                            }
+                        }
+
+                        // print progress
+                        ++numComplete;
+                        if (!printLock) {
+                            printLock = true;
+                            progressBar.update(numComplete);
+                            printLock = false;
+                        }
+                    }
+                    for (int b = 0; b < numBuckets; ++b)
+                        flush(b);
+                });
+            }
+            for (auto &thread: threads)
+                thread.join();
+
+            for (auto &bucket: buckets) {
+                bucket.close();
+                if (bucket.fail()) {
+                    std::cerr << "could not write the buckets in " << bucketDirectory << std::endl;
+                    cleanUp();
+                    return false;
+                }
+            }
+        }
+
+        // merge the copies of each position, one bucket per thread at a time
+        const auto tmpFilepath = filepath + ".tmp";
+        std::ofstream out(tmpFilepath, std::ios::binary);
+        if (!out.is_open()) {
+            std::cerr << "could not write dataset " << tmpFilepath << std::endl;
+            cleanUp();
+            return false;
+        }
+        Header header{};
+        std::memcpy(header.magic, DATASET_MAGIC, 4);
+        header.version = DATASET_VERSION;
+        out.write((const char *)&header, sizeof(Header));
+
+        util::ProgressBar progressBar(numBuckets, "Merging duplicates ", util::FRACTION);
+        progressBar.print();
+
+        std::atomic<int> nextBucket = 0;
+        std::atomic<int> numComplete = 0;
+        std::atomic<bool> printLock = false;
+        std::atomic<bool> isFailed = false;
+        std::mutex outLock;
+        uint64_t numUnique = 0;
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads);
+
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&]() {
+                std::vector<Observation> observations;
+                std::vector<Record> records;
+                for (auto b = nextBucket++; b < numBuckets; b = nextBucket++) {
+                    const auto bucketPath = getBucketPath(b);
+                    std::error_code sizeError;
+                    auto bucketSize = std::filesystem::file_size(bucketPath, sizeError);
+                    std::ifstream bucket(bucketPath, std::ios::binary);
+                    if (sizeError || !bucket.is_open()) {
+                        isFailed = true;
+                        continue;
+                    }
+                    observations.resize(bucketSize / sizeof(Observation));
+                    bucket.read((char *)observations.data(),
+                                (std::streamsize)(observations.size() * sizeof(Observation)));
+                    bucket.close();
+                    std::remove(bucketPath.c_str());
+
+                    std::sort(observations.begin(), observations.end(),
+                              [](const Observation &a, const Observation &b) {
+                                  return a.P < b.P || (a.P == b.P && a.O < b.O);
+                              });
+
+                    records.clear();
+                    uint64_t numBucketUnique = 0;
+                    for (size_t i = 0; i < observations.size();) {
+                        const auto &first = observations[i];
+                        uint32_t count = 0;
+                        int64_t sum = 0;
+                        for (; i < observations.size() && observations[i].P == first.P && observations[i].O == first.O;
+                               ++i) {
+                            ++count;
+                            sum += observations[i].value;
+                        }
+                        ++numBucketUnique;
+                        const auto value = (float)((double)sum / count);
+
+                        if (!augment) {
+                            records.push_back({first.P, first.O, count, value});
+                            continue;
+                        }
+
+                        // the other orientations of a symmetric position are the same position
+                        const auto firstVariant = records.size();
+                        for (int s = 0; s < 8; ++s) {
+                            Record variant{OpeningBook::transform(first.P, s), OpeningBook::transform(first.O, s),
+                                           count, value};
+                            bool isNew = std::none_of(records.begin() + (long)firstVariant, records.end(),
+                                                      [&variant](const Record &r) {
+                                                          return r.P == variant.P && r.O == variant.O;
+                                                      });
+                            if (isNew)
+                                records.push_back(variant);
+                        }
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(outLock);
+                        out.write((const char *)records.data(), (std::streamsize)(records.size() * sizeof(Record)));
+                        for (auto &record: records)
+                            ++header.depthCounts[std::clamp(std::popcount(record.P | record.O) - 5, 0, NUM_DEPTHS - 1)];
+                        header.numPositions += records.size();
+                        numUnique += numBucketUnique;
+                    }
+
+                    // print progress
+                    ++numComplete;
+                    if (!printLock) {
+                        printLock = true;
+                        progressBar.update(numComplete);
+                        printLock = false;
+                    }
+                }
+            });
+        }
+        for (auto &thread: threads)
+            thread.join();
+        cleanUp();
+
+        out.seekp(0, std::ios::beg);
+        out.write((const char *)&header, sizeof(Header));
+        out.close();
+
+        // rename the finished file over the dataset, so a reader never sees a partial dataset
+        if (isFailed || out.fail() || std::rename(tmpFilepath.c_str(), filepath.c_str()) != 0) {
+            std::cerr << "could not write dataset " << filepath << std::endl;
+            std::remove(tmpFilepath.c_str());
+            return false;
+        }
+
+        std::cout << "deduplicated " << dataset.get_num_moves() << " positions to " << numUnique << " unique positions";
+        if (augment)
+            std::cout << ", " << header.numPositions << " with their symmetries";
+        std::cout << std::endl;
+        return true;
+    }
+}
@@ -0,0 +1,93 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_POSITIONDATASET_H
+#define OTHELLO_POSITIONDATASET_H
+
+#include <cstdint>
+#include <string>
+#include "MoveDataset.h"
+
+namespace engine::eval {
+
+    /**
+     * @brief read-only training set of unique positions, memory-mapped from a file written by
+     * PositionDataset::deduplicate.
+     *
+     * Every position of a move dataset is oriented canonically (the smallest of its 8 symmetries), so a position and
+     * its rotations and reflections are one entry, labelled with the mean final score of every game it was played in.
+     * Openings played thousands of times then cost one observation instead of thousands, and don't outweigh the rest
+     * of the fit.
+     */
+    class PositionDataset {
+    public:
+        static constexpr int NUM_DEPTHS = 60;  // positions at depth d have d + 5 discs
+
+        struct Record {
+            uint64_t P;      // side to move
+            uint64_t O;
+            uint32_t count;  // number of times the position was played
+            float value;     // mean final disc difference for the side to move
+        };
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint64_t numPositions;
+            uint64_t depthCounts[NUM_DEPTHS];
+        };
+
+        PositionDataset() = default;
+        ~PositionDataset();
+
+        PositionDataset(const PositionDataset&) = delete;
+        PositionDataset& operator=(const PositionDataset&) = delete;
+
+        /**
+         * @brief memory-map a dataset file
+         * @param filepath: path of the dataset file
+         * @return whether the dataset was loaded
+         */
+        bool load(const std::string &filepath);
+
+        [[nodiscard]] inline uint64_t size() const {
+            return this->numPositions;
+        }
+
+        [[nodiscard]] inline const Record &operator[](uint64_t i) const {
+            return this->records[i];
+        }
+
+        /**
+         * @return number of positions at a depth
+         */
+        [[nodiscard]] inline uint64_t get_depth_count(int depth) const {
+            return this->depthCounts[depth];
+        }
+
+        /**
+         * @brief write the unique positions of a move dataset, in two streaming passes. The positions are first
+         * scattered to bucket files on disk by the hash of their canonical orientation, so every copy of a position
+         * lands in the same bucket. Each bucket is then small enough to be sorted in memory, where its duplicates are
+         * merged. Only numThreads buckets are in memory at once, however large the dataset is.
+         * @param dataset: the games
+         * @param filepath: path of the dataset file. The buckets are written to a directory next to it
+         * @param augment: also write the other distinct symmetries of each position, with the same label
+         * @param numThreads: number of threads
+         * @return whether the file was written
+         */
+        static bool deduplicate(const MoveDataset &dataset, const std::string &filepath, bool augment, int numThreads);
+
+    private:
+        void unload();
+
+        void *mapping = nullptr;
+        size_t mappingSize = 0;
+        const Record *records = nullptr;
+        uint64_t numPositions = 0;
+        uint64_t depthCounts[NUM_DEPTHS]{};
+    };
+}
+
+#endif //OTHELLO_POSITIONDATASET_H
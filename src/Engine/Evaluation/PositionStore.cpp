@@ -0,0 +1,171 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "PositionStore.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace engine::eval {
+    constexpr char STORE_MAGIC[4] = {'O', 'P', 'S', '1'};
+    constexpr uint32_t STORE_VERSION = 1;
+
+    bool PositionStore::get_source_stamp(const std::string &sourcePath, uint64_t &size, int64_t &time) {
+        struct stat st{};
+        if (stat(sourcePath.c_str(), &st) != 0)
+            return false;
+        size = (uint64_t)st.st_size;
+        time = (int64_t)st.st_mtime;
+        return true;
+    }
+
+    PositionStore::Builder::Builder(std::string filepath, const std::array<uint64_t, NUM_DEPTHS> &depthCounts,
+                                    const std::string &sourcePath) :
+            filepath(std::move(filepath)) {
+        this->tmpFilepath = this->filepath + ".tmp";
+        for (int d = 0; d < NUM_DEPTHS; ++d) {
+            this->depthStarts[d + 1] = this->depthStarts[d] + depthCounts[d];
+            this->cursors[d] = this->depthStarts[d];
+        }
+
+        Header header{};
+        std::memcpy(header.magic, STORE_MAGIC, 4);
+        header.version = STORE_VERSION;
+        header.numFeatures = NUM_FEATURES;
+        header.recordSize = sizeof(Record);
+        std::copy(this->depthStarts.begin(), this->depthStarts.end(), header.depthStarts);
+        if (!get_source_stamp(sourcePath, header.sourceSize, header.sourceTime)) {
+            std::cerr << "could not stat dataset " << sourcePath << std::endl;
+            return;
+        }
+
+        int fd = open(this->tmpFilepath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "could not write position store " << this->tmpFilepath << std::endl;
+            return;
+        }
+
+        // the records are written straight into the file's pages, so building never holds the store in memory
+        auto size = sizeof(Header) + this->depthStarts[NUM_DEPTHS] * sizeof(Record);
+        void *data = MAP_FAILED;
+        if (ftruncate(fd, (off_t)size) == 0)
+            data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            std::cerr << "could not map position store " << this->tmpFilepath << std::endl;
+            std::remove(this->tmpFilepath.c_str());
+            return;
+        }
+
+        std::memcpy(data, &header, sizeof(Header));
+        this->mapping = data;
+        this->mappingSize = size;
+        this->records = (Record *)((char *)data + sizeof(Header));
+    }
+
+    PositionStore::Builder::~Builder() {
+        if (this->is_open()) {
+            this->close();
+            std::remove(this->tmpFilepath.c_str());
+        }
+    }
+
+    void PositionStore::Builder::close() {
+        if (this->mapping != nullptr)
+            munmap(this->mapping, this->mappingSize);
+        this->mapping = nullptr;
+        this->mappingSize = 0;
+        this->records = nullptr;
+    }
+
+    void PositionStore::Builder::add(int depth, const uint16_t *indices, int value) {
+        auto i = this->cursors[depth].fetch_add(1, std::memory_order_relaxed);
+        if (i >= this->depthStarts[depth + 1])
+            return;  // more positions than counted. commit() fails
+        auto &record = this->records[i];
+        std::memcpy(record.indices, indices, sizeof(record.indices));
+        record.value = (int16_t)value;
+    }
+
+    bool PositionStore::Builder::commit() {
+        if (!this->is_open())
+            return false;
+
+        for (int d = 0; d < NUM_DEPTHS; ++d) {
+            if (this->cursors[d] != this->depthStarts[d + 1]) {
+                std::cerr << "position store " << this->filepath << " got the wrong number of positions at depth "
+                          << d << std::endl;
+                this->close();
+                std::remove(this->tmpFilepath.c_str());
+                return false;
+            }
+        }
+
+        // rename the finished file over the store, so a reader never sees a partial store
+        bool isSynced = msync(this->mapping, this->mappingSize, MS_SYNC) == 0;
+        this->close();
+        if (!isSynced || std::rename(this->tmpFilepath.c_str(), this->filepath.c_str()) != 0) {
+            std::cerr << "could not write position store " << this->filepath << std::endl;
+            std::remove(this->tmpFilepath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    PositionStore::~PositionStore() {
+        this->unload();
+    }
+
+    void PositionStore::unload() {
+        if (this->mapping != nullptr)
+            munmap(this->mapping, this->mappingSize);
+        this->mapping = nullptr;
+        this->mappingSize = 0;
+        this->records = nullptr;
+        this->depthStarts.fill(0);
+    }
+
+    bool PositionStore::load(const std::string &filepath, const std::string &sourcePath) {
+        this->unload();
+
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+            close(fd);
+            return false;
+        }
+
+        auto size = (size_t)st.st_size;
+        void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        Header header{};
+        std::memcpy(&header, data, sizeof(Header));
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        if (std::memcmp(header.magic, STORE_MAGIC, 4) != 0 || header.version != STORE_VERSION ||
+            header.numFeatures != NUM_FEATURES || header.recordSize != sizeof(Record) ||
+            size != sizeof(Header) + header.depthStarts[NUM_DEPTHS] * sizeof(Record) ||
+            !get_source_stamp(sourcePath, sourceSize, sourceTime) ||
+            header.sourceSize != sourceSize || header.sourceTime != sourceTime) {
+            munmap(data, size);
+            return false;
+        }
+
+        this->mapping = data;
+        this->mappingSize = size;
+        this->records = (const Record *)((const char *)data + sizeof(Header));
+        std::copy(header.depthStarts, header.depthStarts + NUM_DEPTHS + 1, this->depthStarts.begin());
+        return true;
+    }
+}
@@ -0,0 +1,135 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_POSITIONSTORE_H
+#define OTHELLO_POSITIONSTORE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "Evaluation.h"
+
+namespace engine::eval {
+
+    /**
+     * @brief read-only store of every decoded training position of a dataset, memory-mapped from a cache file.
+     *
+     * Each position is stored once as its feature indices and label, and the positions are grouped by their number
+     * of discs. The positions of any range of disc counts, like the window of a phase, are then one contiguous run of
+     * records, which all the phase trainers read from the same mapping without copying or decoding the dataset again.
+     *
+     * The store remembers the size and modification time of the dataset it was built from, so a store of an older
+     * version of the dataset isn't loaded.
+     */
+    class PositionStore {
+    public:
+        static constexpr int NUM_DEPTHS = 60;  // positions at depth d have d + 5 discs
+
+        struct Record {
+            uint16_t indices[NUM_FEATURES];  // without the feature offsets
+            int16_t value;                   // final disc difference for the side to move
+        };
+
+        /**
+         * @brief writes a store file. The number of positions at each depth must be known up front, and then the
+         * positions can be added from any number of threads in any order.
+         */
+        class Builder {
+        public:
+            /**
+             * @param filepath: path of the store file. It's written under a temporary name until commit()
+             * @param depthCounts: number of positions at each depth
+             * @param sourcePath: the dataset the store is built from
+             */
+            Builder(std::string filepath, const std::array<uint64_t, NUM_DEPTHS> &depthCounts,
+                    const std::string &sourcePath);
+            ~Builder();
+
+            Builder(const Builder&) = delete;
+            Builder& operator=(const Builder&) = delete;
+
+            [[nodiscard]] inline bool is_open() const {
+                return this->records != nullptr;
+            }
+
+            /**
+             * @brief add a position. Safe to call from any thread.
+             * @param depth: the position's depth
+             * @param indices: NUM_FEATURES feature indices, without the feature offsets
+             * @param value: label of the position
+             */
+            void add(int depth, const uint16_t *indices, int value);
+
+            /**
+             * @brief finish the file and move it to its path
+             * @return whether every position was added and the file was written
+             */
+            bool commit();
+
+        private:
+            void close();
+
+            std::string filepath;
+            std::string tmpFilepath;
+            void *mapping = nullptr;
+            size_t mappingSize = 0;
+            Record *records = nullptr;
+            std::array<uint64_t, NUM_DEPTHS + 1> depthStarts{};
+            std::array<std::atomic<uint64_t>, NUM_DEPTHS> cursors{};
+        };
+
+        PositionStore() = default;
+        ~PositionStore();
+
+        PositionStore(const PositionStore&) = delete;
+        PositionStore& operator=(const PositionStore&) = delete;
+
+        /**
+         * @brief memory-map a store file
+         * @param filepath: path of the store file
+         * @param sourcePath: the dataset the store must have been built from
+         * @return whether the store was loaded and is up to date with the dataset
+         */
+        bool load(const std::string &filepath, const std::string &sourcePath);
+
+        [[nodiscard]] inline uint64_t size() const {
+            return this->depthStarts[NUM_DEPTHS];
+        }
+
+        /**
+         * @return index of the first record at a depth. The records at depths [a, b) are [get_depth_start(a),
+         * get_depth_start(b))
+         */
+        [[nodiscard]] inline uint64_t get_depth_start(int depth) const {
+            return this->depthStarts[std::clamp(depth, 0, NUM_DEPTHS)];
+        }
+
+        [[nodiscard]] inline const Record &operator[](uint64_t i) const {
+            return this->records[i];
+        }
+
+    private:
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint32_t numFeatures;
+            uint32_t recordSize;
+            uint64_t sourceSize;
+            int64_t sourceTime;
+            uint64_t depthStarts[NUM_DEPTHS + 1];
+        };
+
+        static bool get_source_stamp(const std::string &sourcePath, uint64_t &size, int64_t &time);
+        void unload();
+
+        void *mapping = nullptr;
+        size_t mappingSize = 0;
+        const Record *records = nullptr;
+        std::array<uint64_t, NUM_DEPTHS + 1> depthStarts{};
+    };
+}
+
+#endif //OTHELLO_POSITIONSTORE_H
@@ -0,0 +1,193 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "SparseTrainer.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include "Evaluation.h"
+
+namespace engine::eval {
+
+    /**
+     * @brief collects one thread's observations into mini-batches and trains on each one when it's full
+     */
+    class SparseTrainer::Worker : public ObservationSink {
+    public:
+        explicit Worker(SparseTrainer &trainer) :
+                trainer(trainer),
+                gradient(trainer.numParams, 0.0f),
+                isTouched(trainer.numParams, false) {
+            this->columns.reserve((size_t)trainer.batchSize * NUM_FEATURES);
+            this->counts.reserve((size_t)trainer.batchSize * NUM_FEATURES);
+            this->rowEnds.reserve(trainer.batchSize);
+            this->labels.reserve(trainer.batchSize);
+        }
+
+        void add(const int *featureIndices, float value) override {
+            // one entry per distinct feature, counting repeats
+            int occurences = 1;
+            for (int i = 0; i < NUM_FEATURES; ++i) {
+                if (i + 1 < NUM_FEATURES && featureIndices[i] == featureIndices[i + 1]) {
+                    ++occurences;
+                } else {
+                    this->columns.push_back(featureIndices[i]);
+                    this->counts.push_back((float)occurences);
+                    occurences = 1;
+                }
+            }
+            this->rowEnds.push_back((int)this->columns.size());
+            this->labels.push_back(value);
+
+            if ((int)this->labels.size() >= this->trainer.batchSize)
+                this->flush();
+        }
+
+        /**
+         * @brief train on the observations added since the last update
+         */
+        void flush() {
+            const auto numRows = (int)this->labels.size();
+            if (numRows == 0)
+                return;
+
+            const float *weights = this->trainer.weights;
+            const float scale = 2.0f / (float)numRows;
+            int start = 0;
+            for (int row = 0; row < numRows; ++row) {
+                const int end = this->rowEnds[row];
+
+                float prediction = 0;
+                for (int i = start; i < end; ++i)
+                    prediction += weights[this->columns[i]] * this->counts[i];
+                const float error = prediction - this->labels[row];
+                this->sumSquaredError += (double)error * error;
+
+                // d/dw (prediction - label)^2, averaged over the mini-batch
+                const float g = error * scale;
+                for (int i = start; i < end; ++i) {
+                    const int col = this->columns[i];
+                    if (!this->isTouched[col]) {
+                        this->isTouched[col] = true;
+                        this->touched.push_back(col);
+                    }
+                    this->gradient[col] += g * this->counts[i];
+                }
+                start = end;
+            }
+            this->numObservations += numRows;
+
+            this->trainer.apply(this->gradient.data(), this->touched);
+
+            // clear only what the mini-batch used
+            for (int col: this->touched) {
+                this->gradient[col] = 0;
+                this->isTouched[col] = false;
+            }
+            this->touched.clear();
+            this->columns.clear();
+            this->counts.clear();
+            this->rowEnds.clear();
+            this->labels.clear();
+        }
+
+        double sumSquaredError = 0;
+        int64_t numObservations = 0;
+
+    private:
+        SparseTrainer &trainer;
+
+        // the mini-batch, as a sparse row-major matrix
+        std::vector<int> columns;
+        std::vector<float> counts;
+        std::vector<int> rowEnds;
+        std::vector<float> labels;
+
+        std::vector<float> gradient;
+        std::vector<bool> isTouched;
+        std::vector<int> touched;
+    };
+
+    SparseTrainer::SparseTrainer(float *weights, int numParams, Optimizer optimizer, float learningRate,
+                                 int batchSize, int numThreads) :
+            weights(weights),
+            numParams(numParams),
+            optimizer(optimizer),
+            learningRate(learningRate),
+            batchSize(std::max(1, batchSize)),
+            numThreads(std::max(1, numThreads)) {
+        if (optimizer == Optimizer::ADAM) {
+            this->m.assign(numParams, 0.0f);
+            this->v.assign(numParams, 0.0f);
+        }
+    }
+
+    void SparseTrainer::apply(const float *gradient, const std::vector<int> &touched) {
+        // the weights are shared by every thread without a lock. Concurrent mini-batches rarely touch the same
+        // weights, and when they do, losing one of the updates doesn't stop the weights from converging.
+        if (this->optimizer == Optimizer::SGD) {
+            for (int i: touched)
+                this->weights[i] -= this->learningRate * gradient[i];
+            return;
+        }
+
+        // lazy Adam: the moments of weights that aren't in the mini-batch aren't decayed
+        const auto t = (double)(this->numSteps.fetch_add(1, std::memory_order_relaxed) + 1);
+        const auto correction1 = (float)(1.0 - std::pow((double)ADAM_BETA1, t));
+        const auto correction2 = (float)(1.0 - std::pow((double)ADAM_BETA2, t));
+        const auto stepSize = this->learningRate / correction1;
+        const auto rootCorrection2 = std::sqrt(correction2);
+
+        for (int i: touched) {
+            const float g = gradient[i];
+            this->m[i] = ADAM_BETA1 * this->m[i] + (1 - ADAM_BETA1) * g;
+            this->v[i] = ADAM_BETA2 * this->v[i] + (1 - ADAM_BETA2) * g * g;
+            this->weights[i] -= stepSize * this->m[i] / (std::sqrt(this->v[i]) / rootCorrection2 + ADAM_EPSILON);
+        }
+    }
+
+    double SparseTrainer::train_epoch(const ChunkDecoder &decoder, uint64_t numChunks, std::mt19937 &rng,
+                                      util::ProgressBar *progressBar) {
+        std::vector<uint64_t> order(numChunks);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        std::atomic<uint64_t> nextChunk = 0;
+        std::atomic<int> numComplete = 0;
+        std::atomic<bool> printLock = false;
+        std::mutex mtx;
+        double sumSquaredError = 0;
+        int64_t numObservations = 0;
+
+        std::vector<std::thread> threads;
+        threads.reserve(this->numThreads);
+        for (int t = 0; t < this->numThreads; ++t) {
+            threads.emplace_back([&]() {
+                Worker worker(*this);
+                for (auto i = nextChunk++; i < numChunks; i = nextChunk++) {
+                    decoder(order[i], worker);
+
+                    // print progress
+                    ++numComplete;
+                    if (progressBar != nullptr && !printLock) {
+                        printLock = true;
+                        progressBar->update(numComplete);
+                        printLock = false;
+                    }
+                }
+                worker.flush();
+
+                std::lock_guard<std::mutex> lock(mtx);
+                sumSquaredError += worker.sumSquaredError;
+                numObservations += worker.numObservations;
+            });
+        }
+        for (auto &thread: threads)
+            thread.join();
+
+        return numObservations > 0 ? sumSquaredError / (double)numObservations : 0;
+    }
+}
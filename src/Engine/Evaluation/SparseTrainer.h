@@ -0,0 +1,85 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_SPARSETRAINER_H
+#define OTHELLO_SPARSETRAINER_H
+
+#include <atomic>
+#include <random>
+#include <vector>
+#include "ObservationSink.h"
+#include "../../Util.h"
+
+namespace engine::eval {
+
+    /**
+     * @brief trains the weights of one phase of the pattern evaluation without libtorch.
+     *
+     * The model is the sum of the weights of a position's feature indices, fit to the final disc difference by
+     * minimizing the squared error. Each thread decodes its own chunks of the dataset into small mini-batches and
+     * updates the shared weights without locking (Hogwild). Only the weights of the features a mini-batch contains
+     * are read and written, and with Adam their moments are updated lazily, so a step costs about as much as the
+     * mini-batch has entries, however many parameters there are.
+     *
+     * Symmetric patterns share weights because the features are already the smaller of a pattern index and its
+     * mirror. EvalBuilder::post_process copies them to the mirrored indices afterwards, like it does for the
+     * libtorch trainer.
+     */
+    class SparseTrainer {
+    public:
+        enum class Optimizer {
+            SGD,
+            ADAM
+        };
+
+        /**
+         * @param weights: the weights of the phase, trained in place. They start at their current values
+         * @param numParams: number of weights
+         * @param optimizer: update rule
+         * @param learningRate: step size
+         * @param batchSize: number of observations per update
+         * @param numThreads: number of threads decoding and updating at once
+         */
+        SparseTrainer(float *weights, int numParams, Optimizer optimizer, float learningRate, int batchSize,
+                      int numThreads);
+
+        /**
+         * @brief train on every observation of the dataset once, in a random order of chunks
+         * @param decoder: decodes the observations of a chunk
+         * @param numChunks: number of chunks in the dataset
+         * @param rng: shuffles the chunks
+         * @param progressBar: counts the chunks done, if given
+         * @return mean squared error of the epoch, measured before each update
+         */
+        double train_epoch(const ChunkDecoder &decoder, uint64_t numChunks, std::mt19937 &rng,
+                           util::ProgressBar *progressBar = nullptr);
+
+    private:
+        class Worker;
+
+        /**
+         * @brief apply a mini-batch gradient to the weights
+         * @param gradient: dense gradient, nonzero only at touched
+         * @param touched: the parameters of the mini-batch
+         */
+        void apply(const float *gradient, const std::vector<int> &touched);
+
+        static constexpr float ADAM_BETA1 = 0.9f;
+        static constexpr float ADAM_BETA2 = 0.999f;
+        static constexpr float ADAM_EPSILON = 1e-8f;
+
+        float *weights;
+        int numParams;
+        Optimizer optimizer;
+        float learningRate;
+        int batchSize;
+        int numThreads;
+
+        std::vector<float> m;  // Adam moments
+        std::vector<float> v;
+        std::atomic<int64_t> numSteps = 0;
+    };
+}
+
+#endif //OTHELLO_SPARSETRAINER_H
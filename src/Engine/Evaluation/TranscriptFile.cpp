@@ -0,0 +1,87 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "TranscriptFile.h"
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace engine::eval {
+
+    TranscriptFile::~TranscriptFile() {
+        this->unload();
+    }
+
+    void TranscriptFile::unload() {
+        if (this->mapping != nullptr)
+            munmap(this->mapping, this->mappingSize);
+        this->mapping = nullptr;
+        this->mappingSize = 0;
+        this->games.clear();
+        this->fileSize = 0;
+        this->fileTime = 0;
+    }
+
+    bool TranscriptFile::load(const std::string &filepath) {
+        this->unload();
+
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "could not open transcripts " << filepath << std::endl;
+            return false;
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            std::cerr << "could not open transcripts " << filepath << std::endl;
+            close(fd);
+            return false;
+        }
+        this->fileSize = (uint64_t)st.st_size;
+        this->fileTime = (int64_t)st.st_mtime;
+
+        // an empty file has no games, and can't be mapped
+        if (st.st_size == 0) {
+            close(fd);
+            return true;
+        }
+
+        auto size = (size_t)st.st_size;
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            std::cerr << "could not map transcripts " << filepath << std::endl;
+            return false;
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+
+        this->mapping = data;
+        this->mappingSize = size;
+
+        // about 121 bytes per 60-move game
+        this->games.reserve(size / 120 + 1);
+
+        const char *begin = (const char *)data;
+        const char *end = begin + size;
+        while (begin < end) {
+            auto newline = (const char *)std::memchr(begin, '\n', end - begin);
+            const char *lineEnd = newline != nullptr ? newline : end;
+
+            std::string_view line(begin, lineEnd - begin);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+
+            // games start with a column letter. Anything else is a blank line or an old line count
+            if (!line.empty() && std::isalpha((unsigned char)line.front()))
+                this->games.push_back(line);
+
+            begin = lineEnd + 1;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,70 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_TRANSCRIPTFILE_H
+#define OTHELLO_TRANSCRIPTFILE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine::eval {
+
+    /**
+     * @brief read-only view of the games in a transcript file, one game (f5d6c3...) per line, memory-mapped.
+     *
+     * The file is split on newlines once when it's loaded, and each game is a view into the mapping, so games can be
+     * parsed from any number of threads without copying them out of the file. Blank lines and the line count that
+     * transcript files used to start with are skipped.
+     */
+    class TranscriptFile {
+    public:
+        TranscriptFile() = default;
+        ~TranscriptFile();
+
+        TranscriptFile(const TranscriptFile&) = delete;
+        TranscriptFile& operator=(const TranscriptFile&) = delete;
+
+        /**
+         * @brief memory-map a transcript file and find its games
+         * @param filepath: path of the transcript file
+         * @return whether the file was loaded
+         */
+        bool load(const std::string &filepath);
+
+        [[nodiscard]] inline uint64_t size() const {
+            return this->games.size();
+        }
+
+        [[nodiscard]] inline std::string_view operator[](uint64_t i) const {
+            return this->games[i];
+        }
+
+        /**
+         * @return size of the file in bytes when it was loaded
+         */
+        [[nodiscard]] inline uint64_t get_file_size() const {
+            return this->fileSize;
+        }
+
+        /**
+         * @return modification time of the file when it was loaded
+         */
+        [[nodiscard]] inline int64_t get_file_time() const {
+            return this->fileTime;
+        }
+
+    private:
+        void unload();
+
+        void *mapping = nullptr;
+        size_t mappingSize = 0;
+        std::vector<std::string_view> games;
+        uint64_t fileSize = 0;
+        int64_t fileTime = 0;
+    };
+}
+
+#endif //OTHELLO_TRANSCRIPTFILE_H
@@ -0,0 +1,128 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "../Engine.h"
+#include <algorithm>
+
+namespace engine {
+    std::vector<AnalysisLine> Engine::analyze(const Game &game, int numPV, SearchLimits &limits, const AnalysisCallback &callback) {
+        return dispatch_search_policy(this->searchOptions, [&]<typename Policy>() {
+            return this->analyze<Policy>(game, numPV, limits, callback);
+        });
+    }
+
+    template<typename Policy>
+    std::vector<AnalysisLine> Engine::analyze(const Game &game, int numPV, SearchLimits &limits, const AnalysisCallback &callback) {
+        SearchNode node(game.get_bitboard());
+        node.evalFeatures.set_weights(this->evaluationWeights.get());
+        auto legalMask = node.board.get_legal_moves();
+        if (legalMask == 0)
+            return {};
+
+        // order the first iteration with the usual move ordering
+        std::vector<MoveEval> moveList;
+        for (auto mask = bit::lsb(legalMask); legalMask; mask = bit::next_set_bit(legalMask)) {
+            auto x = bit::bitboard_to_coord(mask);
+            moveList.emplace_back(Move(x, node.board.get_flipped(x)), SCORE_UNDEFINED, LEGAL_UNDEFINED);
+        }
+        this->evaluate_move_list<Policy>(&node, 1, LOSS, WIN, moveList, &limits);
+        std::stable_sort(moveList.begin(), moveList.end(), [](const MoveEval &a, const MoveEval &b) {
+            return a.value > b.value;
+        });
+
+        std::vector<AnalysisLine> lines(moveList.size());
+        for (size_t i = 0; i < moveList.size(); ++i)
+            lines[i].move = moveList[i].move;
+
+        const int numLines = (int)lines.size();
+        numPV = std::clamp(numPV, 1, numLines);
+        auto numEmpty = 64 - node.discCount;
+        auto maxDepth = std::min(limits.get_depth_limit(), numEmpty);
+        std::vector<AnalysisLine> result;
+
+        node.start();
+        for (int depth = 1; !limits.check_now(node.numNodes) && depth <= maxDepth; ++depth) {
+            node.selectivity = Engine::get_iteration_selectivity(numEmpty, depth);
+            bool isEndSearch = depth == numEmpty;
+            bool completed = true;
+
+            for (int i = 0; i < numLines; ++i) {
+                auto &line = lines[i];
+                int value;
+                bool isExact = true;
+
+                node.play_move(line.move);
+                if (i < numPV) {
+                    value = -pv_search<Policy>(&node, depth - 1, LOSS, WIN, false, LEGAL_UNDEFINED, isEndSearch, &limits);
+                } else {
+                    // only moves that beat the worst of the best numPV moves need an exact score
+                    int bound = lines[numPV - 1].value;
+                    value = -null_window_search<Policy>(&node, depth - 1, -bound - 1, false, LEGAL_UNDEFINED, isEndSearch, &limits);
+                    if (value > bound && !limits.is_stopped())
+                        value = -pv_search<Policy>(&node, depth - 1, LOSS, WIN, false, LEGAL_UNDEFINED, isEndSearch, &limits);
+                    else
+                        isExact = false;
+                }
+                node.undo_move(line.move);
+
+                if (limits.is_stopped()) {
+                    completed = false;
+                    break;
+                }
+
+                line.value = std::clamp(value, -SCORE_MAX, SCORE_MAX);
+                line.depth = depth;
+                line.isExact = isExact;
+
+                // keep exact scores ranked at the front, so lines[numPV - 1] is always the bound to beat
+                for (int j = i; j > 0 && isExact &&
+                                (!lines[j - 1].isExact || lines[j - 1].value < lines[j].value); --j)
+                    std::swap(lines[j - 1], lines[j]);
+            }
+
+            if (!completed)
+                break;
+
+            std::stable_sort(lines.begin(), lines.end(), [](const AnalysisLine &a, const AnalysisLine &b) {
+                if (a.isExact != b.isExact)
+                    return a.isExact;
+                return a.value > b.value;
+            });
+            for (auto &line: lines) {
+                line.pv = {line.move};
+                auto pv = this->get_pv_line(node.board.move_and_copy(line.move), depth - 1);
+                line.pv.insert(line.pv.end(), pv.begin(), pv.end());
+            }
+
+            result = lines;
+            if (callback)
+                callback(result);
+        }
+        node.stop();
+        return result;
+    }
+
+    std::vector<Move> Engine::get_pv_line(Board board, int maxLength) {
+        std::vector<Move> pv;
+        while ((int)pv.size() < maxLength) {
+            auto legalMask = board.get_legal_moves();
+            if (legalMask == 0) {
+                if (board.pass_and_copy().get_legal_moves() == 0)
+                    break;
+                pv.push_back(PASS);
+                board.pass();
+                continue;
+            }
+
+            auto x = this->transpositionTable.get_best_move(&board, TranspositionTable::get_hash(&board));
+            if (x == I_PASS || !(legalMask & (1ULL << x)))
+                break;
+
+            Move move(x, board.get_flipped(x));
+            pv.push_back(move);
+            board.play_move(move);
+        }
+        return pv;
+    }
+}
@@ -6,8 +6,9 @@
 #include <iostream>
 
 namespace engine {
-    int Engine::end_search_nws(engine::SearchNode *node, int alpha, bool pass, uint64_t legalMask, bool *running) {
-        if (!*running) return SCORE_UNDEFINED;
+    template<typename Policy>
+    int Engine::end_search_nws(engine::SearchNode *node, int alpha, bool pass, uint64_t legalMask, SearchLimits *limits) {
+        if (limits->should_stop(node->numNodes)) return SCORE_UNDEFINED;
 
         auto numEmpty = 64 - node->discCount;
 
@@ -21,6 +22,7 @@ namespace engine {
             return node->board.get_end_value(64);
         }
         ++node->numNodes;
+        TELEMETRY(++node->telemetry.current.numEndNodes;)
 
         if (legalMask == LEGAL_UNDEFINED)
             legalMask = node->board.get_legal_moves();
@@ -30,7 +32,7 @@ namespace engine {
             if (pass)
                 return node->board.get_end_value(node->discCount);
             node->pass();
-            auto value = -end_search_nws(node, -alpha-1, true, LEGAL_UNDEFINED, running);
+            auto value = -end_search_nws<Policy>(node, -alpha-1, true, LEGAL_UNDEFINED, limits);
             node->pass(); // undo pass with another pass
             return value;
         }
@@ -40,23 +42,25 @@ namespace engine {
         int lower = -SCORE_MAX;
         int upper = SCORE_MAX;
         uint_fast8_t hashMoves[2] = {I_PASS, I_PASS};
-        this->transpositionTable.load(node, hash,  numEmpty, &lower, &upper, hashMoves);
+        this->transpositionTable.load<Policy::lockTT>(node, hash,  numEmpty, &lower, &upper, hashMoves);
 
         if (lower == upper) return lower;
         if (lower > alpha) return lower;
         if (upper <= alpha) return upper;
 
         int bestValue = SCORE_UNDEFINED;
-        #if USE_MPC
-            if (numEmpty <= MPC_DEPTH && probcut(node, numEmpty, alpha, alpha+1, legalMask, &bestValue, pass, true, running))
+        if constexpr (Policy::useMPC) {
+            if (numEmpty <= this->searchOptions.mpcDepth &&
+                probcut<Policy>(node, numEmpty, alpha, alpha+1, legalMask, &bestValue, pass, true, limits))
                 return bestValue;
-        #endif
+        }
 
         // start with hash moves
         auto bestMove = I_PASS;
         auto beta = alpha + 1;
         int value;
         Move move;
+        TELEMETRY(int numSearched = 0;)
 
         for (int i = 0; i < 2; ++i) {
             if (hashMoves[i] == I_PASS)
@@ -65,7 +69,7 @@ namespace engine {
                 move.init(hashMoves[i], node->board.get_flipped(hashMoves[i]));
 
                 node->play_move_end(move);
-                value = -end_search_nws(node, -beta, false, LEGAL_UNDEFINED, running);
+                value = -end_search_nws<Policy>(node, -beta, false, LEGAL_UNDEFINED, limits);
                 node->undo_move_end(move);
                 legalMask ^= 1ULL << hashMoves[i];
 
@@ -73,9 +77,12 @@ namespace engine {
                     bestValue = value;
                     bestMove = hashMoves[i];
 
-                    if (value > alpha)
+                    if (value > alpha) {
+                        TELEMETRY(++node->telemetry.current.numCutNodes; if (numSearched == 0) ++node->telemetry.current.numFirstMoveCuts;)
                         break;
+                    }
                 }
+                TELEMETRY(++numSearched;)
             }
         }
         if (alpha < beta && legalMask) {
@@ -100,7 +107,7 @@ namespace engine {
                 swap_next_best_move(moveList, i);
 
                 node->play_move_end(moveList[i].move);
-                value = -end_search_nws(node, -beta, false, moveList[i].legalMask, running);
+                value = -end_search_nws<Policy>(node, -beta, false, moveList[i].legalMask, limits);
                 node->undo_move_end(moveList[i].move);
 
                 // update best move and value
@@ -108,18 +115,23 @@ namespace engine {
                     bestValue = value;
                     bestMove = moveList[i].move.x;
 
-                    if (value > alpha)
+                    if (value > alpha) {
+                        TELEMETRY(++node->telemetry.current.numCutNodes; if (numSearched + i == 0) ++node->telemetry.current.numFirstMoveCuts;)
                         break;
+                    }
                 }
             }
         }
 
-        if (*running) {
-            transpositionTable.store(node, hash, numEmpty, alpha, beta, bestValue, bestMove);
+        if (!limits->is_stopped()) {
+            this->transpositionTable.store<Policy::lockTT>(node, hash, numEmpty, alpha, beta, bestValue, bestMove);
         }
 
         return bestValue;
     }
 
-
+#define INSTANTIATE(...) \
+    template int Engine::end_search_nws<__VA_ARGS__>(SearchNode*, int, bool, uint64_t, SearchLimits*);
+    INSTANTIATE_SEARCH_POLICIES(INSTANTIATE)
+#undef INSTANTIATE
 }
\ No newline at end of file
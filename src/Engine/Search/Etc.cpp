@@ -19,6 +19,7 @@ namespace engine {
      *
      * From Nyanyan's Egaroucid Othello engine
      */
+    template<typename Policy>
     bool Engine::etc(engine::SearchNode *node, std::vector<MoveEval> &moveList, int depth, int *alpha, const int beta,
                      int *v, int *cutoffs) {
         *cutoffs = 0;
@@ -27,7 +28,7 @@ namespace engine {
             l = -SCORE_MAX;
             u = SCORE_MAX;
             node->play_move(moveEval.move);
-            this->transpositionTable.load_bounds(node, TranspositionTable::get_hash(&node->board), depth - 1, &l, &u);
+            this->transpositionTable.load_bounds<Policy::lockTT>(node, TranspositionTable::get_hash(&node->board), depth - 1, &l, &u);
             node->undo_move(moveEval.move);
 
             // -u is lower bound from current player's perspective
@@ -71,6 +72,7 @@ namespace engine {
      *
      * From Nyanyan's Egaroucid Othello engine
      */
+    template<typename Policy>
     bool Engine::etc_nws(engine::SearchNode *node, std::vector<MoveEval> &moveList, int depth, int alpha, int *v, int *cutoffs) {
         *cutoffs = 0;
         int l, u;
@@ -78,7 +80,7 @@ namespace engine {
             l = -SCORE_MAX;
             u = SCORE_MAX;
             node->play_move(moveEval.move);
-            this->transpositionTable.load_bounds(node, TranspositionTable::get_hash(&node->board), depth - 1, &l, &u);
+            this->transpositionTable.load_bounds<Policy::lockTT>(node, TranspositionTable::get_hash(&node->board), depth - 1, &l, &u);
             node->undo_move(moveEval.move);
 
             // -u is lower bound from current player's perspective
@@ -101,4 +103,9 @@ namespace engine {
         return false;
     }
 
+#define INSTANTIATE(...) \
+    template bool Engine::etc<__VA_ARGS__>(SearchNode*, std::vector<MoveEval>&, int, int*, int, int*, int*); \
+    template bool Engine::etc_nws<__VA_ARGS__>(SearchNode*, std::vector<MoveEval>&, int, int, int*, int*);
+    INSTANTIATE_SEARCH_POLICIES(INSTANTIATE)
+#undef INSTANTIATE
 } // engine::eval
\ No newline at end of file
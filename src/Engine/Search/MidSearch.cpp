@@ -3,55 +3,146 @@
 //
 
 #include "../Engine.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <thread>
 
 namespace engine {
     SearchResult
-    Engine::iterative_deepening_search(SearchNode *node, int maxDepth, bool pass, bool useVerbose, bool *running,
-                                       bool *complete) {
+    Engine::iterative_deepening_search(SearchNode *node, bool pass, bool useVerbose, SearchLimits *limits,
+                                       TimeManager *timeManager, const SearchProgressCallback &callback) {
+        return dispatch_search_policy(this->searchOptions, [&]<typename Policy>() {
+            return this->iterative_deepening_search<Policy>(node, pass, useVerbose, limits, timeManager, callback);
+        });
+    }
+
+    template<typename Policy>
+    SearchResult
+    Engine::iterative_deepening_search(SearchNode *node, bool pass, bool useVerbose, SearchLimits *limits,
+                                       TimeManager *timeManager, const SearchProgressCallback &callback) {
         // check for game over
         if (node->board.is_terminal()) {
             node->value = node->board.get_disc_difference();
             node->move = PASS;
             return SearchResult(node);
         }
-        if (maxDepth + node->discCount > 64)
-            maxDepth = 64 - node->discCount;
-        auto legalMask = node->board.get_legal_moves();
+        auto maxDepth = std::min(limits->get_depth_limit(), 64 - node->discCount);
 
-        assert(*running);
         std::pair<int, int> res;
         int prevValue = 0;
+        bool hasValue = false;  // whether an iteration has completed yet
+        std::vector<RootMove> rootMoves;
 
         auto numEmpty = 64 - node->discCount;
-        std::cout << "\033[1mSearch with: " << numEmpty << " empties remaining.\033[0m" << std::endl;
+        node->mode = SearchMode::MIDGAME;
+        node->evalFeatures.set_weights(this->evaluationWeights.get());
+        TELEMETRY(node->telemetry.iterations.clear();)
+        if (useVerbose) {
+            std::cout << "\033[1mSearch with: " << numEmpty << " empties remaining.\033[0m" << std::endl;
+            std::cout << "Search options: " << this->searchOptions.to_string() << std::endl;
+        }
+        // publish the result of a completed iteration
+        auto report = [node, &res, &callback]() {
+            if (callback) {
+                auto progress = SearchResult(node);
+                progress.move = Move(node->board, (uint_fast8_t)res.second);
+                callback(progress);
+            }
+        };
+
+#if USE_WLD_SEARCH
+        bool isWLDReachable = numEmpty <= WLD_SEARCH_DEPTH && maxDepth >= numEmpty;
+#endif
+
         // iterate until to maximum depth
         node->selectivity = MPC_LEVEL_74;
-        for (int depth = 1; *running && depth <= maxDepth; depth++) {
-            if (numEmpty <= PERFECT_SEARCH_DEPTH - 2) {
-                if (depth < numEmpty)
-                    node->selectivity = MPC_LEVEL_99;
-                else
-                    node->selectivity = MPC_LEVEL_98;
-            } else if (numEmpty <= PERFECT_SEARCH_DEPTH) {
-                if (depth < numEmpty)
-                    node->selectivity = MPC_LEVEL_93;
-                else
-                    node->selectivity = MPC_LEVEL_88;
-            } else if (numEmpty <= PERFECT_SEARCH_DEPTH + 2 || depth < 10) {
-                node->selectivity = MPC_LEVEL_88;
-            } else {
-                node->selectivity = MPC_LEVEL_74;
+        for (int depth = 1; !limits->check_now(node->numNodes) && depth <= maxDepth; depth++) {
+#if USE_WLD_SEARCH
+            // once the outcome can be proven, go straight to the proof instead of the last selective iterations
+            if (isWLDReachable && depth > WLD_PRESEARCH_DEPTH)
+                depth = numEmpty;
+#endif
+            node->selectivity = Engine::get_iteration_selectivity(numEmpty, depth);
+            bool isEndSearch = depth == numEmpty;
+
+            int alpha = LOSS;
+            int beta = WIN;
+#if USE_ASPIRATION
+            if (hasValue && depth >= ASPIRATION_DEPTH) {
+                // search a narrow window around the last value
+                alpha = std::max(LOSS, prevValue - ASPIRATION_WINDOW);
+                beta = std::min(WIN, prevValue + ASPIRATION_WINDOW);
             }
+#endif
+#if USE_WLD_SEARCH
+            if (isEndSearch && isWLDReachable) {
+                // prove the outcome with a window around a draw first. It is much cheaper than the exact score, and
+                // its sign then halves the window of the exact solve. ProbCut stays off for both, since a proof can't
+                // rest on a cut that is only likely to be right.
+                node->selectivity = MPC_LEVEL_100;
+                TELEMETRY(node->telemetry.begin_iteration(node->numNodes, node->numETCCuts);)
+                auto wldRes = first_pv_search<Policy>(node, depth, -1, 1, pass, rootMoves, true, limits);
+                TELEMETRY(node->telemetry.end_iteration(depth, node->selectivity, wldRes.first, wldRes.second,
+                                                        wldRes.first != SCORE_UNDEFINED, node->numNodes, node->numETCCuts);)
+                if (wldRes.first == SCORE_UNDEFINED)
+                    break;
 
-            auto tmpRes = first_pv_search(node, depth, LOSS, WIN, pass, legalMask, depth == numEmpty, running);
+                res = wldRes;
+                res.first = std::clamp(res.first, -SCORE_MAX, SCORE_MAX);
+                node->value = res.first;
+                node->mode = res.first == 0 ? SearchMode::EXACT : SearchMode::WLD;
+                prevValue = res.first;
+                hasValue = true;
+                node->stop();
+                report();
+
+                if (useVerbose) {
+                    std::cout << "Depth " << depth << ", selectivity level " << MPC_LEVEL_100 << ": "
+                              << (res.first > 0 ? "win" : res.first < 0 ? "loss" : "draw") << std::endl;
+                }
+
+                // a draw is already exact. Otherwise only solve exactly if it is wanted and expected to finish in time.
+                if (node->mode == SearchMode::EXACT || limits->is_stop_at_wld() ||
+                    (timeManager != nullptr && !timeManager->start_exact_solve(res.second, node->numNodes)))
+                    break;
+
+                alpha = res.first > 0 ? 0 : LOSS;
+                beta = res.first > 0 ? WIN : 0;
+            }
+#endif
+
+            // widen whichever side of the window fails until the value fits
+            TELEMETRY(node->telemetry.begin_iteration(node->numNodes, node->numETCCuts);)
+            std::pair<int, int> tmpRes;
+            int delta = ASPIRATION_WINDOW;
+            while (true) {
+                tmpRes = first_pv_search<Policy>(node, depth, alpha, beta, pass, rootMoves, isEndSearch, limits);
+                if (tmpRes.first == SCORE_UNDEFINED)
+                    break;
+
+                delta *= 2;
+                if (tmpRes.first <= alpha && alpha > LOSS)
+                    alpha = std::max(LOSS, tmpRes.first - delta);
+                else if (tmpRes.first >= beta && beta < WIN)
+                    beta = std::min(WIN, tmpRes.first + delta);
+                else
+                    break;
+            }
+            TELEMETRY(node->telemetry.end_iteration(depth, node->selectivity, tmpRes.first, tmpRes.second,
+                                                    tmpRes.first != SCORE_UNDEFINED, node->numNodes, node->numETCCuts);)
             if (tmpRes.first != SCORE_UNDEFINED) {
                 res = tmpRes;
                 res.first = std::clamp(res.first, -SCORE_MAX, SCORE_MAX);
-                node->value = (int)(0.1 * prevValue + 0.9 * res.first);
+                if (isEndSearch) {
+                    // a selective solve is only a better guess, not the final score
+                    node->value = res.first;
+                    node->mode = node->selectivity == MPC_LEVEL_100 ? SearchMode::EXACT : SearchMode::MIDGAME;
+                } else {
+                    node->value = (int)(0.1 * prevValue + 0.9 * res.first);
+                }
                 prevValue = res.first;
+                hasValue = true;
             }
 
             // verbose
@@ -60,15 +151,35 @@ namespace engine {
             }
 
             node->stop();
+            if (tmpRes.first != SCORE_UNDEFINED)
+                report();
+
+            // let the time manager decide whether the next depth is worth starting
+            if (timeManager != nullptr && tmpRes.first != SCORE_UNDEFINED &&
+                !timeManager->start_next_iteration(res.second, node->numNodes))
+                break;
         }
 
         node->move = Move(node->board, (uint_fast8_t)res.second);
-        return SearchResult(node);
+        auto result = SearchResult(node);
+        TELEMETRY(Engine::export_telemetry(node->board, result);)
+        return result;
+    }
+
+    uint_fast8_t Engine::get_iteration_selectivity(int numEmpty, int depth) {
+        if (numEmpty <= PERFECT_SEARCH_DEPTH - 2)
+            return depth < numEmpty ? MPC_LEVEL_99 : MPC_LEVEL_98;
+        if (numEmpty <= PERFECT_SEARCH_DEPTH)
+            return depth < numEmpty ? MPC_LEVEL_93 : MPC_LEVEL_88;
+        if (numEmpty <= PERFECT_SEARCH_DEPTH + 2 || depth < 10)
+            return MPC_LEVEL_88;
+        return MPC_LEVEL_74;
     }
 
-    std::pair<int, int> Engine::first_pv_search(SearchNode *node, int depth, int alpha, int beta, bool pass, uint64_t legalMask, bool isEndSearch,
-                                bool *running) {
-        if (!*running)
+    template<typename Policy>
+    std::pair<int, int> Engine::first_pv_search(SearchNode *node, int depth, int alpha, int beta, bool pass, std::vector<RootMove> &rootMoves,
+                                bool isEndSearch, SearchLimits *limits) {
+        if (limits->should_stop(node->numNodes))
             return {SCORE_UNDEFINED, I_PASS};
 
         // check if the game is over
@@ -80,17 +191,14 @@ namespace engine {
 
         ++node->numNodes;
 
-        if (legalMask == LEGAL_UNDEFINED)
-            legalMask = node->board.get_legal_moves();
-
         // pass if no legal moveList
-        if (legalMask == 0) {
+        if (rootMoves.empty() && node->board.get_legal_moves() == 0) {
             if (pass) { // second pass in a row means the game is over
                 node->depth = 0;
                 return {node->board.get_end_value(node->discCount), I_PASS};
             }
             node->pass();
-            auto value = -pv_search(node, depth, -beta, -alpha, true, LEGAL_UNDEFINED, isEndSearch, running);
+            auto value = -pv_search<Policy>(node, depth, -beta, -alpha, true, LEGAL_UNDEFINED, isEndSearch, limits);
             node->pass(); // undo pass with another pass
             node->depth = depth;
             return {value, I_PASS};
@@ -104,70 +212,91 @@ namespace engine {
         int lower = -SCORE_MAX;
         int upper = SCORE_MAX;
         uint_fast8_t hashMoves[2] = {I_PASS, I_PASS};
-        this->transpositionTable.load(node, hash, depth, &lower, &upper, hashMoves);
+        this->transpositionTable.load<Policy::lockTT>(node, hash, depth, &lower, &upper, hashMoves);
 
         int originalAlpha = alpha;
 
-        // init move list
-        std::vector<MoveEval> moveList(__builtin_popcountll(legalMask));
+        // the first iteration orders the root with the usual move ordering. Later iterations reuse its move list.
+        if (rootMoves.empty()) {
+            auto legalMask = node->board.get_legal_moves();
+            std::vector<MoveEval> moveList(__builtin_popcountll(legalMask));
+
+            int idx = 0;
+            for (auto mask = bit::lsb(legalMask); legalMask; mask = bit::next_set_bit(legalMask)) {
+                auto x = bit::bitboard_to_coord(mask);
+                moveList[idx].move.init(x, node->board.get_flipped(x));
+                if (moveList[idx].move.flip == node->board.O) {
+                    node->value = node->discCount + 1;
+                    node->depth = 1;
+                    return {node->value, moveList[idx].move.x};
+                }
+                ++idx;
+            }
 
-        int idx = 0;
-        for (auto mask = bit::lsb(legalMask); legalMask; mask = bit::next_set_bit(legalMask)) {
-            auto x = bit::bitboard_to_coord(mask);
-            moveList[idx].move.init(x, node->board.get_flipped(x));
-            if (moveList[idx].move.flip == node->board.O) {
-                node->value = node->discCount + 1;
-                node->depth = 1;
-                return {node->value, moveList[idx].move.x};
+            this->evaluate_move_list<Policy>(node, depth, alpha, beta, moveList, hashMoves, limits);
+
+            rootMoves.reserve(moveList.size());
+            for (int i = 0; i < (int)moveList.size(); ++i) {
+                swap_next_best_move(moveList, i);
+                rootMoves.push_back({moveList[i].move, moveList[i].legalMask, 0});
             }
-            ++idx;
         }
 
-        this->evaluate_move_list(node, depth, alpha, beta, moveList, hashMoves, running);
-
         // search
         int bestValue = SCORE_UNDEFINED;
-        auto bestMove = PASS;
+        int bestIdx = 0;
         int value;
 
-        for (int i = 0; i < moveList.size(); ++i) {
-            swap_next_best_move(moveList, i);
+        for (int i = 0; i < (int)rootMoves.size(); ++i) {
+            auto &rootMove = rootMoves[i];
+            auto numNodes = node->numNodes;
 
-            node->play_move(moveList[i].move);
+            node->play_move(rootMove.move);
             if (bestValue == SCORE_UNDEFINED) {
-                value = -pv_search(node, depth - 1, -beta, -alpha, false, moveList[i].legalMask, isEndSearch, running);
+                value = -pv_search<Policy>(node, depth - 1, -beta, -alpha, false, rootMove.legalMask, isEndSearch, limits);
             } else {
-                value = -null_window_search(node, depth - 1, -alpha - 1, false, moveList[i].legalMask, isEndSearch, running);
+                value = -null_window_search<Policy>(node, depth - 1, -alpha - 1, false, rootMove.legalMask, isEndSearch, limits);
                 if (alpha < value && value < beta) {
-                    int value2 = -pv_search(node, depth - 1, -beta, -value, false, moveList[i].legalMask, isEndSearch, running);
+                    int value2 = -pv_search<Policy>(node, depth - 1, -beta, -value, false, rootMove.legalMask, isEndSearch, limits);
                     value = std::max(value, value2);
                 }
             }
-            node->undo_move(moveList[i].move);
+            node->undo_move(rootMove.move);
+            rootMove.numNodes = node->numNodes - numNodes;
 
             if (value > bestValue) {
                 bestValue = value;
-                bestMove = moveList[i].move;
+                bestIdx = i;
 
                 if (value > alpha) {
-                    if (value >= beta)
+                    if (value >= beta) {
+                        TELEMETRY(++node->telemetry.current.numCutNodes; if (i == 0) ++node->telemetry.current.numFirstMoveCuts;)
                         break;
+                    }
                     alpha = value;
                 }
             }
         }
 
-        if (*running) {
-            this->transpositionTable.store(node, hash, depth, originalAlpha, beta, bestValue, bestMove.x);
+        if (!limits->is_stopped()) {
+            auto bestMove = rootMoves[bestIdx].move;
+            this->transpositionTable.store<Policy::lockTT>(node, hash, depth, originalAlpha, beta, bestValue, bestMove.x);
             node->depth = depth;
+
+            // next iteration: best move first, then the moves that were hardest to refute
+            std::rotate(rootMoves.begin(), rootMoves.begin() + bestIdx, rootMoves.begin() + bestIdx + 1);
+            std::stable_sort(rootMoves.begin() + 1, rootMoves.end(), [](const RootMove &a, const RootMove &b) {
+                return a.numNodes > b.numNodes;
+            });
             return {bestValue, bestMove.x};
         }
         return {SCORE_UNDEFINED, I_PASS};
     }
 
+    template<typename Policy>
     int
-    Engine::pv_search(SearchNode *node, int depth, int alpha, int beta, bool pass, uint64_t legalMask, bool isEndSearch, bool *running) {
-        if (!*running)
+    Engine::pv_search(SearchNode *node, int depth, int alpha, int beta, bool pass, uint64_t legalMask, bool isEndSearch, SearchLimits *limits) {
+        if (limits->should_stop(node->numNodes))
             return SCORE_UNDEFINED;
 
         if (!isEndSearch) {
@@ -179,7 +308,7 @@ namespace engine {
             }
         }
         if (beta - alpha == 1)
-            return null_window_search(node, depth, alpha, pass, legalMask, isEndSearch, running);
+            return null_window_search<Policy>(node, depth, alpha, pass, legalMask, isEndSearch, limits);
 
         ++node->numNodes;
 
@@ -190,7 +319,7 @@ namespace engine {
             if (pass)
                 return node->board.get_end_value(node->discCount);
             node->pass();
-            auto value = -pv_search(node, depth, -beta, -alpha, true, LEGAL_UNDEFINED, isEndSearch, running);
+            auto value = -pv_search<Policy>(node, depth, -beta, -alpha, true, LEGAL_UNDEFINED, isEndSearch, limits);
             node->pass();
             return value;
         }
@@ -199,7 +328,7 @@ namespace engine {
         int lower = -SCORE_MAX;
         int upper = SCORE_MAX;
         uint_fast8_t hashMoves[2] = {I_PASS, I_PASS};
-        this->transpositionTable.load(node, hash, depth, &lower, &upper, hashMoves);
+        this->transpositionTable.load<Policy::lockTT>(node, hash, depth, &lower, &upper, hashMoves);
 
         if (lower == upper) return lower;
         if (lower >= beta) return lower;
@@ -221,16 +350,17 @@ namespace engine {
 
         int bestValue = SCORE_UNDEFINED;
         int cutoffs = 0;
-        #if USE_ETC
-            if (depth >= ETC_DEPTH && etc(node, moveList, depth, &alpha, beta, &bestValue, &cutoffs))
+        if constexpr (Policy::useETC) {
+            if (depth >= this->searchOptions.etcDepth && etc<Policy>(node, moveList, depth, &alpha, beta, &bestValue, &cutoffs))
                 return bestValue;
-        #endif
-        #if USE_MPC
-            if (depth <= MPC_DEPTH && probcut(node, depth, alpha, beta, legalMask, &bestValue, pass, isEndSearch, running))
+        }
+        if constexpr (Policy::useMPC) {
+            if (depth <= this->searchOptions.mpcDepth &&
+                probcut<Policy>(node, depth, alpha, beta, legalMask, &bestValue, pass, isEndSearch, limits))
                 return bestValue;
-        #endif
+        }
 
-        this->evaluate_move_list(node, depth, alpha, beta, moveList, hashMoves, running);
+        this->evaluate_move_list<Policy>(node, depth, alpha, beta, moveList, hashMoves, limits);
 
         uint_fast8_t bestMove = I_PASS;
         int value;
@@ -238,18 +368,18 @@ namespace engine {
         for (int i = 0; i < moveList.size() - cutoffs; ++i) {
             swap_next_best_move(moveList, i);
 
-            #if USE_ETC
+            if constexpr (Policy::useETC) {
                 if (moveList[i].move.flip == 0ULL)
                     break;
-            #endif
+            }
 
             node->play_move(moveList[i].move);
             if (bestValue == SCORE_UNDEFINED) {
-                value = -pv_search(node, depth - 1, -beta, -alpha, false, moveList[i].legalMask, isEndSearch, running);
+                value = -pv_search<Policy>(node, depth - 1, -beta, -alpha, false, moveList[i].legalMask, isEndSearch, limits);
             } else {
-                value = -null_window_search(node, depth - 1, -alpha - 1, false, moveList[i].legalMask, isEndSearch, running);
+                value = -null_window_search<Policy>(node, depth - 1, -alpha - 1, false, moveList[i].legalMask, isEndSearch, limits);
                 if (alpha < value && value < beta) {
-                    int value2 = -pv_search(node, depth - 1, -beta, -value, false, moveList[i].legalMask, isEndSearch, running);
+                    int value2 = -pv_search<Policy>(node, depth - 1, -beta, -value, false, moveList[i].legalMask, isEndSearch, limits);
                     value = std::max(value, value2);
                 }
             }
@@ -259,15 +389,17 @@ namespace engine {
                 bestValue = value;
                 bestMove = moveList[i].move.x;
                 if (value > alpha) {
-                    if (value >= beta)
+                    if (value >= beta) {
+                        TELEMETRY(++node->telemetry.current.numCutNodes; if (i == 0) ++node->telemetry.current.numFirstMoveCuts;)
                         break;
+                    }
                     alpha = value;
                 }
             }
         }
 
-        if (*running)
-            this->transpositionTable.store(node, hash, depth, originalAlpha, beta, bestValue, bestMove);
+        if (!limits->is_stopped())
+            this->transpositionTable.store<Policy::lockTT>(node, hash, depth, originalAlpha, beta, bestValue, bestMove);
 
         return bestValue;
     }
@@ -305,4 +437,9 @@ namespace engine {
 
         return bestValue;
     }
+
+#define INSTANTIATE(...) \
+    template int Engine::pv_search<__VA_ARGS__>(SearchNode*, int, int, int, bool, uint64_t, bool, SearchLimits*);
+    INSTANTIATE_SEARCH_POLICIES(INSTANTIATE)
+#undef INSTANTIATE
 }
@@ -5,9 +5,10 @@
 #include "../Engine.h"
 
 namespace engine {
+    template<typename Policy>
     int
-    Engine::null_window_search(SearchNode *node, int depth, int alpha, bool pass, uint64_t legalMask, bool isEndSearch, bool *running) {
-        if (!*running)
+    Engine::null_window_search(SearchNode *node, int depth, int alpha, bool pass, uint64_t legalMask, bool isEndSearch, SearchLimits *limits) {
+        if (limits->should_stop(node->numNodes))
             return SCORE_UNDEFINED;
 
         // check if we have reached the maximum depth
@@ -20,7 +21,7 @@ namespace engine {
             }
         }
         if (isEndSearch && depth <= MID_TO_END_DEPTH)
-            return end_search_nws(node, alpha, pass, legalMask, running);
+            return end_search_nws<Policy>(node, alpha, pass, legalMask, limits);
 
         ++node->numNodes;
 
@@ -33,7 +34,7 @@ namespace engine {
                 return node->board.get_end_value(node->discCount);
 
             node->pass();
-            auto value = -null_window_search(node, depth, -alpha-1, true, LEGAL_UNDEFINED, isEndSearch, running);
+            auto value = -null_window_search<Policy>(node, depth, -alpha-1, true, LEGAL_UNDEFINED, isEndSearch, limits);
             node->pass(); // undo pass with another pass
             return value;
         }
@@ -43,7 +44,7 @@ namespace engine {
         int lower = -SCORE_MAX;
         int upper = SCORE_MAX;
         uint_fast8_t hashMoves[2] = {I_PASS, I_PASS};
-        this->transpositionTable.load(node, hash, depth, &lower, &upper, hashMoves);
+        this->transpositionTable.load<Policy::lockTT>(node, hash, depth, &lower, &upper, hashMoves);
 
         if (lower == upper) return lower;
         if (lower > alpha) return lower;
@@ -51,11 +52,12 @@ namespace engine {
 
         int v = SCORE_UNDEFINED;
 
-        #if USE_MPC
-            if (depth <= MPC_DEPTH && probcut(node, depth, alpha, alpha+1, legalMask, &v, pass, isEndSearch, running)) {
+        if constexpr (Policy::useMPC) {
+            if (depth <= this->searchOptions.mpcDepth &&
+                probcut<Policy>(node, depth, alpha, alpha+1, legalMask, &v, pass, isEndSearch, limits)) {
                 return v;
             }
-        #endif
+        }
 
         // init move list
         std::vector<MoveEval> moveList(__builtin_popcountll(legalMask));
@@ -69,54 +71,57 @@ namespace engine {
             ++idx;
         }
 
-        #if USE_ETC
-            int cutoffs = 0;
-            if (depth >= ETC_DEPTH && etc_nws(node, moveList, depth, alpha, &v, &cutoffs)) {
+        int cutoffs = 0;
+        if constexpr (Policy::useETC) {
+            if (depth >= this->searchOptions.etcDepth && etc_nws<Policy>(node, moveList, depth, alpha, &v, &cutoffs)) {
                 return v;
             }
-        #endif
+        }
 
         // evaluate move list
-        this->evaluate_move_list_nws(node, depth, alpha, moveList, hashMoves, running);
+        this->evaluate_move_list_nws<Policy>(node, depth, alpha, moveList, hashMoves, limits);
 
         // search
         auto beta = alpha + 1;
         uint_fast8_t bestMove = I_PASS;
         int g;
 
-        #if USE_ETC
-            for (int i = 0; i < moveList.size() - cutoffs; ++i) {
-        #else
-            for (int i = 0; i < moveList.size(); ++i) {
-        #endif
+        for (int i = 0; i < moveList.size() - cutoffs; ++i) {
             swap_next_best_move(moveList, i);
 
             // etc
-            #if USE_ETC
+            if constexpr (Policy::useETC) {
                 if (moveList[i].move.flip == 0ULL)
                     break;
-            #endif
+            }
 
             node->play_move(moveList[i].move);
-                g = -null_window_search(node, depth - 1, -beta, false, moveList[i].legalMask, isEndSearch, running);
+                g = -null_window_search<Policy>(node, depth - 1, -beta, false, moveList[i].legalMask, isEndSearch, limits);
             node->undo_move(moveList[i].move);
 
             if (g > v) {
                 v = g;
                 bestMove = moveList[i].move.x;
 
-                if (g >= beta)
+                if (g >= beta) {
+                    TELEMETRY(++node->telemetry.current.numCutNodes; if (i == 0) ++node->telemetry.current.numFirstMoveCuts;)
                     break;
+                }
             }
         }
 
-        if (*running) {
-            this->transpositionTable.store(node, hash, depth, alpha, beta, v, bestMove);
+        if (!limits->is_stopped()) {
+            this->transpositionTable.store<Policy::lockTT>(node, hash, depth, alpha, beta, v, bestMove);
         }
 
         return v;
     }
 
+#define INSTANTIATE(...) \
+    template int Engine::null_window_search<__VA_ARGS__>(SearchNode*, int, int, bool, uint64_t, bool, SearchLimits*);
+    INSTANTIATE_SEARCH_POLICIES(INSTANTIATE)
+#undef INSTANTIATE
+
     int Engine::alpha_beta_nws1(engine::SearchNode *node, int alpha, bool pass, uint64_t legalMask) {
         ++node->numNodes;
 
@@ -41,9 +41,10 @@ namespace engine {
      * @param alpha: lower value bound
      * @param beta: upper value bound
      * @param moveEval: the move eval pair
-     * @param running: pointer to the running flag
+     * @param limits: search limits
      */
-    void Engine::move_evaluate(SearchNode *node, int depth, int alpha, int beta, MoveEval *moveEval, bool *running) {
+    template<typename Policy>
+    void Engine::move_evaluate(SearchNode *node, int depth, int alpha, int beta, MoveEval *moveEval, SearchLimits *limits) {
         node->play_move(moveEval->move);
             moveEval->legalMask = node->board.get_legal_moves();
 
@@ -63,7 +64,7 @@ namespace engine {
                     auto selectivity = node->selectivity;
                     node->selectivity = MPC_LEVEL_88;
                     moveEval->value -=
-                            this->pv_search(node, depth, alpha, beta, false, moveEval->legalMask, false, running) *
+                            this->pv_search<Policy>(node, depth, alpha, beta, false, moveEval->legalMask, false, limits) *
                             (W_VALUE_MID + W_DEPTH_MID * depth);
                     node->selectivity = selectivity;
                 }
@@ -79,9 +80,10 @@ namespace engine {
      * @param alpha: lower value bound
      * @param beta: upper value bound
      * @param moveEval: the move eval pair
-     * @param running: pointer to the running flag
+     * @param limits: search limits
      */
-    void Engine::move_evaluate_nws(SearchNode *node, int depth, int alpha, int beta, MoveEval *moveEval, bool* running) {
+    template<typename Policy>
+    void Engine::move_evaluate_nws(SearchNode *node, int depth, int alpha, int beta, MoveEval *moveEval, SearchLimits *limits) {
         node->play_move(moveEval->move);
             moveEval->legalMask = node->board.get_legal_moves();
 
@@ -100,7 +102,7 @@ namespace engine {
                     auto selectivity = node->selectivity;
                     node->selectivity = MPC_LEVEL_88;
                     moveEval->value -=
-                            this->pv_search(node, depth, alpha, beta, false, moveEval->legalMask, false, running) *
+                            this->pv_search<Policy>(node, depth, alpha, beta, false, moveEval->legalMask, false, limits) *
                             (W_VALUE_NWS + W_DEPTH_NWS * depth);
                     node->selectivity = selectivity;
                 }
@@ -168,9 +170,10 @@ namespace engine {
      * @param legalMask: bitboard of legalMask moves
      * @param moveList: the move list
      * @param hashMoves: the hash moves
-     * @param running: pointer to the running flag
+     * @param limits: search limits
      */
-    void Engine::evaluate_move_list(SearchNode *node, int depth, int alpha, int beta, std::vector<MoveEval> &moveList, const uint_fast8_t hashMoves[], bool *running) {
+    template<typename Policy>
+    void Engine::evaluate_move_list(SearchNode *node, int depth, int alpha, int beta, std::vector<MoveEval> &moveList, const uint_fast8_t hashMoves[], SearchLimits *limits) {
         int evalDepth = depth >> 3;
         if (depth >= 16)
             evalDepth += (depth - 14) >> 1;
@@ -183,7 +186,7 @@ namespace engine {
             else if (moveEval.move.x == hashMoves[1])
                 moveEval.value = SECOND_HASH_MOVE_SCORE;
             else
-                this->move_evaluate(node, evalDepth, evalAlpha, evalBeta, &moveEval, running);
+                this->move_evaluate<Policy>(node, evalDepth, evalAlpha, evalBeta, &moveEval, limits);
         }
     }
 
@@ -194,15 +197,16 @@ namespace engine {
      * @param alpha alpha value
      * @param beta beta value
      * @param moveList move list
-     * @param running running flag
+     * @param limits search limits
      */
-    void Engine::evaluate_move_list(SearchNode *node, int depth, int alpha, int beta, std::vector<MoveEval> &moveList, bool *running) {
+    template<typename Policy>
+    void Engine::evaluate_move_list(SearchNode *node, int depth, int alpha, int beta, std::vector<MoveEval> &moveList, SearchLimits *limits) {
         int evalDepth = depth >> 3; // shallow search depth
         if (depth >= 16) evalDepth += (depth - 14) >> 1;
         int evalAlpha = -std::min(64, beta + OFFSET_BETA_MID);
         int evalBeta = -std::max(-64, alpha - OFFSET_ALPHA_MID);
         for (auto & moveEval : moveList) {
-            this->move_evaluate(node, evalDepth, evalAlpha, evalBeta, &moveEval, running);
+            this->move_evaluate<Policy>(node, evalDepth, evalAlpha, evalBeta, &moveEval, limits);
         }
     }
 
@@ -214,9 +218,10 @@ namespace engine {
      * @param legal: bitmask of legal moves
      * @param moves: vector of legal moves (to be filled)
      * @param result: search result
-     * @param running: pointer to the running flag
+     * @param limits: search limits
      */
-    void Engine::evaluate_move_list_nws(SearchNode *node, int depth, int alpha, std::vector<MoveEval> &moveList, uint_fast8_t hashMoves[], bool *running) {
+    template<typename Policy>
+    void Engine::evaluate_move_list_nws(SearchNode *node, int depth, int alpha, std::vector<MoveEval> &moveList, uint_fast8_t hashMoves[], SearchLimits *limits) {
         depth >>= 4; // shallow search depth
 
         int evalAlpha = -std::min(64, alpha + OFFSET_BETA_NWS);
@@ -228,10 +233,20 @@ namespace engine {
             else if (moveEval.move.x == hashMoves[1])
                 moveEval.value = SECOND_HASH_MOVE_SCORE;
             else
-                this->move_evaluate_nws(node, depth, evalAlpha, evalBeta, &moveEval, running);
+                this->move_evaluate_nws<Policy>(node, depth, evalAlpha, evalBeta, &moveEval, limits);
         }
     }
 
+#define INSTANTIATE(...) \
+    template void Engine::evaluate_move_list<__VA_ARGS__>(SearchNode*, int, int, int, std::vector<MoveEval>&, \
+                                                          const uint_fast8_t[], SearchLimits*); \
+    template void Engine::evaluate_move_list<__VA_ARGS__>(SearchNode*, int, int, int, std::vector<MoveEval>&, \
+                                                          SearchLimits*); \
+    template void Engine::evaluate_move_list_nws<__VA_ARGS__>(SearchNode*, int, int, std::vector<MoveEval>&, \
+                                                              uint_fast8_t[], SearchLimits*);
+    INSTANTIATE_SEARCH_POLICIES(INSTANTIATE)
+#undef INSTANTIATE
+
     /** evaluate move list for endgame
      *
      * @param board: the current state of the game
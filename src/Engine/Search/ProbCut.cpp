@@ -4,31 +4,17 @@
 
 #include "../Engine.h"
 #include "../../Util.h"
+#include "ProbCutModel.h"
+#include <filesystem>
+#include <fstream>
 #include <random>
 #include <iostream>
 
 
 namespace engine {
-    /*constexpr double PROBCUT_A = 0.7146898310704181;
-    constexpr double PROBCUT_B = -13.597964481565334;
-    constexpr double PROBCUT_C = 1.3567493938287527;
-    constexpr double PROBCUT_D = 0.4077673444397871;
-    constexpr double PROBCUT_E = 2.1042212354434326;
-    constexpr double PROBCUT_F = 4.028484368537427;
-    constexpr double PROBCUT_G = 4.850073713326121;*/
-
-    constexpr double PROBCUT_A = 0.9006402774092823;
-    constexpr double PROBCUT_B = -7.8988857964929275;
-    constexpr double PROBCUT_C = 0.799688863608567;
-    constexpr double PROBCUT_D = 1.05409818138701;
-    constexpr double PROBCUT_E = 3.1602332178243904;
-    constexpr double PROBCUT_F = 3.609493332834981;
-    constexpr double PROBCUT_G = 2.602946546930604;
-
     constexpr int SHALLOW_DEPTHS[MPC_DEPTH+1] = {
             0, 0, 0, 1, 2, 3, 2, 3, 4, 5, 4, 5, 6, 7, 6, 7, 8, 9, 8, 9, 10
     };
-    constexpr double MPC_T[MAX_MPC_LEVEL+1] = {1.13, 1.55, 1.81, 2.32, 2.57, 9.99};
     int PROBCUT_ERRORS[MAX_MPC_LEVEL+1][61][MPC_DEPTH+1][MPC_DEPTH+1];
 
     /**
@@ -41,11 +27,12 @@ namespace engine {
      * @param v variable to store shallow search value
      * @param passed whether the previous move was a pass
      * @param isEndSearch whether the current search is an endgame search
-     * @param running termination flag
+     * @param limits search limits
      * @return
      */
+    template<typename Policy>
     bool Engine::probcut(engine::SearchNode *node, int depth, int alpha, int beta,
-                          uint64_t legalMask, int* v, bool passed, bool isEndSearch, bool *running) {
+                          uint64_t legalMask, int* v, bool passed, bool isEndSearch, SearchLimits *limits) {
         if (node->selectivity >= MPC_LEVEL_100)
             return false;
         auto selectivity = node->selectivity;
@@ -60,12 +47,14 @@ namespace engine {
         if (eval >= beta + (errorShallow + error0) / 2){
             int pcBeta = beta + errorShallow;
             if (pcBeta < WIN){
-                if (null_window_search(node, shallow, pcBeta - 1, passed, legalMask, false, running) >= pcBeta){
+                TELEMETRY(++node->telemetry.current.numProbCutAttempts[selectivity];)
+                if (null_window_search<Policy>(node, shallow, pcBeta - 1, passed, legalMask, false, limits) >= pcBeta){
                     *v = beta;
                     if (isEndSearch)
                         *v += beta & 1;
                     node->selectivity = selectivity;
                     ++node->numProbCuts;
+                    TELEMETRY(++node->telemetry.current.numProbCutSuccesses[selectivity];)
                     return true;
                 }
             }
@@ -73,12 +62,14 @@ namespace engine {
         if (eval <= alpha - (errorShallow + error0) / 2){
             int pcAlpha = alpha - errorShallow;
             if (pcAlpha > LOSS){
-                if (null_window_search(node, shallow, pcAlpha, passed, legalMask, false, running) <= pcAlpha){
+                TELEMETRY(++node->telemetry.current.numProbCutAttempts[selectivity];)
+                if (null_window_search<Policy>(node, shallow, pcAlpha, passed, legalMask, false, limits) <= pcAlpha){
                     *v = alpha;
                     if (isEndSearch)
                         *v -= alpha & 1;
                     node->selectivity = selectivity;
                     ++node->numProbCuts;
+                    TELEMETRY(++node->telemetry.current.numProbCutSuccesses[selectivity];)
                     return true;
                 }
             }
@@ -87,14 +78,22 @@ namespace engine {
         return false;
     }
 
-    void Engine::probcut_init() {
+#define INSTANTIATE(...) \
+    template bool Engine::probcut<__VA_ARGS__>(SearchNode*, int, int, int, uint64_t, int*, bool, bool, SearchLimits*);
+    INSTANTIATE_SEARCH_POLICIES(INSTANTIATE)
+#undef INSTANTIATE
+
+    void Engine::probcut_init(const std::string &filepath) {
+        // the default parameters are used if there is no parameter file
+        ProbCutModel model;
+        if (std::filesystem::exists(filepath) && !model.load(filepath))
+            std::cerr << "using the default ProbCut parameters" << std::endl;
+
         for (auto level = 0; level <= MAX_MPC_LEVEL; ++level) {
             for (auto discCount = 4; discCount <= 64; ++discCount) {
                 for (auto s = 0; s < MPC_DEPTH; ++s) {
                     for (auto d = s+1; d <= MPC_DEPTH; ++d) {
-                        double error = PROBCUT_A * ((double)discCount / 64.0) + PROBCUT_B * ((double)s / 60.0) + PROBCUT_C * ((double)d / 60.0);
-                        error = PROBCUT_D * error * error * error + PROBCUT_E * error * error + PROBCUT_F * error + PROBCUT_G;
-                        error = std::ceil(error * MPC_T[level]);
+                        double error = std::ceil(model.get_sigma(discCount, s, d) * model.t[level]);
                         PROBCUT_ERRORS[level][discCount - 4][s][d] = (int)error;
                     }
                 }
@@ -103,102 +102,121 @@ namespace engine {
     }
 
     /**
-     * @brief collect data for prob cut tuning
-     * @param numGames number of games to play.
-     * @param depths list of depths to search at.
-     * @param numThreads number of threads to use.
+     * @brief collect data for ProbCut tuning. Random games are played, and every position is searched without
+     * ProbCut to each depth from 0 to maxDepth. Each thread has its own engine, so the searches don't share a
+     * transposition table, and the table is cleared before each position so the shallow searches can't use the
+     * results of deeper ones.
+     * @param numGames number of games to play
+     * @param numThreads number of threads to use
+     * @param maxDepth deepest search of each position
+     * @param filepath file the samples are written to, read by ProbCutModel::read_samples
+     * @param numHashBits size of each thread's transposition table, as a power of 2 number of entries
+     * @return whether the file was written
      */
-    void Engine::collect_prob_cut_data(int numGames, int numThreads) {
-        std::ofstream file(MPC_DATA_FILEPATH);
+    bool Engine::collect_prob_cut_data(int numGames, int numThreads, int maxDepth, const std::string &filepath,
+                                       int numHashBits) {
+        numThreads = std::max(1, numThreads);
+        maxDepth = std::clamp(maxDepth, 1, MPC_DEPTH);
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(filepath).parent_path(), error);
+
+        const auto tmpFilepath = filepath + ".tmp";
+        std::ofstream file(tmpFilepath, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "could not write " << tmpFilepath << std::endl;
+            return false;
+        }
+        file.write(ProbCutSample::MAGIC, sizeof(ProbCutSample::MAGIC));
+        file.write(reinterpret_cast<const char *>(&ProbCutSample::VERSION), sizeof(ProbCutSample::VERSION));
 
         std::vector<std::thread> threads;
-        std::mutex fileMtx;
-        std::mutex gameNoMtx;
-        std::atomic<int> g(0);
-        std::atomic<bool> printLock(false);
+        std::mutex fileLock;
+        std::atomic<int> nextGame = 0;
+        std::atomic<int> numComplete = 0;
+        std::atomic<bool> printLock = false;
 
         util::ProgressBar progressBar(numGames, "Collecting ProbCut Data", util::FRACTION);
         progressBar.print();
 
         threads.reserve(numThreads);
         for (int t = 0; t < numThreads; ++t) {
-            threads.emplace_back([&file, &fileMtx, &gameNoMtx, &g, &printLock, &progressBar, numGames, this]() {
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::vector<int> values;
-                values.reserve(28);
-                auto* running = new bool(true);
-                bool gameOver = false;
-                bool passed;
-                uint64_t legalMask;
-                Move move;
-
-                while (g < numGames) {
+            threads.emplace_back([&, seed = std::random_device()()]() {
+                std::mt19937 gen(seed);
+                Engine engine(numHashBits);
+                SearchLimits limits;
+                std::vector<ProbCutSample> buffer;
+                buffer.reserve(PROBCUT_BUFFER_SIZE);
+
+                // the samples measure the error of full-width searches, so ProbCut is compiled out of them
+                using Policy = SearchPolicy<false, USE_ETC, false>;
+
+                auto flush = [&]() {
+                    std::lock_guard<std::mutex> lock(fileLock);
+                    file.write(reinterpret_cast<const char *>(buffer.data()),
+                               (std::streamsize)(buffer.size() * sizeof(ProbCutSample)));
+                    buffer.clear();
+                };
+
+                for (int g = nextGame++; g < numGames; g = nextGame++) {
                     SearchNode node((Board()));
                     node.selectivity = MPC_LEVEL_100;
 
-                    while (node.discCount < 64 && !gameOver) {
+                    while (true) {
                         // get legal moves
-                        passed = false;
-                        legalMask = node.board.get_legal_moves();
+                        bool passed = false;
+                        uint64_t legalMask = node.board.get_legal_moves();
                         if (!legalMask) {
                             node.pass();
                             passed = true;
                             legalMask = node.board.get_legal_moves();
-                            if (!legalMask) {
-                                gameOver = true;
+                            if (!legalMask)
                                 break;
-                            }
                         }
 
-                        int d = 0;
-                        *running = true;
-                        auto timer = make_timer_thread(3, running, false, false);
-                        while (*running && d + node.discCount <= 64) {
-                            values.emplace_back(pv_search(&node, d++, -127, 127, passed, legalMask, false, running));
+                        // search the position to every depth up to the number of empty squares
+                        engine.transpositionTable.clear();
+                        ProbCutSample sample{};
+                        sample.discCount = (uint8_t)node.discCount;
+                        for (int d = 0; d <= maxDepth && d + node.discCount <= 64; ++d) {
+                            auto value = engine.pv_search<Policy>(&node, d, -SCORE_MAX, SCORE_MAX, passed, legalMask, false, &limits);
+                            sample.values[sample.numValues++] = (int8_t)std::clamp(value, -SCORE_MAX, SCORE_MAX);
+                        }
+                        if (sample.numValues > 1) {
+                            buffer.push_back(sample);
+                            if (buffer.size() >= PROBCUT_BUFFER_SIZE)
+                                flush();
                         }
-
-                        if (!*running)
-                            values.pop_back();
-
-                        *running = false;
-                        timer.join();
 
                         // pick a random move
                         std::uniform_int_distribution<> dis(0, __builtin_popcountll(legalMask) - 1);
                         int moveIndex = dis(gen);
                         for (int _ = 0; _ < moveIndex; ++_)
                             legalMask &= legalMask - 1;
-                        move = Move(node.board, bit::bitboard_to_coord(legalMask));
-                        node.play_move(move);
-
-                        // update everything
-                        fileMtx.lock();
-                        this->transpositionTable.happy_birthday(255);
-                        for (d = 1; d < values.size(); ++d) {
-                            for (int s = 0; s < d; ++s) {
-                                file << (int)node.discCount << " " << s << " " << d << " " << values[d] - values[s] << std::endl;
-                            }
-                        }
-                        fileMtx.unlock();
-                        values.clear();
+                        node.play_move(Move(node.board, bit::bitboard_to_coord(legalMask)));
                     }
 
-                    // update progress
-                    gameNoMtx.lock();
-                    ++g;
-                    gameNoMtx.unlock();
-
+                    // print progress
+                    ++numComplete;
                     if (!printLock) {
                         printLock = true;
-                        progressBar.update(g + 1);
+                        progressBar.update(numComplete);
                         printLock = false;
                     }
                 }
-                delete running;
+                flush();
             });
         }
         for (auto &t : threads)
             t.join();
+        file.close();
+
+        // rename the finished file into place, so an interrupted run doesn't leave a truncated sample file
+        if (file.fail() || std::rename(tmpFilepath.c_str(), filepath.c_str()) != 0) {
+            std::cerr << "could not write " << filepath << std::endl;
+            std::remove(tmpFilepath.c_str());
+            return false;
+        }
+        return true;
     }
-}
\ No newline at end of file
+}
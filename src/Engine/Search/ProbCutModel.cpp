@@ -0,0 +1,274 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "ProbCutModel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace engine {
+    constexpr int NUM_DISC_COUNTS = 61;  // 4 to 64 discs
+
+    static inline double get_x(const double *c, int discCount, int shallow, int depth) {
+        return c[0] * ((double)discCount / 64.0) + c[1] * ((double)shallow / 60.0) + c[2] * ((double)depth / 60.0);
+    }
+
+    static inline double get_sigma(const double *c, double x) {
+        return c[3] * x * x * x + c[4] * x * x + c[5] * x + c[6];
+    }
+
+    double ProbCutModel::get_sigma(int discCount, int shallow, int depth) const {
+        return engine::get_sigma(this->coefficients, get_x(this->coefficients, discCount, shallow, depth));
+    }
+
+    bool ProbCutModel::load(const std::string &filepath) {
+        std::ifstream file(filepath);
+        if (!file.is_open())
+            return false;
+
+        // one parameter per line: its name, then its values. Lines starting with # are comments
+        ProbCutModel model = *this;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            std::istringstream iss(line);
+            std::string name;
+            if (!(iss >> name) || name[0] == '#')
+                continue;
+
+            bool isValid;
+            if (name == "t") {
+                isValid = true;
+                for (auto &t: model.t)
+                    isValid = isValid && (bool)(iss >> t);
+            } else {
+                auto c = std::find(COEFFICIENT_NAMES, COEFFICIENT_NAMES + NUM_COEFFICIENTS, name[0]);
+                isValid = name.size() == 1 && c != COEFFICIENT_NAMES + NUM_COEFFICIENTS &&
+                          (bool)(iss >> model.coefficients[c - COEFFICIENT_NAMES]);
+            }
+            if (!isValid) {
+                std::cerr << "invalid ProbCut parameter on line " << lineNumber << " of " << filepath << std::endl;
+                return false;
+            }
+        }
+
+        *this = model;
+        return true;
+    }
+
+    bool ProbCutModel::save(const std::string &filepath, const std::string &comment) const {
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(filepath).parent_path(), error);
+
+        // rename the finished file over the old one, so the engine never reads a partial file
+        const auto tmpFilepath = filepath + ".tmp";
+        std::ofstream file(tmpFilepath);
+        if (!file.is_open()) {
+            std::cerr << "could not write " << tmpFilepath << std::endl;
+            return false;
+        }
+
+        file << "# ProbCut error model: sigma = d x^3 + e x^2 + f x + g, x = a discs / 64 + b shallow / 60 + c depth / 60\n";
+        file << "# margin of selectivity level i = t[i] sigma\n";
+        if (!comment.empty())
+            file << "# " << comment << "\n";
+        for (int i = 0; i < NUM_COEFFICIENTS; ++i)
+            file << COEFFICIENT_NAMES[i] << " " << std::setprecision(17) << this->coefficients[i] << "\n";
+        file << "t" << std::setprecision(6);
+        for (auto t: this->t)
+            file << " " << t;
+        file << std::endl;
+        file.close();
+
+        if (file.fail() || std::rename(tmpFilepath.c_str(), filepath.c_str()) != 0) {
+            std::cerr << "could not write " << filepath << std::endl;
+            std::remove(tmpFilepath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief solve a small dense linear system in place by Gaussian elimination with partial pivoting
+     * @param a n x n matrix, row-major
+     * @param b right-hand side, receives the solution
+     * @return whether the system could be solved
+     */
+    static bool solve(double *a, double *b, int n) {
+        for (int col = 0; col < n; ++col) {
+            int pivot = col;
+            for (int row = col + 1; row < n; ++row)
+                if (std::fabs(a[row * n + col]) > std::fabs(a[pivot * n + col]))
+                    pivot = row;
+            if (std::fabs(a[pivot * n + col]) < 1e-300)
+                return false;
+            if (pivot != col) {
+                for (int k = 0; k < n; ++k)
+                    std::swap(a[col * n + k], a[pivot * n + k]);
+                std::swap(b[col], b[pivot]);
+            }
+            for (int row = col + 1; row < n; ++row) {
+                double factor = a[row * n + col] / a[col * n + col];
+                for (int k = col; k < n; ++k)
+                    a[row * n + k] -= factor * a[col * n + k];
+                b[row] -= factor * b[col];
+            }
+        }
+        for (int row = n - 1; row >= 0; --row) {
+            for (int k = row + 1; k < n; ++k)
+                b[row] -= a[row * n + k] * b[k];
+            b[row] /= a[row * n + row];
+        }
+        return true;
+    }
+
+    uint64_t ProbCutModel::fit(const std::vector<ProbCutSample> &samples, int minObservations, double *rmse, int *numPairs) {
+        // observations and sum of squared differences of each disc count and depth pair
+        struct Cell {
+            uint64_t count = 0;
+            double sumSquares = 0;
+        };
+        std::vector<Cell> cells(NUM_DISC_COUNTS * (MPC_DEPTH + 1) * (MPC_DEPTH + 1));
+        auto getCell = [&cells](int discCount, int shallow, int depth) -> Cell & {
+            return cells[((discCount - 4) * (MPC_DEPTH + 1) + shallow) * (MPC_DEPTH + 1) + depth];
+        };
+
+        for (auto &sample: samples) {
+            if (sample.discCount < 4 || sample.discCount > 64)
+                continue;
+            const int numValues = std::min<int>(sample.numValues, MPC_DEPTH + 1);
+            for (int d = 1; d < numValues; ++d) {
+                for (int s = 0; s < d; ++s) {
+                    auto &cell = getCell(sample.discCount, s, d);
+                    const double difference = sample.values[d] - sample.values[s];
+                    ++cell.count;
+                    cell.sumSquares += difference * difference;
+                }
+            }
+        }
+
+        struct Point {
+            int discCount, shallow, depth;
+            double sigma;
+            double weight;
+        };
+        std::vector<Point> points;
+        uint64_t numObservations = 0;
+        for (int discCount = 4; discCount <= 64; ++discCount) {
+            for (int d = 1; d <= MPC_DEPTH; ++d) {
+                for (int s = 0; s < d; ++s) {
+                    auto &cell = getCell(discCount, s, d);
+                    if (cell.count < (uint64_t)std::max(1, minObservations))
+                        continue;
+                    points.push_back({discCount, s, d, std::sqrt(cell.sumSquares / (double)cell.count),
+                                      (double)cell.count});
+                    numObservations += cell.count;
+                }
+            }
+        }
+        if (points.size() < NUM_COEFFICIENTS)
+            return 0;
+
+        auto getCost = [&points](const double *c) {
+            double cost = 0;
+            for (auto &p: points) {
+                double r = engine::get_sigma(c, get_x(c, p.discCount, p.shallow, p.depth)) - p.sigma;
+                cost += p.weight * r * r;
+            }
+            return cost;
+        };
+
+        // Levenberg-Marquardt on the weighted squared error
+        constexpr int N = NUM_COEFFICIENTS;
+        double c[N];
+        std::copy(this->coefficients, this->coefficients + N, c);
+        double cost = getCost(c);
+        double lambda = 1e-3;
+
+        for (int iteration = 0; iteration < 500 && lambda < 1e12; ++iteration) {
+            double jtj[N * N] = {0};
+            double jtr[N] = {0};
+            for (auto &p: points) {
+                const double a = (double)p.discCount / 64.0, b = (double)p.shallow / 60.0, e = (double)p.depth / 60.0;
+                const double x = get_x(c, p.discCount, p.shallow, p.depth);
+                const double slope = 3 * c[3] * x * x + 2 * c[4] * x + c[5];
+                const double r = engine::get_sigma(c, x) - p.sigma;
+                const double j[N] = {slope * a, slope * b, slope * e, x * x * x, x * x, x, 1};
+                for (int row = 0; row < N; ++row) {
+                    jtr[row] += p.weight * j[row] * r;
+                    for (int col = 0; col < N; ++col)
+                        jtj[row * N + col] += p.weight * j[row] * j[col];
+                }
+            }
+
+            // retry with more damping until a step lowers the cost
+            bool isImproved = false;
+            while (lambda < 1e12) {
+                double a[N * N], step[N], next[N];
+                std::copy(jtj, jtj + N * N, a);
+                for (int i = 0; i < N; ++i) {
+                    a[i * N + i] += lambda * std::max(jtj[i * N + i], 1e-12);
+                    step[i] = -jtr[i];
+                }
+                if (solve(a, step, N)) {
+                    for (int i = 0; i < N; ++i)
+                        next[i] = c[i] + step[i];
+                    double nextCost = getCost(next);
+                    if (std::isfinite(nextCost) && nextCost < cost) {
+                        isImproved = cost - nextCost > 1e-12 * cost;
+                        std::copy(next, next + N, c);
+                        cost = nextCost;
+                        lambda = std::max(lambda / 10, 1e-12);
+                        break;
+                    }
+                }
+                lambda *= 10;
+            }
+            if (!isImproved)
+                break;
+        }
+
+        std::copy(c, c + N, this->coefficients);
+        if (rmse != nullptr)
+            *rmse = std::sqrt(cost / (double)numObservations);
+        if (numPairs != nullptr)
+            *numPairs = (int)points.size();
+        return numObservations;
+    }
+
+    bool ProbCutModel::read_samples(const std::string &filepath, std::vector<ProbCutSample> &samples) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(filepath, error);
+        std::ifstream file(filepath, std::ios::binary);
+        if (error || !file.is_open()) {
+            std::cerr << "could not open ProbCut samples " << filepath << std::endl;
+            return false;
+        }
+
+        char magic[4];
+        uint32_t version = 0;
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char *>(&version), sizeof(version));
+        const auto headerSize = sizeof(magic) + sizeof(version);
+        if (!file || std::memcmp(magic, ProbCutSample::MAGIC, 4) != 0 || version != ProbCutSample::VERSION ||
+            (size - headerSize) % sizeof(ProbCutSample) != 0) {
+            std::cerr << "invalid ProbCut samples " << filepath << std::endl;
+            return false;
+        }
+
+        samples.resize((size - headerSize) / sizeof(ProbCutSample));
+        file.read(reinterpret_cast<char *>(samples.data()), (std::streamsize)(samples.size() * sizeof(ProbCutSample)));
+        if (!file) {
+            std::cerr << "could not read ProbCut samples " << filepath << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,91 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_PROBCUTMODEL_H
+#define OTHELLO_PROBCUTMODEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../Const.h"
+
+namespace engine {
+
+    /**
+     * @brief values of a midgame position searched to every depth from 0 up, written by
+     * Engine::collect_prob_cut_data. ProbCut is calibrated on the difference between any two of them.
+     */
+    struct ProbCutSample {
+        // a sample file is MAGIC and VERSION followed by the samples
+        static constexpr char MAGIC[4] = {'O', 'P', 'C', '1'};
+        static constexpr uint32_t VERSION = 1;
+
+        uint8_t discCount;
+        uint8_t numValues;              // values[d] is the value of the search to depth d, for d < numValues
+        int8_t values[MPC_DEPTH + 1];
+    };
+
+    /**
+     * @brief error model of ProbCut. The spread of (deep value - shallow value) is modelled as
+     *
+     *     sigma = d x^3 + e x^2 + f x + g,    x = a discs / 64 + b shallow / 60 + c depth / 60
+     *
+     * and the margin of a selectivity level is its t times sigma, with t the normal quantile of the level's
+     * confidence. The parameters are fitted by OthelloProbCut and read at startup by Engine::probcut_init.
+     */
+    struct ProbCutModel {
+        static constexpr int NUM_COEFFICIENTS = 7;
+        static constexpr char COEFFICIENT_NAMES[NUM_COEFFICIENTS] = {'a', 'b', 'c', 'd', 'e', 'f', 'g'};
+
+        // the parameters the engine used before they were fitted at runtime
+        double coefficients[NUM_COEFFICIENTS] = {
+                0.9006402774092823, -7.8988857964929275, 0.799688863608567, 1.05409818138701,
+                3.1602332178243904, 3.609493332834981, 2.602946546930604
+        };
+        double t[MAX_MPC_LEVEL + 1] = {1.13, 1.55, 1.81, 2.32, 2.57, 9.99};
+
+        /**
+         * @return the modelled standard deviation of (value at depth - value at shallow)
+         */
+        [[nodiscard]] double get_sigma(int discCount, int shallow, int depth) const;
+
+        /**
+         * @brief read a parameter file. Parameters the file doesn't set keep their value
+         * @param filepath: path of the parameter file
+         * @return whether the file was read
+         */
+        bool load(const std::string &filepath = PROBCUT_PARAMS_FILEPATH);
+
+        /**
+         * @brief write a parameter file
+         * @param filepath: path of the parameter file
+         * @param comment: written at the top of the file
+         * @return whether the file was written
+         */
+        [[nodiscard]] bool save(const std::string &filepath = PROBCUT_PARAMS_FILEPATH, const std::string &comment = "") const;
+
+        /**
+         * @brief fit the coefficients by weighted least squares, starting from the current ones. The root mean square
+         * of (deep value - shallow value) is measured for every disc count and depth pair, and the model is fitted to
+         * those measurements with Levenberg-Marquardt, weighting each by its number of observations.
+         * @param samples: the searched positions
+         * @param minObservations: disc count and depth pairs with fewer observations are left out
+         * @param rmse: receives the weighted root mean square error of the fit, in discs
+         * @param numPairs: receives the number of disc count and depth pairs fitted on
+         * @return number of observations fitted on, or 0 if there weren't enough to fit
+         */
+        uint64_t fit(const std::vector<ProbCutSample> &samples, int minObservations = 30, double *rmse = nullptr,
+                     int *numPairs = nullptr);
+
+        /**
+         * @brief read the samples written by Engine::collect_prob_cut_data
+         * @param filepath: path of the sample file
+         * @param samples: receives the samples
+         * @return whether the file was read
+         */
+        static bool read_samples(const std::string &filepath, std::vector<ProbCutSample> &samples);
+    };
+}
+
+#endif //OTHELLO_PROBCUTMODEL_H
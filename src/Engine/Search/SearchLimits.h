@@ -0,0 +1,158 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_SEARCHLIMITS_H
+#define OTHELLO_SEARCHLIMITS_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "../../Const.h"
+
+namespace engine {
+
+    /**
+     * @brief stop token and limits for a single search.
+     *
+     * The search polls should_stop() at every node. The stop flag is a relaxed atomic load, and the clock and node
+     * limits are only checked every SEARCH_POLL_INTERVAL nodes, so a search stops within microseconds of its deadline
+     * or of another thread calling stop(), without a timer thread.
+     */
+    class SearchLimits {
+    public:
+        static constexpr int64_t NO_DEADLINE = std::numeric_limits<int64_t>::max();
+        static constexpr long long NO_NODE_LIMIT = std::numeric_limits<long long>::max();
+        static constexpr double MAX_TIME_LIMIT = 9e9;  // seconds. Longer limits don't fit in int64_t nanoseconds
+
+        SearchLimits() = default;
+
+        /**
+         * @param maxTime: time limit in seconds. Infinite, negative or above MAX_TIME_LIMIT for no time limit
+         * @param maxDepth: maximum iterative deepening depth
+         * @param maxNodes: maximum number of nodes to search
+         */
+        explicit SearchLimits(double maxTime, int maxDepth = MAX_DEPTH, long long maxNodes = NO_NODE_LIMIT) :
+                maxDepth(maxDepth),
+                maxNodes(maxNodes) {
+            this->set_time_limit(maxTime);
+        }
+
+        SearchLimits(const SearchLimits&) = delete;
+        SearchLimits& operator=(const SearchLimits&) = delete;
+
+        /**
+         * @brief clear the stop flag and all limits before a new search
+         */
+        inline void reset() {
+            this->deadline.store(NO_DEADLINE, std::memory_order_relaxed);
+            this->maxDepth = MAX_DEPTH;
+            this->maxNodes = NO_NODE_LIMIT;
+            this->nextPoll = 0;
+            this->stopAtWLD = false;
+            this->stopped.store(false, std::memory_order_release);
+        }
+
+        /**
+         * @brief request the search to stop. Safe to call from any thread.
+         */
+        inline void stop() {
+            this->stopped.store(true, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief set the deadline relative to now. Safe to call from any thread while the search is running.
+         * @param seconds: time limit in seconds. Infinite, negative or above MAX_TIME_LIMIT for no time limit
+         */
+        inline void set_time_limit(double seconds) {
+            if (!std::isfinite(seconds) || seconds < 0 || seconds > MAX_TIME_LIMIT) {
+                this->deadline.store(NO_DEADLINE, std::memory_order_relaxed);
+                return;
+            }
+            this->deadline.store(SearchLimits::now() + (int64_t)(seconds * 1e9), std::memory_order_relaxed);
+        }
+
+        inline void set_depth_limit(int depth) {
+            this->maxDepth = depth;
+        }
+
+        inline void set_node_limit(long long numNodes) {
+            this->maxNodes = numNodes;
+        }
+
+        /**
+         * @brief end the search once the outcome is proven, instead of going on to the exact score
+         */
+        inline void set_stop_at_wld(bool stop) {
+            this->stopAtWLD = stop;
+        }
+
+        [[nodiscard]] inline bool is_stop_at_wld() const {
+            return this->stopAtWLD;
+        }
+
+        [[nodiscard]] inline int get_depth_limit() const {
+            return this->maxDepth;
+        }
+
+        [[nodiscard]] inline bool has_deadline() const {
+            return this->deadline.load(std::memory_order_relaxed) != NO_DEADLINE;
+        }
+
+        /**
+         * @return seconds until the deadline, or infinity if there is none
+         */
+        [[nodiscard]] inline double get_time_left() const {
+            auto d = this->deadline.load(std::memory_order_relaxed);
+            if (d == NO_DEADLINE)
+                return std::numeric_limits<double>::infinity();
+            return (double)(d - SearchLimits::now()) * 1e-9;
+        }
+
+        [[nodiscard]] inline bool is_stopped() const {
+            return this->stopped.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief poll the limits. Called at every search node; only reads the clock every SEARCH_POLL_INTERVAL nodes.
+         * @param numNodes: number of nodes searched so far
+         * @return whether the search should stop
+         */
+        inline bool should_stop(long long numNodes) {
+            if (this->stopped.load(std::memory_order_relaxed))
+                return true;
+            if (numNodes < this->nextPoll)
+                return false;
+            this->nextPoll = numNodes + SEARCH_POLL_INTERVAL;
+            return this->check_now(numNodes);
+        }
+
+        /**
+         * @brief check the deadline and node limit immediately
+         * @param numNodes: number of nodes searched so far
+         * @return whether the search should stop
+         */
+        inline bool check_now(long long numNodes) {
+            if (numNodes >= this->maxNodes || SearchLimits::now() >= this->deadline.load(std::memory_order_relaxed))
+                this->stop();
+            return this->is_stopped();
+        }
+
+    private:
+        static inline int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        std::atomic<bool> stopped = false;
+        std::atomic<int64_t> deadline = NO_DEADLINE;  // steady clock time in nanoseconds
+        int maxDepth = MAX_DEPTH;
+        long long maxNodes = NO_NODE_LIMIT;
+        bool stopAtWLD = false;
+        long long nextPoll = 0;  // node count at which to next read the clock. Only touched by the searching thread
+    };
+}
+
+#endif //OTHELLO_SEARCHLIMITS_H
@@ -0,0 +1,113 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_SEARCHOPTIONS_H
+#define OTHELLO_SEARCHOPTIONS_H
+
+#include <algorithm>
+#include <string>
+#include "../../Const.h"
+
+namespace engine {
+
+    /**
+     * @brief search features that can be switched at runtime, so that one binary can compare configurations.
+     * The defaults are the switches in Const.h.
+     */
+    struct SearchOptions {
+        bool useMPC = USE_MPC;       // ProbCut
+        bool useETC = USE_ETC;       // enhanced transposition cutoffs
+        bool lockTT = LOCK_TT;       // lock transposition table entries, for tables shared between threads
+        int mpcDepth = MPC_DEPTH;    // deepest node ProbCut is tried at, at most MPC_DEPTH
+        int etcDepth = ETC_DEPTH;    // shallowest node ETC is tried at
+
+        /**
+         * @brief set an option from its command line name and value, like "mpc" and "off"
+         * @param name: mpc, etc, lock-tt, mpc-depth or etc-depth
+         * @param value: on or off for switches, a number for depths
+         * @return whether the name and value were valid
+         */
+        bool set(const std::string &name, const std::string &value) {
+            if (name == "mpc-depth" || name == "etc-depth") {
+                try {
+                    auto depth = std::stoi(value);
+                    if (name == "mpc-depth")
+                        this->mpcDepth = std::clamp(depth, 0, MPC_DEPTH);
+                    else
+                        this->etcDepth = std::max(depth, 0);
+                    return true;
+                } catch (const std::exception &) {
+                    return false;
+                }
+            }
+
+            bool isOn = value == "on" || value == "true" || value == "1";
+            if (!isOn && value != "off" && value != "false" && value != "0")
+                return false;
+            if (name == "mpc")
+                this->useMPC = isOn;
+            else if (name == "etc")
+                this->useETC = isOn;
+            else if (name == "lock-tt")
+                this->lockTT = isOn;
+            else
+                return false;
+            return true;
+        }
+
+        [[nodiscard]] std::string to_string() const {
+            return std::string("mpc ") + (this->useMPC ? "on" : "off") + " (depth " + std::to_string(this->mpcDepth) +
+                   "), etc " + (this->useETC ? "on" : "off") + " (depth " + std::to_string(this->etcDepth) +
+                   "), lock-tt " + (this->lockTT ? "on" : "off");
+        }
+    };
+
+    /**
+     * @brief the switches of SearchOptions as compile-time constants. The search functions are templates on a policy,
+     * so a disabled feature is compiled out of the search rather than tested at every node.
+     */
+    template<bool MPC, bool ETC, bool LOCK>
+    struct SearchPolicy {
+        static constexpr bool useMPC = MPC;
+        static constexpr bool useETC = ETC;
+        static constexpr bool lockTT = LOCK;
+    };
+
+    /**
+     * @brief call function.template operator()<Policy>() with the policy matching the options. Searches dispatch here
+     * once, at their root.
+     * @param options: the runtime options
+     * @param function: a lambda templated on the policy, like []<typename Policy>() { ... }
+     * @return what the function returns
+     */
+    template<typename Function>
+    inline decltype(auto) dispatch_search_policy(const SearchOptions &options, Function &&function) {
+        auto withLock = [&]<bool MPC, bool ETC>() -> decltype(auto) {
+            if (options.lockTT)
+                return function.template operator()<SearchPolicy<MPC, ETC, true>>();
+            return function.template operator()<SearchPolicy<MPC, ETC, false>>();
+        };
+        auto withETC = [&]<bool MPC>() -> decltype(auto) {
+            if (options.useETC)
+                return withLock.template operator()<MPC, true>();
+            return withLock.template operator()<MPC, false>();
+        };
+        if (options.useMPC)
+            return withETC.template operator()<true>();
+        return withETC.template operator()<false>();
+    }
+}
+
+// instantiate a search function for every policy: INSTANTIATE is a variadic macro taking the policy type
+#define INSTANTIATE_SEARCH_POLICIES(INSTANTIATE)                   \
+    INSTANTIATE(engine::SearchPolicy<false, false, false>)         \
+    INSTANTIATE(engine::SearchPolicy<false, false, true>)          \
+    INSTANTIATE(engine::SearchPolicy<false, true, false>)          \
+    INSTANTIATE(engine::SearchPolicy<false, true, true>)           \
+    INSTANTIATE(engine::SearchPolicy<true, false, false>)          \
+    INSTANTIATE(engine::SearchPolicy<true, false, true>)           \
+    INSTANTIATE(engine::SearchPolicy<true, true, false>)           \
+    INSTANTIATE(engine::SearchPolicy<true, true, true>)
+
+#endif //OTHELLO_SEARCHOPTIONS_H
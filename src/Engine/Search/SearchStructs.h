@@ -8,8 +8,12 @@
 #include "../Evaluation/StaticEvaluations.h"
 #include "../../Game/Game.h"
 #include "../Evaluation/Evaluation.h"
-#include <thread>
-#include <QThread>
+#include "SearchTelemetry.h"
+#include "SearchLimits.h"
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 
 namespace engine {
 
@@ -25,6 +29,24 @@ namespace engine {
         uint64_t legalMask = LEGAL_UNDEFINED;
     };
 
+    /**
+     * @brief a root move, kept across iterations of iterative deepening to order the root
+     */
+    struct RootMove {
+        Move move = PASS;
+        uint64_t legalMask = LEGAL_UNDEFINED;  // legal moves of the opponent after the move
+        long long numNodes = 0;                // size of the move's subtree in the last iteration that searched it
+    };
+
+    /**
+     * @brief what the value of a search is worth
+     */
+    enum class SearchMode {
+        MIDGAME,  // heuristic value of a depth-limited search
+        WLD,      // proven win, loss or draw: only the sign of the value is exact
+        EXACT     // exact final disc difference
+    };
+
     struct SearchNode {
         explicit SearchNode(const Board &board) :
                 board(board),
@@ -98,6 +120,7 @@ namespace engine {
         Board board;                    // board
         uint_fast8_t parity = 0;        // parity of the node
         bool isEndgame = false;         // whether the node is an endgame node
+        SearchMode mode = SearchMode::MIDGAME;  // what the value of the search is worth
 
         std::chrono::time_point<std::chrono::high_resolution_clock> startTime;  // time the search started
         std::chrono::time_point<std::chrono::high_resolution_clock> endTime;    // time the search ended. will be less than start time if the search is not finished
@@ -107,6 +130,10 @@ namespace engine {
         long long numProbCuts = 0;  // number of nodes searched
         long long numETCCuts = 0;  // number of nodes searched
         eval::EvaluationFeatures evalFeatures;
+
+        #if COLLECT_TELEMETRY
+            SearchTelemetry telemetry;  // per-iteration search statistics
+        #endif
     };
 
     struct SearchResult {
@@ -124,100 +151,230 @@ namespace engine {
                 move(searchNode->move),
                 value(searchNode->value),
                 depth(searchNode->depth),
+                mode(searchNode->mode),
+                rootDiscCount(searchNode->rootDiscCount),
                 numNodes(searchNode->numNodes),
                 numMPCCuts(searchNode->numProbCuts),
                 numETCCuts(searchNode->numETCCuts),
-                nps(searchNode->numNodes * 1000 / searchNode->get_duration()),
-                duration(searchNode->get_duration()) {}
+                nps(searchNode->numNodes * 1000 / std::max(1LL, searchNode->get_duration())),
+                duration(searchNode->get_duration()) {
+            TELEMETRY(this->telemetry = searchNode->telemetry.iterations;)
+        }
 
         Move move = PASS;        // the best move to play from the position
         int value = 0;           // value of the current state
         int depth = 0;           // maximum search depth reached
+        SearchMode mode = SearchMode::MIDGAME;  // what the value is worth
+        int rootDiscCount = 4;   // number of discs on the board at the root node
         long long numNodes = 0;  // number of nodes searched
         long long nps = 0;       // nodes per second
         long long duration = 0;  // duration of the search in milliseconds
         long long numMPCCuts = 0;  // number of cutoffs with mpc
         long long numETCCuts = 0;  // number of cutoffs with etc
+
+        #if COLLECT_TELEMETRY
+            std::vector<IterationTelemetry> telemetry;  // per-iteration search statistics
+        #endif
     };
 
-    struct SearchTask {
-        SearchTask() = default;
+    /**
+     * @brief score and principal variation of one root move, as returned by Engine::analyze
+     */
+    struct AnalysisLine {
+        Move move = PASS;
+        int value = SCORE_UNDEFINED;
+        int depth = 0;             // depth of the iteration that scored the move
+        bool isExact = false;      // false if value is only an upper bound
+        std::vector<Move> pv;      // principal variation, starting with move
+    };
 
-        explicit SearchTask(SearchNode *search, bool *running = nullptr, bool *stopped = nullptr) :
-                search(search),
-                running(running == nullptr ? new bool(false) : running),
-                completed(stopped == nullptr ? new bool(true) : stopped) {}
+    /** called with the ranked lines after every completed iteration of Engine::analyze */
+    using AnalysisCallback = std::function<void(const std::vector<AnalysisLine>&)>;
 
-        explicit SearchTask(const Game &game, bool *running = nullptr, bool *stopped = nullptr) :
-                search( new SearchNode(game.get_bitboard())),
-                running(running == nullptr ? new bool(false) : running),
-                completed(stopped == nullptr ? new bool(true) : stopped) {}
+    /** called with the result of each completed iteration of a search task */
+    using SearchProgressCallback = std::function<void(const SearchResult &result)>;
 
+    /** called when a run of a search task ends, with its result and its id from SearchTask::get_run_id */
+    using SearchCompletionCallback = std::function<void(const SearchResult &result, int runId)>;
+
+    /**
+     * @brief a search that runs in the background, and is restarted by the engine on each new position.
+     *
+     * Each run reports its progress and result through callbacks, which are called on the search thread, and through
+     * a future that is ready once the run has ended. Nothing here blocks the caller: stop() only flags the run, and a
+     * new run is queued on the engine's search thread, where it waits for the previous one to end before it touches
+     * the search node. The task owns the node, and must outlive the runs it schedules.
+     */
+    struct SearchTask {
+        /**
+         * @brief one run of the task, as scheduled by the engine
+         */
+        struct Run {
+            int id = 0;
+            std::shared_ptr<SearchLimits> limits;
+            std::shared_future<SearchResult> previous;  // future of the run this one replaces
+            std::shared_ptr<std::promise<SearchResult>> promise;
+        };
+
+        explicit SearchTask(std::unique_ptr<SearchNode> search) :
+                search(std::move(search)) {}
+
+        explicit SearchTask(const Game &game) :
+                search(std::make_unique<SearchNode>(game.get_bitboard())) {}
+
+        SearchTask(const SearchTask&) = delete;
+        SearchTask& operator=(const SearchTask&) = delete;
+
+        /**
+         * @brief stop the current run and wait for it, since it uses the search node
+         */
         ~SearchTask() {
-            delete this->running;
-            delete this->search;
-            delete this->completed;
+            auto future = this->stop();
+            if (future.valid())
+                future.wait();
         }
 
+        /**
+         * @return the result in the search node. Only consistent when no run is in progress
+         */
         [[nodiscard]] inline SearchResult get_result() const {
-            return SearchResult(this->search);
+            return SearchResult(this->search.get());
         }
 
-        inline void stop_after(double duration) const {
-            std::thread([this, duration]() {
-                std::this_thread::sleep_for(std::chrono::milliseconds((long long) (duration * 1000)));
-                *this->running = false;
-            }).detach();
+        /**
+         * @brief set the deadline of the current run
+         * @param duration: seconds from now
+         */
+        inline void stop_after(double duration) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->limits->set_time_limit(duration);
         }
 
-        inline void stop() const {
-            if (*this->running) {
-                *this->running = false;
-                this->search->stop();
-            }
+        /**
+         * @brief stop the current run without waiting for it
+         * @return a future that is ready once the run has ended
+         */
+        inline std::shared_future<SearchResult> stop() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->limits->stop();
+            this->running = false;
+            return this->future;
         }
 
-        inline void complete() const {
-            if (!*this->running) {
-                *this->completed = true;
-            }
+        /**
+         * @return a future that is ready once the current run has ended
+         */
+        inline std::shared_future<SearchResult> get_future() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            return this->future;
         }
 
-        inline void start() const {
-            if (!*this->running && *this->completed) {
-                *this->running = true;
-                *this->completed = false;
-                this->search->start();
-            } else {
-                std::cerr << "Search already running" << std::endl;
-            }
+        /**
+         * @return the id of the current run, which is passed to the completion callback when it ends
+         */
+        inline int get_run_id() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            return this->runId;
         }
 
-        inline void pass() const {
-            this->search->pass();
+        /**
+         * @brief search a new position from the next run on. The current run keeps searching its own position.
+         */
+        inline void set_board(const Board& board) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->nextBoard = board;
+            this->hasNextBoard = true;
         }
 
-        inline void set_board(const Board& board) const {
-            auto value = this->search->value;
-            *this->search = SearchNode(board);
-            this->search->value = -value;
+        inline void set_progress_callback(SearchProgressCallback callback) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->onProgress = std::move(callback);
         }
 
-        inline void wait_for_completion(int dt = 100) const {
-            while (this->search->move == MOVE_UNDEFINED) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(dt));
+        inline void set_completion_callback(SearchCompletionCallback callback) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->onCompletion = std::move(callback);
+        }
+
+        /**
+         * @brief replace the current run with a new one, and stop the current run. Called by the engine.
+         * @param maxTime: time limit in seconds
+         * @return the new run, to be started on its own thread
+         */
+        inline Run schedule(double maxTime) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->limits->stop();
+
+            Run run{++this->runId, std::make_shared<SearchLimits>(maxTime), this->future,
+                    std::make_shared<std::promise<SearchResult>>()};
+            this->limits = run.limits;
+            this->future = run.promise->get_future().share();
+            this->running = true;
+            return run;
+        }
+
+        /**
+         * @brief wait for the previous run to end, then start a run. Called on the search thread.
+         * @return whether the run should search. False if it was stopped or replaced before it started
+         */
+        inline bool begin(const Run &run) {
+            if (run.previous.valid())
+                run.previous.wait();
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (run.id != this->runId || run.limits->is_stopped())
+                return false;
+
+            if (this->hasNextBoard) {
+                auto value = this->search->value;
+                *this->search = SearchNode(this->nextBoard);
+                this->search->value = -value;
+                this->hasNextBoard = false;
             }
+            this->search->start();
+            return true;
         }
 
-        inline void qt_wait_for_completion(int dt = 100) const {
-            while (this->search->move == MOVE_UNDEFINED) {
-                QThread::msleep(dt);
+        /**
+         * @brief report a completed iteration of a run. Called on the search thread. Runs that were stopped or
+         * replaced don't report, and the callback is called with the task locked, so once stop() returns the callback
+         * never sees the old run again. The callback must not call the task.
+         */
+        inline void report(const Run &run, const SearchResult &result) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (run.id == this->runId && this->running && this->onProgress)
+                this->onProgress(result);
+        }
+
+        /**
+         * @brief end a run and publish its result. Called on the search thread.
+         */
+        inline void finish(const Run &run, const SearchResult &result) {
+            SearchCompletionCallback callback;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->search->stop();
+                if (run.id == this->runId)
+                    this->running = false;
+                callback = this->onCompletion;
             }
+            if (callback)
+                callback(result, run.id);
+            run.promise->set_value(result);
         }
 
-        SearchNode *search = nullptr;
-        bool *running = nullptr;
-        bool *completed = nullptr;
+        std::unique_ptr<SearchNode> search;  // only touched by the thread of the current run
+        std::atomic<bool> running = false;  // whether the current run has been scheduled and not stopped or finished
+
+    private:
+        std::mutex mutex;
+        std::shared_ptr<SearchLimits> limits = std::make_shared<SearchLimits>();
+        std::shared_future<SearchResult> future;  // of the current run. Invalid until the first run
+        int runId = 0;
+        Board nextBoard;
+        bool hasNextBoard = false;
+        SearchProgressCallback onProgress;
+        SearchCompletionCallback onCompletion;
     };
 }
 
@@ -0,0 +1,120 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_SEARCHTELEMETRY_H
+#define OTHELLO_SEARCHTELEMETRY_H
+
+#include <chrono>
+#include <ostream>
+#include <vector>
+#include "../../Const.h"
+
+// wraps statements that only exist to collect search telemetry, so that they compile to nothing when it's disabled
+#if COLLECT_TELEMETRY
+    #define TELEMETRY(statement) statement
+#else
+    #define TELEMETRY(statement)
+#endif
+
+namespace engine {
+
+    /**
+     * @brief search statistics for a single iteration of iterative deepening
+     */
+    struct IterationTelemetry {
+        int depth = 0;                      // nominal search depth
+        int selectivity = 0;                // selectivity level of the root
+        int value = 0;                      // value returned by the iteration
+        int move = I_PASS;                  // best move returned by the iteration
+        bool completed = false;             // false if the iteration was interrupted
+
+        long long numNodes = 0;             // nodes searched
+        long long numEndNodes = 0;          // nodes searched by the endgame solver
+        long long numTTProbes = 0;          // transposition table lookups
+        long long numTTHits = 0;            // lookups that found the position
+        long long numTTStores = 0;          // transposition table writes
+        long long numTTOverwrites = 0;      // writes that replaced a different position
+        long long numCutNodes = 0;          // nodes that failed high
+        long long numFirstMoveCuts = 0;     // nodes that failed high on the first move searched
+        long long numETCCuts = 0;           // enhanced transposition cutoffs
+        long long numProbCutAttempts[MAX_MPC_LEVEL + 1] = {0};   // shallow searches launched, by selectivity level
+        long long numProbCutSuccesses[MAX_MPC_LEVEL + 1] = {0};  // shallow searches that cut, by selectivity level
+
+        double branchingFactor = 0;         // nodes relative to the previous iteration
+        long long duration = 0;             // time spent in the iteration in microseconds
+
+        /**
+         * @brief write this iteration as a single line JSON object
+         * @param os: output stream
+         */
+        void write_json(std::ostream& os) const {
+            os << "{\"depth\":" << depth << ",\"selectivity\":" << selectivity
+               << ",\"value\":" << value << ",\"move\":" << move
+               << ",\"completed\":" << (completed ? "true" : "false")
+               << ",\"nodes\":" << numNodes << ",\"end_nodes\":" << numEndNodes
+               << ",\"tt_probes\":" << numTTProbes << ",\"tt_hits\":" << numTTHits
+               << ",\"tt_stores\":" << numTTStores << ",\"tt_overwrites\":" << numTTOverwrites
+               << ",\"cut_nodes\":" << numCutNodes << ",\"first_move_cuts\":" << numFirstMoveCuts
+               << ",\"first_move_cut_rate\":" << (numCutNodes ? (double)numFirstMoveCuts / (double)numCutNodes : 0.0)
+               << ",\"etc_cuts\":" << numETCCuts;
+
+            os << ",\"probcut_attempts\":[";
+            for (int i = 0; i <= MAX_MPC_LEVEL; ++i)
+                os << (i ? "," : "") << numProbCutAttempts[i];
+            os << "],\"probcut_successes\":[";
+            for (int i = 0; i <= MAX_MPC_LEVEL; ++i)
+                os << (i ? "," : "") << numProbCutSuccesses[i];
+
+            os << "],\"ebf\":" << branchingFactor << ",\"time_us\":" << duration << '}';
+        }
+    };
+
+    /**
+     * @brief counters filled in during a search. Only present in search nodes when COLLECT_TELEMETRY is set.
+     */
+    struct SearchTelemetry {
+        /**
+         * @brief reset the counters at the start of an iteration
+         * @param numNodes: node count of the search node when the iteration starts
+         * @param numETCCuts: ETC cut count of the search node when the iteration starts
+         */
+        inline void begin_iteration(long long numNodes, long long numETCCuts) {
+            this->current = IterationTelemetry();
+            this->startNodes = numNodes;
+            this->startETCCuts = numETCCuts;
+            this->startTime = std::chrono::steady_clock::now();
+        }
+
+        /**
+         * @brief record the counters of the iteration that just finished
+         */
+        inline void end_iteration(int depth, int selectivity, int value, int move, bool completed,
+                                  long long numNodes, long long numETCCuts) {
+            this->current.depth = depth;
+            this->current.selectivity = selectivity;
+            this->current.value = value;
+            this->current.move = move;
+            this->current.completed = completed;
+            this->current.numNodes = numNodes - this->startNodes;
+            this->current.numETCCuts = numETCCuts - this->startETCCuts;
+            this->current.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - this->startTime).count();
+
+            if (!this->iterations.empty() && this->iterations.back().numNodes > 0)
+                this->current.branchingFactor = (double)this->current.numNodes / (double)this->iterations.back().numNodes;
+
+            this->iterations.push_back(this->current);
+        }
+
+        std::vector<IterationTelemetry> iterations;
+        IterationTelemetry current;
+
+    private:
+        long long startNodes = 0;
+        long long startETCCuts = 0;
+        std::chrono::steady_clock::time_point startTime;
+    };
+}
+
+#endif //OTHELLO_SEARCHTELEMETRY_H
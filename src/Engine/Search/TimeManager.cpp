@@ -0,0 +1,114 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "TimeManager.h"
+#include <algorithm>
+#include <cmath>
+
+namespace engine {
+    constexpr double CLOCK_SAFETY_MARGIN = 0.05;   // seconds never spent, to cover move latency
+    constexpr double SOLVE_RESERVE = 0.2;          // fraction of the clock held back for the exact solve
+    constexpr double SOLVE_TIME_FRACTION = 0.6;    // fraction of the clock spent on the exact solve
+    constexpr double INCREMENT_USAGE = 0.9;        // fraction of the increment spent on every move
+    constexpr double HARD_LIMIT_FACTOR = 3.0;      // hard limit relative to the soft limit
+    constexpr double MAX_MOVE_FRACTION = 0.3;      // maximum fraction of the clock spent on one midgame move
+
+    constexpr double MIDGAME_PEAK = 36;            // disc count that gets the most time
+    constexpr double MIDGAME_WIDTH = 12;
+    constexpr double MIDGAME_BONUS = 1.0;          // extra time at the peak, relative to the opening
+
+    constexpr int STABLE_ITERATIONS = 4;           // iterations with the same best move before stopping early
+    constexpr double STABLE_TIME_FRACTION = 0.3;   // fraction of the soft limit to spend before stopping early
+    constexpr double MIN_BRANCHING_FACTOR = 1.5;
+    constexpr double EXACT_SOLVE_FACTOR = 3.0;     // cost of the exact solve relative to the WLD search
+
+    /**
+     * @brief relative amount of time to spend on a move, peaking in the midgame
+     */
+    static inline double phase_weight(int discCount) {
+        double x = ((double)discCount - MIDGAME_PEAK) / MIDGAME_WIDTH;
+        return 1 + MIDGAME_BONUS * std::exp(-x * x);
+    }
+
+    TimeManager::TimeManager(const GameClock &clock, int discCount) {
+        auto numEmpty = 64 - discCount;
+        auto available = std::max(0.0, clock.timeLeft - std::min(CLOCK_SAFETY_MARGIN, 0.1 * clock.timeLeft));
+
+        if (numEmpty <= PERFECT_SEARCH_DEPTH) {
+            // nothing left to save time for after the solve
+            this->solving = true;
+            this->softLimit = std::min(available, available * SOLVE_TIME_FRACTION + clock.increment * INCREMENT_USAGE);
+            this->hardLimit = this->softLimit;
+            return;
+        }
+
+        // share the clock out between our remaining moves before the solve, weighted by game phase
+        auto budget = available * (1 - SOLVE_RESERVE);
+        double totalWeight = 0;
+        for (int d = discCount; d < 64 - PERFECT_SEARCH_DEPTH; d += 2)
+            totalWeight += phase_weight(d);
+
+        this->softLimit = budget * phase_weight(discCount) / totalWeight + clock.increment * INCREMENT_USAGE;
+        this->hardLimit = std::min(this->softLimit * HARD_LIMIT_FACTOR,
+                                   available * MAX_MOVE_FRACTION + clock.increment * INCREMENT_USAGE);
+        this->hardLimit = std::min(this->hardLimit, available);
+        this->softLimit = std::min(this->softLimit, this->hardLimit);
+    }
+
+    void TimeManager::start(SearchLimits &limits) {
+        this->startTime = std::chrono::steady_clock::now();
+        this->iterationStartTime = this->startTime;
+        limits.set_time_limit(this->hardLimit);
+    }
+
+    bool TimeManager::start_next_iteration(int move, long long numNodes) {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = this->get_elapsed(now);
+        auto iterationTime = std::chrono::duration<double>(now - this->iterationStartTime).count();
+        auto iterationNodes = numNodes - this->lastTotalNodes;
+
+        // smooth the branching factor, since it alternates between odd and even depths
+        if (this->lastIterationNodes > 0 && iterationNodes > 0) {
+            auto b = (double)iterationNodes / (double)this->lastIterationNodes;
+            this->branchingFactor = this->branchingFactor > 0 ? std::sqrt(this->branchingFactor * b) : b;
+        }
+        this->lastIterationNodes = iterationNodes;
+        this->lastTotalNodes = numNodes;
+        this->iterationStartTime = now;
+
+        if (move == this->bestMove) {
+            ++this->numStableIterations;
+        } else {
+            this->bestMove = move;
+            this->numStableIterations = 0;
+        }
+
+        // the exact solve is only useful if it finishes, so let it run to the hard limit
+        if (this->solving)
+            return elapsed < this->hardLimit;
+
+        if (elapsed >= this->softLimit)
+            return false;
+        if (this->numStableIterations >= STABLE_ITERATIONS && elapsed >= this->softLimit * STABLE_TIME_FRACTION)
+            return false;
+
+        // don't start an iteration that is not expected to finish in time
+        auto predicted = iterationTime * std::max(this->branchingFactor, MIN_BRANCHING_FACTOR);
+        return elapsed + predicted <= this->softLimit;
+    }
+
+    bool TimeManager::start_exact_solve(int move, long long numNodes) {
+        auto now = std::chrono::steady_clock::now();
+        auto wldTime = std::chrono::duration<double>(now - this->iterationStartTime).count();
+        if (!this->start_next_iteration(move, numNodes))
+            return false;
+
+        auto limit = this->solving ? this->hardLimit : this->softLimit;
+        return this->get_elapsed(now) + wldTime * EXACT_SOLVE_FACTOR <= limit;
+    }
+
+    double TimeManager::get_elapsed(std::chrono::steady_clock::time_point time) const {
+        return std::chrono::duration<double>(time - this->startTime).count();
+    }
+}
@@ -0,0 +1,89 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_TIMEMANAGER_H
+#define OTHELLO_TIMEMANAGER_H
+
+#include <chrono>
+#include "SearchLimits.h"
+
+namespace engine {
+
+    /**
+     * @brief time control of the side to move
+     */
+    struct GameClock {
+        double timeLeft = 0;   // seconds left on the clock
+        double increment = 0;  // seconds added to the clock after each move
+    };
+
+    /**
+     * @brief decides how long to think about a move under a game clock.
+     *
+     * Each move gets a share of the clock weighted towards the midgame, with a reserve held back for the exact solve.
+     * The soft limit is checked between iterations: iterative deepening stops early once the best move has been stable
+     * for several iterations, or when the next iteration is predicted (from the observed branching factor) to overrun
+     * the soft limit. The hard limit is the deadline of the search itself. Once the position is within
+     * PERFECT_SEARCH_DEPTH empties, most of the remaining clock goes to the exact solve.
+     */
+    class TimeManager {
+    public:
+        /**
+         * @param clock: clock of the side to move
+         * @param discCount: number of discs on the board
+         */
+        TimeManager(const GameClock &clock, int discCount);
+
+        /**
+         * @brief start the clock and set the hard deadline on the search limits
+         * @param limits: limits of the search about to start
+         */
+        void start(SearchLimits &limits);
+
+        /**
+         * @brief call after each completed iteration of iterative deepening
+         * @param move: best move found by the iteration
+         * @param numNodes: total nodes searched so far
+         * @return whether the next iteration should be started
+         */
+        bool start_next_iteration(int move, long long numNodes);
+
+        /**
+         * @brief call after the outcome of the position has been proven
+         * @param move: best move found by the WLD search
+         * @param numNodes: total nodes searched so far
+         * @return whether the exact solve is expected to finish in time. If not, the search should stop at the outcome
+         */
+        bool start_exact_solve(int move, long long numNodes);
+
+        [[nodiscard]] inline double get_soft_limit() const {
+            return this->softLimit;
+        }
+
+        [[nodiscard]] inline double get_hard_limit() const {
+            return this->hardLimit;
+        }
+
+        [[nodiscard]] inline bool is_solving() const {
+            return this->solving;
+        }
+
+    private:
+        [[nodiscard]] double get_elapsed(std::chrono::steady_clock::time_point time) const;
+
+        double softLimit = 0;   // seconds after which no new iteration is started
+        double hardLimit = 0;   // seconds after which the search is stopped
+        bool solving = false;   // whether the exact solve is in reach
+
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point iterationStartTime;
+        long long lastIterationNodes = 0;
+        long long lastTotalNodes = 0;
+        double branchingFactor = 0;
+        int bestMove = -1;
+        int numStableIterations = 0;
+    };
+}
+
+#endif //OTHELLO_TIMEMANAGER_H
@@ -2,6 +2,7 @@
 // Created by Benjamin Lee on 2/28/24.
 //
 #include "TranspositionTable.h"
+#include <algorithm>
 #include <random>
 #include <fstream>
 #include <sstream>
@@ -9,8 +10,11 @@
 namespace engine {
     uint32_t TranspositionTable::HASH_KEYS[8][65536] = {0};
 
-    TranspositionTable::TranspositionTable() {
-        this->table = new HashEntry[1ULL << HASH_BITS];
+    TranspositionTable::TranspositionTable(int numHashBits) {
+        numHashBits = std::clamp(numHashBits, 1, HASH_BITS);
+        this->numEntries = (size_t)1 << numHashBits;
+        this->hashMask = (uint32_t)(this->numEntries - 1);
+        this->table = new HashEntry[this->numEntries];
     }
 
     int TranspositionTable::init_hash() {
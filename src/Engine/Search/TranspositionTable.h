@@ -193,19 +193,20 @@ namespace engine {
         }
     };
 
+    // loads and stores lock the entry they access if IsLocked, which the search takes from SearchOptions::lockTT
     class TranspositionTable {
     public:
         /*
-         * @param hashSize: number of bits in the hash key
+         * @param numHashBits: number of bits in the index, at most HASH_BITS. The table has 2^numHashBits entries
          */
-        TranspositionTable();
+        explicit TranspositionTable(int numHashBits = HASH_BITS);
 
         ~TranspositionTable() {
             delete[] this->table;
         }
 
         inline void clear() {
-            for (int i = 0; i < (1UL << HASH_BITS); ++i)
+            for (size_t i = 0; i < this->numEntries; ++i)
                 this->table[i].reset();
         }
 
@@ -215,20 +216,20 @@ namespace engine {
          *
          * (This is a great name for a function)
          *
+         * @tparam IsLocked: whether to lock the entries, for tables shared between threads
          * @param overflowReduction: the amount to decrease the age of all entries by if the age is 255
          */
+        template<bool IsLocked = LOCK_TT>
         inline void happy_birthday(uint8_t overflowReduction = 128) {
             if (this->age == 255) {
-                for (int i = 0; i < (1UL << HASH_BITS); ++i) {
-                    #if LOCK_TT
+                for (size_t i = 0; i < this->numEntries; ++i) {
+                    if constexpr (IsLocked)
                         this->table[i].lock.lock();
-                    #endif
 
                     this->table[i].data.decrease_age(overflowReduction);
 
-                    #if LOCK_TT
+                    if constexpr (IsLocked)
                         this->table[i].lock.unlock();
-                    #endif
                 }
                 this->age -= overflowReduction;
             }
@@ -246,19 +247,20 @@ namespace engine {
          * @param move: best move at the node
          * @param running: whether the search was still running
          */
+        template<bool IsLocked = LOCK_TT>
         inline void
         store(SearchNode *searchNode, uint32_t hash, int depth, int alpha, int beta, int value, uint8_t move) {
-            uint64_t index = hash & HASH_MASK;
+            uint64_t index = hash & this->hashMask;
             HashEntry *entry = &this->table[index];
 
-            #if LOCK_TT
+            if constexpr (IsLocked)
                 entry->lock.lock();
-            #endif
 
             auto currentPriority = entry->data.get_write_priority();
             auto newPriority = get_write_priority(this->age, depth, searchNode->selectivity);
 
             if (newPriority >= currentPriority) {
+                TELEMETRY(++searchNode->telemetry.current.numTTStores;)
                 if (entry->board == searchNode->board) {
                     if (newPriority > currentPriority) {
                         entry->data.update_higher_priority(this->age, depth, alpha, beta, value, move, searchNode->selectivity);
@@ -266,13 +268,13 @@ namespace engine {
                         entry->data.update_same_priority(alpha, beta, value, move);
                     }
                 } else {
+                    TELEMETRY(if (entry->board.P | entry->board.O) ++searchNode->telemetry.current.numTTOverwrites;)
                     entry->board = searchNode->board;
                     entry->data.overwrite(this->age, depth, alpha, beta, value, move, searchNode->selectivity);
                 }
             }
-            #if LOCK_TT
+            if constexpr (IsLocked)
                 entry->lock.unlock();
-            #endif
         }
 
         /**
@@ -284,21 +286,22 @@ namespace engine {
          * @param upper: the upper bound of the node
          * @param moves: the best moves at the node
          */
+        template<bool IsLocked = LOCK_TT>
         inline void
         load(SearchNode *searchNode, uint32_t hash, int depth, int *lower, int *upper, uint_fast8_t *moves) const {
-            HashEntry *entry = &this->table[hash & HASH_MASK];
-            #if LOCK_TT
+            HashEntry *entry = &this->table[hash & this->hashMask];
+            if constexpr (IsLocked)
                 entry->lock.lock();
-            #endif
+            TELEMETRY(++searchNode->telemetry.current.numTTProbes;)
             if (searchNode->board.P == entry->board.P && searchNode->board.O == entry->board.O) {
+                TELEMETRY(++searchNode->telemetry.current.numTTHits;)
                 entry->data.load_moves(moves);
                 if (entry->data.get_read_priority() >= get_read_priority(depth, searchNode->selectivity)) {
                     entry->data.load_bounds(lower, upper);
                 }
             }
-            #if LOCK_TT
+            if constexpr (IsLocked)
                 entry->lock.unlock();
-            #endif
         }
 
         /**
@@ -309,17 +312,19 @@ namespace engine {
          * @param lower: the lower bound of the node
          * @param upper: the upper bound of the node
          */
+        template<bool IsLocked = LOCK_TT>
         inline void load_bounds(SearchNode *searchNode, uint32_t hash, int depth, int *lower, int *upper) const {
-            HashEntry *entry = &this->table[hash & HASH_MASK];
-            #if LOCK_TT
+            HashEntry *entry = &this->table[hash & this->hashMask];
+            if constexpr (IsLocked)
                 entry->lock.lock();
-            #endif
-            if (searchNode->board.P == entry->board.P && searchNode->board.O == entry->board.O && entry->data.get_read_priority() >= get_read_priority(depth, searchNode->selectivity)) {
-                entry->data.load_bounds(lower, upper);
+            TELEMETRY(++searchNode->telemetry.current.numTTProbes;)
+            if (searchNode->board.P == entry->board.P && searchNode->board.O == entry->board.O) {
+                TELEMETRY(++searchNode->telemetry.current.numTTHits;)
+                if (entry->data.get_read_priority() >= get_read_priority(depth, searchNode->selectivity))
+                    entry->data.load_bounds(lower, upper);
             }
-            #if LOCK_TT
+            if constexpr (IsLocked)
                 entry->lock.unlock();
-            #endif
         }
 
         /** @brief load best moves from the transposition table
@@ -327,17 +332,16 @@ namespace engine {
          * @param hash: the hash key
          * @param moves: the best moves at the node
          */
+        template<bool IsLocked = LOCK_TT>
         inline void load_moves(SearchNode *searchNode, uint32_t hash, uint_fast8_t *moves) const {
-            HashEntry *entry = &this->table[hash & HASH_MASK];
-            #if LOCK_TT
+            HashEntry *entry = &this->table[hash & this->hashMask];
+            if constexpr (IsLocked)
                 entry->lock.lock();
-            #endif
             if (searchNode->board.P == entry->board.P && searchNode->board.O == entry->board.O) {
                 entry->data.load_moves(moves);
             }
-            #if LOCK_TT
+            if constexpr (IsLocked)
                 entry->lock.unlock();
-            #endif
         }
 
         /** @brief Get best move from the transposition table
@@ -347,7 +351,7 @@ namespace engine {
          * @return the best move at the node
          */
         inline int get_best_move(const Board *board, uint32_t hash) {
-            HashEntry *entry = &this->table[hash & HASH_MASK];
+            HashEntry *entry = &this->table[hash & this->hashMask];
             if (board->P == entry->board.P && board->O == entry->board.O) {
                 return entry->data.get_first_move();
             }
@@ -399,6 +403,8 @@ namespace engine {
     private:
         static uint32_t HASH_KEYS[8][65536]; // random hash keys
         static const uint32_t HASH_MASK = (1UL << HASH_BITS) - 1UL;  // mask for the hash key
+        size_t numEntries;                                           // number of entries in the table
+        uint32_t hashMask;                                           // mask from a hash key to a table index
         HashEntry *table;                                            // pointer to the table
         uint8_t age = 0;                                             // age of the table
     };
@@ -0,0 +1,43 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace engine {
+    ThreadPool::ThreadPool(int numThreads) {
+        numThreads = std::max(1, numThreads);
+        this->threads.reserve(numThreads);
+        for (int i = 0; i < numThreads; ++i)
+            this->threads.emplace_back(&ThreadPool::worker, this);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->shutdown = true;
+        }
+        this->jobAvailable.notify_all();
+        for (auto &thread: this->threads)
+            thread.join();
+    }
+
+    void ThreadPool::worker() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->jobAvailable.wait(lock, [this]() {
+                    return this->shutdown || !this->queue.empty();
+                });
+                if (this->queue.empty())
+                    return;
+
+                job = std::move(this->queue.front());
+                this->queue.pop_front();
+            }
+            job();
+        }
+    }
+}
@@ -0,0 +1,73 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_THREADPOOL_H
+#define OTHELLO_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine {
+
+    /**
+     * @brief a fixed set of worker threads that run submitted jobs in submission order.
+     *
+     * The threads live as long as the pool, so back-to-back jobs don't pay for creating a thread. With a single thread,
+     * jobs never overlap, which is how an engine serializes the searches that share its transposition table.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * @param numThreads: number of worker threads
+         */
+        explicit ThreadPool(int numThreads = 1);
+
+        /**
+         * @brief run the jobs that are still queued, then join the threads
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * @brief queue a job
+         * @param job: the job to run on a worker thread
+         * @return a future for the value returned by the job
+         */
+        template<typename F>
+        auto submit(F &&job) -> std::future<decltype(job())> {
+            using T = decltype(job());
+            auto task = std::make_shared<std::packaged_task<T()>>(std::forward<F>(job));
+            auto future = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->queue.emplace_back([task]() { (*task)(); });
+            }
+            this->jobAvailable.notify_one();
+            return future;
+        }
+
+        [[nodiscard]] inline int size() const {
+            return (int)this->threads.size();
+        }
+
+    private:
+        void worker();
+
+        std::mutex mutex;
+        std::condition_variable jobAvailable;
+        std::deque<std::function<void()>> queue;
+        std::vector<std::thread> threads;
+        bool shutdown = false;
+    };
+}
+
+#endif //OTHELLO_THREADPOOL_H
@@ -12,6 +12,22 @@ namespace gui {
         searchTimeSpinBox->setPrefix("Search Time: ");
         searchTimeSpinBox->setSuffix("s");
 
+        // game clock for the AI, used instead of a fixed search time when enabled
+        gameClockCheckBox = new QCheckBox("Game Clock", this);
+        gameTimeSpinBox = new QSpinBox(this);
+        gameTimeSpinBox->setRange(1, 60);
+        gameTimeSpinBox->setValue(5);
+        gameTimeSpinBox->setPrefix("Game Time: ");
+        gameTimeSpinBox->setSuffix(" min");
+        gameTimeSpinBox->setEnabled(false);
+
+        incrementSpinBox = new QSpinBox(this);
+        incrementSpinBox->setRange(0, 60);
+        incrementSpinBox->setValue(0);
+        incrementSpinBox->setPrefix("Increment: ");
+        incrementSpinBox->setSuffix("s");
+        incrementSpinBox->setEnabled(false);
+
         blackAICheckBox = new QCheckBox("Black AI", this);
         whiteAICheckBox = new QCheckBox("White AI", this);
         startButton = new QPushButton("Start", this);
@@ -19,13 +35,24 @@ namespace gui {
         auto* layout = new QGridLayout(this);
         layout->setAlignment(Qt::AlignCenter);
         layout->addWidget(searchTimeSpinBox, 0, 0, 1, 3);
-        layout->addWidget(blackAICheckBox, 1, 0);
-        layout->addWidget(whiteAICheckBox, 1, 2);
-        layout->addWidget(startButton, 2, 0, 1, 3);
+        layout->addWidget(gameClockCheckBox, 1, 0, 1, 3);
+        layout->addWidget(gameTimeSpinBox, 2, 0, 1, 3);
+        layout->addWidget(incrementSpinBox, 3, 0, 1, 3);
+        layout->addWidget(blackAICheckBox, 4, 0);
+        layout->addWidget(whiteAICheckBox, 4, 2);
+        layout->addWidget(startButton, 5, 0, 1, 3);
         layout->setSpacing(10);
         setLayout(layout);
 
         connect(startButton, &QPushButton::pressed, [this]() {emit start_pressed();});
+        connect(gameClockCheckBox, &QCheckBox::toggled, [this](bool checked) {
+            searchTimeSpinBox->setEnabled(!checked);
+            gameTimeSpinBox->setEnabled(checked);
+            incrementSpinBox->setEnabled(checked);
+            emit clock_changed();
+        });
+        connect(gameTimeSpinBox, &QSpinBox::valueChanged, [this]() {emit clock_changed();});
+        connect(incrementSpinBox, &QSpinBox::valueChanged, [this]() {emit clock_changed();});
     }
 
     bool AIConfigWidget::is_black_ai() const {
@@ -39,4 +66,16 @@ namespace gui {
     int AIConfigWidget::get_search_time() const {
         return searchTimeSpinBox->value();
     }
+
+    bool AIConfigWidget::is_game_clock_enabled() const {
+        return gameClockCheckBox->isChecked();
+    }
+
+    int AIConfigWidget::get_game_time() const {
+        return gameTimeSpinBox->value() * 60;
+    }
+
+    int AIConfigWidget::get_increment() const {
+        return incrementSpinBox->value();
+    }
 } // gui
\ No newline at end of file
@@ -18,12 +18,19 @@ namespace gui {
         [[nodiscard]] bool is_black_ai() const;
         [[nodiscard]] bool is_white_ai() const;
         [[nodiscard]] int get_search_time() const;
+        [[nodiscard]] bool is_game_clock_enabled() const;
+        [[nodiscard]] int get_game_time() const;
+        [[nodiscard]] int get_increment() const;
 
     signals:
         void start_pressed();
+        void clock_changed();
 
     private:
         QSpinBox* searchTimeSpinBox;
+        QCheckBox* gameClockCheckBox;
+        QSpinBox* gameTimeSpinBox;
+        QSpinBox* incrementSpinBox;
         QCheckBox* blackAICheckBox;
         QCheckBox* whiteAICheckBox;
         QPushButton* startButton;
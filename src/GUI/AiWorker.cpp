@@ -5,22 +5,29 @@
 #include "AiWorker.h"
 
 namespace gui {
-    void AiWorker::wait_for_search(engine::SearchTask* searchTask) {
-        *this->cancelled = false;
-
-        searchTask->qt_wait_for_completion();
-        Move move = searchTask->get_result().move;
-
-        std::cout << move << std::endl;
+    AiWorker::AiWorker(engine::SearchTask *searchTask) :
+            searchTask(searchTask) {
+        connect(this, &AiWorker::search_completed, this, &AiWorker::handle_search_completed, Qt::QueuedConnection);
+        searchTask->set_completion_callback([this](const engine::SearchResult &result, int runId) {
+            emit search_completed((int)result.move.x, runId);
+        });
+    }
 
-        if (!*this->cancelled)
-            emit play_ai_move((int) move.x, true);
-        else
-            *this->cancelled = false;
+    void AiWorker::wait_for_search() {
+        this->awaitedRunId = this->searchTask->get_run_id();
     }
 
     void AiWorker::cancel() {
-        *this->cancelled = true;
+        this->awaitedRunId = -1;
+    }
+
+    void AiWorker::handle_search_completed(int move, int runId) {
+        if (runId != this->awaitedRunId)
+            return;
+
+        this->awaitedRunId = -1;
+        std::cout << Move((uint_fast8_t)move, 0ULL) << std::endl;
+        emit play_ai_move(move, true);
     }
 
-} // gui
\ No newline at end of file
+} // gui
@@ -10,22 +10,37 @@
 
 namespace gui {
 
+    /**
+     * @brief plays the AI's moves when the search task completes.
+     *
+     * The completion callback of the search task runs on the search thread, so it only emits a signal, which Qt queues
+     * onto the thread of the worker. The move is played as soon as the event loop picks it up, without polling.
+     */
     class AiWorker: public QObject {
         Q_OBJECT
     public:
-        AiWorker() : cancelled(new bool(false)) {}
-        explicit AiWorker(bool *cancelled) : cancelled(cancelled) {}
+        explicit AiWorker(engine::SearchTask *searchTask);
 
-        void cancel();
+        /**
+         * @brief play the move of the current run of the search task once it completes
+         */
+        void wait_for_search();
 
-    public slots:
-        void wait_for_search(engine::SearchTask* searchTask);
+        /**
+         * @brief don't play the move of the run that is being waited for
+         */
+        void cancel();
 
     signals:
         void play_ai_move(int position, bool isAI = true);
+        void search_completed(int move, int runId);
+
+    private slots:
+        void handle_search_completed(int move, int runId);
 
     private:
-        bool *cancelled;
+        engine::SearchTask *searchTask;
+        int awaitedRunId = -1;  // run whose move should be played, or -1
     };
 
 } // gui
@@ -55,19 +55,16 @@ namespace gui {
         layout->setSpacing(0);
         this->setLayout(layout);
 
-        // initialize evaluation worker and thread
-        this->evaluationWorkerThread = new QThread;
-        this->evaluationWorker = new EvaluationWorker;
-
-        evaluationWorker->moveToThread(this->evaluationWorkerThread);
-        connect(evaluationWorker, &EvaluationWorker::new_evaluation, this, &EvaluationWidget::set_evaluation_bar);
-        connect(this, &EvaluationWidget::handle_start_evaluation_task, this->evaluationWorker,
-                &EvaluationWorker::update_evaluation_task);
-        this->evaluationWorkerThread->start();
+        // evaluations are emitted on the search thread and queued onto the GUI thread
+        connect(this, &EvaluationWidget::new_evaluation, this, &EvaluationWidget::set_evaluation_bar, Qt::QueuedConnection);
     }
 
     void EvaluationWidget::set_evaluation_bar(EvaluationPoint evaluation) {
-        if (this->evaluationIndex != nullptr) {
+        // drop evaluations of a position the board has moved on from while they were queued
+        if (this->evaluationIndex != nullptr && evaluation.index == *this->evaluationIndex) {
+            // even index -> black to move, odd index -> white to move (negate)
+            if (evaluation.index & 1)
+                evaluation.value = -evaluation.value;
             auto pEvaluation = &this->evaluations[*(this->evaluationIndex)];
 
             // only update the evaluation if the new evaluation is deeper than the current one
@@ -96,6 +93,7 @@ namespace gui {
             }
 
             *(this->evaluationIndex) = index;
+            this->searchIndex = index;
             this->animate_bar(this->evaluations[index].value);
             this->isChangingIndex = false;
         }
@@ -106,7 +104,9 @@ namespace gui {
     }
 
     void EvaluationWidget::start_evaluation_task(engine::SearchTask *searchTask) {
-        emit handle_start_evaluation_task(searchTask, this->evaluationIndex);
+        searchTask->set_progress_callback([this](const engine::SearchResult &result) {
+            emit new_evaluation({result.value, result.depth, result.rootDiscCount, this->searchIndex});
+        });
     }
 
     void EvaluationWidget::animate_bar(int value) {
@@ -134,17 +134,4 @@ namespace gui {
         this->scoreAnimation->setEndValue(value);
         this->scoreAnimation->start();
     }
-
-    [[noreturn]] void
-    EvaluationWorker::update_evaluation_task(engine::SearchTask *searchTask, const int *evaluationIndex) {
-        // even index -> black to move, odd index -> white to move (negate)
-        int value;
-        while (true) {
-            if (searchTask->search != nullptr && searchTask->search->depth > 0) {
-                value = *evaluationIndex & 1 ? -searchTask->search->value : searchTask->search->value;
-                emit new_evaluation({value, searchTask->search->depth, searchTask->search->rootDiscCount});
-            }
-            QThread::msleep(1);
-        }
-    }
 } // gui
\ No newline at end of file
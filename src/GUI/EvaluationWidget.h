@@ -7,42 +7,37 @@
 
 #include "../Engine/Search/SearchStructs.h"
 #include "QtInclude.h"
+#include <atomic>
 
 namespace gui {
 
     struct EvaluationPoint {
         EvaluationPoint() = default;
-        EvaluationPoint(int value, int depth, int discCount) :
-            value(value), depth(depth), discCount(discCount) {}
+        EvaluationPoint(int value, int depth, int discCount, int index = 0) :
+            value(value), depth(depth), discCount(discCount), index(index) {}
         int value = 0;
         int depth = 0;
         int discCount = 0;
+        int index = 0;  // move index of the position searched, when the evaluation was reported
     };
 
 
-    class EvaluationWorker: public QObject {
-        Q_OBJECT
-    public slots:
-        [[noreturn]] void update_evaluation_task(engine::SearchTask* searchTask, const int* evaluationIndex);
-    signals:
-        void new_evaluation(EvaluationPoint evaluation);
-    };
-
     class EvaluationWidget: public QWidget {
         Q_OBJECT
-        QThread* evaluationWorkerThread;
     public:
         explicit EvaluationWidget(QWidget* parent, int barMax = 20, int barWidth = 30, int barHeight = 500);
         ~EvaluationWidget() override {
             delete this->evaluationIndex;
-            delete this->evaluationWorker;
-            delete this->evaluationWorkerThread;
             delete[] this->evaluations;
         }
 
         void set_evaluation_index(int index);
 
         void reset();
+
+        /**
+         * @brief show the evaluations of a search task. Call before the task's first run.
+         */
         void start_evaluation_task(engine::SearchTask* searchTask);
 
         static const int NUM_EVALUATIONS = 120;
@@ -51,19 +46,19 @@ namespace gui {
         void set_evaluation_bar(EvaluationPoint evaluation);
 
     signals:
-        void handle_start_evaluation_task(engine::SearchTask* searchTask, int* pEvaluationIndex);
+        void new_evaluation(EvaluationPoint evaluation);
 
     private:
         QLabel* evaluationLabel;
         QPropertyAnimation* scoreAnimation;
         QProgressBar* evaluationBar;
 
-        EvaluationWorker* evaluationWorker;
         EvaluationPoint *evaluations;
 
         bool isChangingIndex = false;
 
         int* evaluationIndex = nullptr;
+        std::atomic<int> searchIndex = 0;  // the move index, for the search thread
 
         void animate_bar(int value);
     };
@@ -28,29 +28,30 @@ namespace gui {
         connect(sidePanelWidget, &SidePanelWidget::redo_pressed, this, &OthelloGUI::handle_redo_pressed);
         connect(sidePanelWidget, &SidePanelWidget::restart_pressed, this, &OthelloGUI::handle_restart_pressed);
         connect(sidePanelWidget, &SidePanelWidget::start_pressed, this, &OthelloGUI::play_ai_move);
+        connect(sidePanelWidget, &SidePanelWidget::clock_changed, this, &OthelloGUI::reset_clocks);
         connect(boardWidget, &BoardWidget::played_move, this, &OthelloGUI::handle_played_move);
 
-        // initialize AI worker and thread
-        this->aiWorker = new AiWorker;
-        this->aiWorkerThread = new QThread;
-        this->aiWorker->moveToThread(this->aiWorkerThread);
-        connect(this, &OthelloGUI::get_ai_move, this->aiWorker, &AiWorker::wait_for_search);
-        connect(this->aiWorker, &AiWorker::play_ai_move, this->boardWidget, &BoardWidget::handle_cell_clicked);
-        this->aiWorkerThread->start();
+        #if USE_OPENING_BOOK
+            this->engine.load_opening_book();
+        #endif
 
-        // initialize search task and evaluation thread for AI
-        this->searchTask = this->engine.search_task(*this->boardWidget);
-        this->evaluationWidget->start_evaluation_task(this->searchTask);
+        // initialize the search task, and the workers that listen to it, before its first run
+        this->searchTask = std::make_unique<engine::SearchTask>(*this->boardWidget);
+        this->aiWorker = new AiWorker(this->searchTask.get());
+        connect(this->aiWorker, &AiWorker::play_ai_move, this->boardWidget, &BoardWidget::handle_cell_clicked);
+        this->evaluationWidget->start_evaluation_task(this->searchTask.get());
+        this->engine.continue_search_task(this->searchTask.get(), this->boardWidget->get_last_move().is_pass());
+        this->reset_clocks();
     }
 
     void OthelloGUI::handle_redo_pressed() {
         if (this->boardWidget->redo_move(true)) {
             this->aiWorker->cancel();
+            this->aiClockColor = -1;
             this->searchTask->stop();
-            this->searchTask->qt_wait_for_completion();
             this->evaluationWidget->set_evaluation_index(this->boardWidget->get_move_index());
             this->searchTask->set_board(this->boardWidget->get_bitboard());
-            this->engine.continue_search_task(this->searchTask, this->boardWidget->get_last_move().is_pass());
+            this->engine.continue_search_task(this->searchTask.get(), this->boardWidget->get_last_move().is_pass());
             this->boardWidget->rehighlight_cells();
             this->boardWidget->enable_input();
         }
@@ -60,11 +61,11 @@ namespace gui {
     void OthelloGUI::handle_undo_pressed() {
         if (this->boardWidget->undo_move(true)) {
             this->aiWorker->cancel();
+            this->aiClockColor = -1;
             this->searchTask->stop();
-            this->searchTask->qt_wait_for_completion();
             this->evaluationWidget->set_evaluation_index(this->boardWidget->get_move_index());
             this->searchTask->set_board(this->boardWidget->get_bitboard());
-            this->engine.continue_search_task(this->searchTask, this->boardWidget->get_last_move().is_pass());
+            this->engine.continue_search_task(this->searchTask.get(), this->boardWidget->get_last_move().is_pass());
             this->boardWidget->rehighlight_cells();
             this->boardWidget->enable_input();
         }
@@ -78,19 +79,19 @@ namespace gui {
             this->boardWidget->update_display();
             this->boardWidget->enable_input();
             this->aiWorker->cancel();
+            this->reset_clocks();
             this->searchTask->stop();
-            this->searchTask->qt_wait_for_completion();
             this->searchTask->set_board(this->boardWidget->get_bitboard());
             this->evaluationWidget->reset();
-            this->engine.continue_search_task(this->searchTask, this->boardWidget->get_last_move().is_pass());
+            this->engine.continue_search_task(this->searchTask.get(), this->boardWidget->get_last_move().is_pass());
         }
     }
 
     void OthelloGUI::handle_played_move(int position) {
+        this->charge_ai_clock();
         this->searchTask->stop();
         this->boardWidget->rehighlight_cells();
         this->boardWidget->update_display();
-        this->searchTask->qt_wait_for_completion();
         this->evaluationWidget->set_evaluation_index(this->boardWidget->get_move_index());
         this->searchTask->set_board(this->boardWidget->get_bitboard());
 
@@ -99,7 +100,7 @@ namespace gui {
             this->play_ai_move();
         }
         else {
-            this->engine.continue_search_task(this->searchTask, this->boardWidget->get_last_move().is_pass());
+            this->engine.continue_search_task(this->searchTask.get(), this->boardWidget->get_last_move().is_pass());
         }
     }
 
@@ -112,17 +113,53 @@ namespace gui {
     void OthelloGUI::play_ai_move() {
         if (is_ai_move() && this->boardWidget->input_enabled()) {
             this->boardWidget->disable_input();
-            // set endgame flag if needed
-            if (this->boardWidget->get_disc_count() < 64 - PERFECT_SEARCH_DEPTH) {
-                // make timer thread for mid-game search
-                engine::Engine::make_timer_thread((double)this->sidePanelWidget->get_search_time(),
-                                                  this->searchTask->running, false).detach();
+            auto passed = this->boardWidget->get_last_move().is_pass();
+
+            // the running analysis search can't play from the book, so restart it as a search that will
+            engine::BookMove bookMove;
+            if (this->searchTask->running && this->engine.probe_opening_book(this->boardWidget->get_bitboard(), &bookMove)) {
+                this->searchTask->stop();
+                this->searchTask->set_board(this->boardWidget->get_bitboard());
             }
-            // restart search task if needed
-            if (!*this->searchTask->running) {
-                this->engine.continue_search_task(this->searchTask, this->boardWidget->get_last_move().is_pass());
+
+            if (this->sidePanelWidget->is_game_clock_enabled()) {
+                // let the time manager budget the move from the AI's clock. The running analysis search has no time
+                // manager, so it is restarted as a clocked search; its work stays in the transposition table
+                this->aiClockColor = this->boardWidget->is_black_to_move() ? 0 : 1;
+                this->aiMoveStartTime = std::chrono::steady_clock::now();
+                engine::GameClock clock{this->aiClocks[this->aiClockColor], (double)this->sidePanelWidget->get_increment()};
+
+                if (this->searchTask->running)
+                    this->searchTask->stop();
+                this->engine.continue_search_task_clocked(this->searchTask.get(), passed, clock);
+            } else if (this->boardWidget->get_disc_count() < 64 - PERFECT_SEARCH_DEPTH) {
+                // limit the mid-game search, restarting the search task if needed
+                auto searchTime = (double)this->sidePanelWidget->get_search_time();
+                if (this->searchTask->running)
+                    this->searchTask->stop_after(searchTime);
+                else
+                    this->engine.continue_search_task_timed(this->searchTask.get(), passed, searchTime);
+            } else if (!this->searchTask->running) {
+                // restart search task if needed
+                this->engine.continue_search_task(this->searchTask.get(), passed);
             }
-            emit get_ai_move(this->searchTask);
+            this->aiWorker->wait_for_search();
         }
     }
+
+    void OthelloGUI::reset_clocks() {
+        this->aiClocks[0] = this->aiClocks[1] = (double)this->sidePanelWidget->get_game_time();
+        this->aiClockColor = -1;
+    }
+
+    void OthelloGUI::charge_ai_clock() {
+        if (this->aiClockColor < 0)
+            return;
+
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->aiMoveStartTime).count();
+        auto &clock = this->aiClocks[this->aiClockColor];
+        clock = std::max(0.0, clock - elapsed) + (double)this->sidePanelWidget->get_increment();
+        std::cout << (this->aiClockColor == 0 ? "Black" : "White") << " AI clock: " << clock << "s" << std::endl;
+        this->aiClockColor = -1;
+    }
 } // gui
\ No newline at end of file
@@ -28,20 +28,23 @@ namespace gui {
         void handle_restart_pressed();
         void play_ai_move();
 
-    signals:
-        void get_ai_move(engine::SearchTask* searchTask);
-
     private:
         BoardWidget* boardWidget;
         SidePanelWidget* sidePanelWidget;
         EvaluationWidget* evaluationWidget;
-        QThread* aiWorkerThread;
         AiWorker* aiWorker;
         engine::Engine engine;
-        engine::SearchTask* searchTask;
+        std::unique_ptr<engine::SearchTask> searchTask;  // after the engine, so its run is stopped before the engine is destroyed
         int lastAIDepth = 0;
 
+        // game clock of each colour's AI, in seconds
+        double aiClocks[2] = {0, 0};
+        int aiClockColor = -1;  // colour whose clock is running, or -1
+        std::chrono::steady_clock::time_point aiMoveStartTime;
+
         bool is_ai_move();
+        void reset_clocks();
+        void charge_ai_clock();
     };
 
 } // gui
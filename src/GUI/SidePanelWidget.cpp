@@ -33,5 +33,6 @@ namespace gui {
         connect(this->undoButton, &QPushButton::pressed, [this]() {emit this->undo_pressed();});
         connect(this->restartButton, &QPushButton::pressed, [this]() {emit this->restart_pressed();});
         connect(this->aiConfigWidget, &AIConfigWidget::start_pressed, [this]() {emit this->start_pressed();});
+        connect(this->aiConfigWidget, &AIConfigWidget::clock_changed, [this]() {emit this->clock_changed();});
     }
 }
\ No newline at end of file
@@ -20,12 +20,16 @@ namespace gui {
         [[nodiscard]] inline bool is_black_ai() const {return aiConfigWidget->is_black_ai();}
         [[nodiscard]] inline bool is_white_ai() const {return aiConfigWidget->is_white_ai();}
         [[nodiscard]] inline int get_search_time() const {return aiConfigWidget->get_search_time();}
+        [[nodiscard]] inline bool is_game_clock_enabled() const {return aiConfigWidget->is_game_clock_enabled();}
+        [[nodiscard]] inline int get_game_time() const {return aiConfigWidget->get_game_time();}
+        [[nodiscard]] inline int get_increment() const {return aiConfigWidget->get_increment();}
 
     signals:
         void undo_pressed();
         void redo_pressed();
         void restart_pressed();
         void start_pressed();
+        void clock_changed();
 
     public slots:
 
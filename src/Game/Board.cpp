@@ -159,7 +159,7 @@ uint64_t Board::get_legal_moves() const {
         pre = mO & (mO << 9);
         flip |= pre & (flip << 18);
         flip |= pre & (flip << 18);
-        legal |= flip << 7;
+        legal |= flip << 9;
 
         flip = mO & (P >> 9);
         flip |= mO & (flip >> 9);
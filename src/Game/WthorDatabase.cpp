@@ -0,0 +1,111 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "WthorDatabase.h"
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Board.h"
+
+// WTHOR files are little-endian
+static inline uint16_t read_u16(const uint8_t *bytes) {
+    return (uint16_t)(bytes[0] | bytes[1] << 8);
+}
+
+static inline uint32_t read_u32(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+WthorDatabase::~WthorDatabase() {
+    this->unload();
+}
+
+void WthorDatabase::unload() {
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->mappingSize);
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+    this->records = nullptr;
+    this->numGames = 0;
+    this->year = 0;
+    this->fileSize = 0;
+    this->fileTime = 0;
+}
+
+bool WthorDatabase::load(const std::string &filepath) {
+    this->unload();
+
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "could not open WTHOR file " << filepath << std::endl;
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)HEADER_SIZE) {
+        std::cerr << "invalid WTHOR file " << filepath << std::endl;
+        close(fd);
+        return false;
+    }
+
+    auto size = (size_t)st.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "could not map WTHOR file " << filepath << std::endl;
+        return false;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    // header: creation date (4 bytes), number of games (4), unused here (2), year of the games (2), board size (1),
+    // game type (1), depth of the theoretical scores (1), reserved (1)
+    auto header = (const uint8_t *)data;
+    auto numRecords = (uint64_t)read_u32(header + 4);
+    auto boardSize = header[12];
+    if ((boardSize != 0 && boardSize != 8) || size != HEADER_SIZE + numRecords * RECORD_SIZE) {
+        std::cerr << "invalid WTHOR file " << filepath << std::endl;
+        munmap(data, size);
+        return false;
+    }
+
+    this->mapping = data;
+    this->mappingSize = size;
+    this->records = header + HEADER_SIZE;
+    this->numGames = numRecords;
+    this->year = read_u16(header + 10);
+    this->fileSize = (uint64_t)st.st_size;
+    this->fileTime = (int64_t)st.st_mtime;
+    return true;
+}
+
+WthorDatabase::Game WthorDatabase::get_game(uint64_t i) const {
+    // record: tournament (2 bytes), black player (2), white player (2), black's discs (1), black's theoretical
+    // discs (1), moves (60)
+    auto record = this->records + i * RECORD_SIZE;
+    return {read_u16(record), read_u16(record + 2), read_u16(record + 4), record[6], record[7], record + 8};
+}
+
+int WthorDatabase::decode(const Game &game, uint8_t *squares) {
+    Board board;
+    int numMoves = 0;
+    for (int i = 0; i < MAX_MOVES; ++i) {
+        const int row = game.moves[i] / 10;
+        const int col = game.moves[i] % 10;
+        if (row < 1 || row > 8 || col < 1 || col > 8)
+            break;
+
+        if (board.get_legal_moves() == 0)
+            board.pass();
+
+        auto x = (uint_fast8_t)((col - 1) + ((row - 1) << 3));
+        if (!(board.get_legal_moves() & (1ULL << x)))
+            break;  // corrupt record, keep the moves before it
+
+        board.play_move(x);
+        squares[numMoves++] = x;
+    }
+    return numMoves;
+}
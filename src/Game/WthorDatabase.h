@@ -0,0 +1,111 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_WTHORDATABASE_H
+#define OTHELLO_WTHORDATABASE_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief read-only WTHOR game database (.wtb), memory-mapped.
+ *
+ * A WTHOR file is a 16-byte header followed by fixed-size 68-byte game records, so a game is read straight out of
+ * the mapping by its index, without parsing the ones before it or converting the file to text. Each record holds
+ * the tournament and player numbers, black's final disc count and the 60 moves as 10 * row + column (11 is a1, 88 is
+ * h8), with 0 after the last move. Passes aren't recorded.
+ */
+class WthorDatabase {
+public:
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t RECORD_SIZE = 68;
+    static constexpr int MAX_MOVES = 60;
+
+    struct Game {
+        uint16_t tournament;
+        uint16_t blackPlayer;
+        uint16_t whitePlayer;
+        int blackDiscs;        // black's final disc count, with the empty squares going to the winner
+        int theoreticalDiscs;  // black's final disc count with perfect play from the header's theoretical depth on
+        const uint8_t *moves;  // MAX_MOVES moves as 10 * row + column, 0 after the last move
+
+        /**
+         * @return final disc difference for black
+         */
+        [[nodiscard]] inline int get_disc_difference() const {
+            return 2 * this->blackDiscs - 64;
+        }
+
+        /**
+         * @return number of moves in the record, legal or not
+         */
+        [[nodiscard]] inline int get_num_moves() const {
+            int n = 0;
+            while (n < MAX_MOVES && this->moves[n] != 0)
+                ++n;
+            return n;
+        }
+    };
+
+    WthorDatabase() = default;
+    ~WthorDatabase();
+
+    WthorDatabase(const WthorDatabase&) = delete;
+    WthorDatabase& operator=(const WthorDatabase&) = delete;
+
+    /**
+     * @brief memory-map a WTHOR game file
+     * @param filepath: path of the .wtb file
+     * @return whether the file was loaded
+     */
+    bool load(const std::string &filepath);
+
+    [[nodiscard]] inline uint64_t size() const {
+        return this->numGames;
+    }
+
+    /**
+     * @return year the games were played, from the header
+     */
+    [[nodiscard]] inline int get_year() const {
+        return this->year;
+    }
+
+    [[nodiscard]] Game get_game(uint64_t i) const;
+
+    /**
+     * @return size of the file in bytes when it was loaded
+     */
+    [[nodiscard]] inline uint64_t get_file_size() const {
+        return this->fileSize;
+    }
+
+    /**
+     * @return modification time of the file when it was loaded
+     */
+    [[nodiscard]] inline int64_t get_file_time() const {
+        return this->fileTime;
+    }
+
+    /**
+     * @brief replay the moves of a game, playing passes where they're needed
+     * @param game: the game
+     * @param squares: receives up to MAX_MOVES moves as squares (column + 8 * row)
+     * @return number of moves, up to the first one that's missing or illegal
+     */
+    static int decode(const Game &game, uint8_t *squares);
+
+private:
+    void unload();
+
+    void *mapping = nullptr;
+    size_t mappingSize = 0;
+    const uint8_t *records = nullptr;
+    uint64_t numGames = 0;
+    int year = 0;
+    uint64_t fileSize = 0;
+    int64_t fileTime = 0;
+};
+
+#endif //OTHELLO_WTHORDATABASE_H
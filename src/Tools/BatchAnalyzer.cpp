@@ -0,0 +1,513 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "BatchAnalyzer.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "../Game/WthorDatabase.h"
+#include "../Util.h"
+
+namespace tools {
+    // positions ordered longest expected search first among themselves. Bounds the results held back for the output
+    constexpr uint64_t POSITION_BLOCK_SIZE = 4096;
+
+    // seconds between checkpoints
+    constexpr double CHECKPOINT_INTERVAL = 10;
+
+    static std::string get_checkpoint_path(const std::string &outPath) {
+        return outPath + ".checkpoint";
+    }
+
+    /**
+     * @brief read a position written as 64 squares and the side to move, ignoring spaces
+     * @return whether the line is a position
+     */
+    static bool parse_position(const std::string &line, BatchPosition *position) {
+        char squares[65];
+        int n = 0;
+        for (size_t i = 0; i < line.size() && n < 65; ++i)
+            if (!std::isspace((unsigned char)line[i]))
+                squares[n++] = line[i];
+        if (n < 65)
+            return false;
+
+        auto isBlack = [](char c) { return c == 'X' || c == 'x' || c == '*'; };
+        auto isWhite = [](char c) { return c == 'O' || c == 'o'; };
+        uint64_t black = 0, white = 0;
+        for (int i = 0; i < 64; ++i) {
+            if (isBlack(squares[i]))
+                black |= 1ULL << i;
+            else if (isWhite(squares[i]))
+                white |= 1ULL << i;
+            else if (squares[i] != '-' && squares[i] != '.')
+                return false;
+        }
+        if (!isBlack(squares[64]) && !isWhite(squares[64]))
+            return false;
+
+        position->isBlackToMove = isBlack(squares[64]);
+        position->board = position->isBlackToMove ? Board(black, white) : Board(white, black);
+        return true;
+    }
+
+    /**
+     * @brief read the moves of a transcript (f5d6c3...) or a logbook line (+f5-d6+c3...:score), up to the first
+     * illegal one
+     * @return number of moves read
+     */
+    static int parse_game(const std::string &line, uint8_t *squares) {
+        Board board;
+        int numMoves = 0;
+        for (size_t i = 0; i + 1 < line.size() && numMoves < WthorDatabase::MAX_MOVES;) {
+            char c = line[i];
+            if (c == ':' || std::isspace((unsigned char)c))
+                break;
+            if (c == '+' || c == '-') {
+                ++i;
+                continue;
+            }
+
+            if (board.get_legal_moves() == 0)
+                board.pass();
+            auto x = (uint_fast8_t)(std::tolower(c) - 'a' + ((line[i + 1] - '1') << 3));
+            if (x >= 64 || !(board.get_legal_moves() & (1ULL << x)))
+                break;
+            board.play_move(x);
+            squares[numMoves++] = x;
+            i += 2;
+        }
+        return numMoves;
+    }
+
+    static std::string to_string(const BatchPosition &position) {
+        std::string s(66, '-');
+        auto black = position.isBlackToMove ? position.board.P : position.board.O;
+        auto white = position.isBlackToMove ? position.board.O : position.board.P;
+        for (int i = 0; i < 64; ++i)
+            s[i] = (black >> i) & 1 ? 'X' : (white >> i) & 1 ? 'O' : '-';
+        s[64] = ' ';
+        s[65] = position.isBlackToMove ? 'X' : 'O';
+        return s;
+    }
+
+    BatchAnalyzer::BatchAnalyzer(int numThreads, int numHashBits) :
+            numThreads(std::max(1, numThreads)),
+            numHashBits(std::clamp(numHashBits, 1, HASH_BITS)) {
+        for (int t = 0; t < this->numThreads; ++t)
+            this->limits.push_back(std::make_unique<engine::SearchLimits>());
+    }
+
+    int BatchAnalyzer::get_hash_bits(long long memory, int numThreads) {
+        auto entriesPerTable = (double)memory * (1 << 20) / std::max(1, numThreads) / sizeof(engine::HashEntry);
+        return std::clamp((int)std::floor(std::log2(std::max(1.0, entriesPerTable))), 10, HASH_BITS);
+    }
+
+    void BatchAnalyzer::set_limits(int maxDepth, double maxTime, long long maxNodes) {
+        this->maxDepth = std::max(0, maxDepth);
+        this->maxTime = std::max(0.0, maxTime);
+        this->maxNodes = std::max(0LL, maxNodes);
+    }
+
+    void BatchAnalyzer::set_search_options(const engine::SearchOptions &options) {
+        this->searchOptions = options;
+    }
+
+    bool BatchAnalyzer::load_weights(const std::string &filepath) {
+        auto evaluationWeights = std::make_shared<engine::eval::EvaluationWeights>();
+        if (!evaluationWeights->load(filepath)) {
+            std::cerr << "could not load weights " << filepath << std::endl;
+            return false;
+        }
+        this->weights = evaluationWeights;
+        this->weightFile = filepath;
+        return true;
+    }
+
+    bool BatchAnalyzer::load_book(const std::string &filepath) {
+        auto openingBook = std::make_shared<engine::OpeningBook>();
+        if (!openingBook->load(filepath)) {
+            std::cerr << "could not load book " << filepath << std::endl;
+            return false;
+        }
+        this->book = openingBook;
+        this->bookFile = filepath;
+        return true;
+    }
+
+    bool BatchAnalyzer::load_positions(const std::string &filepath) {
+        this->positions.clear();
+        this->inputFile = filepath;
+
+        std::error_code error;
+        this->inputSize = std::filesystem::file_size(filepath, error);
+        if (error) {
+            std::cerr << "could not open " << filepath << std::endl;
+            return false;
+        }
+
+        // every position of a game that a move was played from, for the side that played it
+        uint32_t numGames = 0;
+        auto addGame = [this, &numGames](const uint8_t *squares, int numMoves) {
+            Board board;
+            bool isBlack = true;
+            for (int i = 0; i < numMoves; ++i) {
+                if (board.get_legal_moves() == 0) {
+                    board.pass();
+                    isBlack = !isBlack;
+                }
+                this->positions.push_back({board, numGames, (uint8_t)i, squares[i], isBlack});
+                board.play_move(squares[i]);
+                isBlack = !isBlack;
+            }
+            ++numGames;
+        };
+
+        uint8_t squares[WthorDatabase::MAX_MOVES];
+        auto extension = std::filesystem::path(filepath).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        uint64_t numSkipped = 0;
+
+        if (extension == ".wtb") {
+            WthorDatabase database;
+            if (!database.load(filepath))
+                return false;
+            for (uint64_t i = 0; i < database.size(); ++i) {
+                auto numMoves = WthorDatabase::decode(database.get_game(i), squares);
+                if (numMoves > 0)
+                    addGame(squares, numMoves);
+                else
+                    ++numSkipped;
+            }
+        } else {
+            std::ifstream file(filepath);
+            if (!file.is_open()) {
+                std::cerr << "could not open " << filepath << std::endl;
+                return false;
+            }
+
+            std::string line;
+            while (std::getline(file, line)) {
+                auto first = line.find_first_not_of(" \t\r");
+                if (first == std::string::npos || line[first] == '#' || line[first] == '%')
+                    continue;
+
+                BatchPosition position;
+                if (parse_position(line, &position)) {
+                    this->positions.push_back(position);
+                } else if (auto numMoves = parse_game(line.substr(first), squares); numMoves > 0) {
+                    addGame(squares, numMoves);
+                } else {
+                    ++numSkipped;
+                }
+            }
+        }
+
+        std::cout << "loaded " << this->positions.size() << " positions";
+        if (numGames > 0)
+            std::cout << " from " << numGames << " games";
+        std::cout << " in " << filepath;
+        if (numSkipped > 0)
+            std::cout << ", skipped " << numSkipped << " unreadable lines or games";
+        std::cout << std::endl;
+        return !this->positions.empty();
+    }
+
+    double BatchAnalyzer::get_expected_cost(const BatchPosition &position) const {
+        // the log of the number of nodes, if every position branched as much as the root does
+        const int numEmpty = 64 - position.board.get_disc_count();
+        const int depth = this->maxDepth > 0 ? std::min(this->maxDepth, numEmpty) : numEmpty;
+        const int mobility = std::popcount(position.board.get_legal_moves());
+        return depth * std::log(std::max(2, mobility));
+    }
+
+    std::string BatchAnalyzer::get_settings() const {
+        std::ostringstream os;
+        os << "depth " << this->maxDepth << ", time " << this->maxTime << ", nodes " << this->maxNodes
+           << ", weights " << (this->weightFile.empty() ? "default" : this->weightFile)
+           << ", book " << (this->bookFile.empty() ? "none" : this->bookFile) << ", " << this->searchOptions.to_string();
+        return os.str();
+    }
+
+    bool BatchAnalyzer::run(const std::string &outPath) {
+        this->outPath = outPath;
+        this->stopping = false;
+        this->numNodes = 0;
+
+        uint64_t numDone = 0;
+        uint64_t outputSize = 0;
+        if (!this->read_checkpoint(&numDone, &outputSize))
+            return false;
+        if (numDone >= this->positions.size()) {
+            std::cout << "all " << this->positions.size() << " positions are already in " << outPath << std::endl;
+            return true;
+        }
+
+        // drop whatever was written after the checkpoint, since its positions will be searched again
+        if (numDone > 0) {
+            std::error_code error;
+            std::filesystem::resize_file(outPath, outputSize, error);
+            if (error) {
+                std::cerr << "could not truncate " << outPath << " to its checkpoint" << std::endl;
+                return false;
+            }
+        }
+        if (numDone > 0 || !this->pending.empty()) {
+            std::cout << "resuming with " << numDone + this->pending.size() << " of " << this->positions.size()
+                      << " positions done" << std::endl;
+        }
+        this->out.open(outPath, numDone > 0 ? std::ios::app : std::ios::trunc);
+        if (!this->out.is_open()) {
+            std::cerr << "could not write " << outPath << std::endl;
+            return false;
+        }
+        this->numWritten = numDone;
+        this->lastCheckpoint = std::chrono::steady_clock::now();
+
+        // the remaining positions, block by block, each block longest expected search first
+        this->schedule.clear();
+        this->schedule.reserve(this->positions.size() - numDone - this->pending.size());
+        for (auto blockStart = numDone; blockStart < this->positions.size(); blockStart += POSITION_BLOCK_SIZE) {
+            const auto blockEnd = std::min<uint64_t>(this->positions.size(), blockStart + POSITION_BLOCK_SIZE);
+            const auto first = this->schedule.size();
+            for (auto i = blockStart; i < blockEnd; ++i)
+                if (!this->pending.contains(i))
+                    this->schedule.push_back(i);
+            std::vector<double> costs(blockEnd - blockStart);
+            for (auto i = blockStart; i < blockEnd; ++i)
+                costs[i - blockStart] = this->get_expected_cost(this->positions[i]);
+            std::stable_sort(this->schedule.begin() + (long)first, this->schedule.end(),
+                             [&costs, blockStart](uint64_t a, uint64_t b) {
+                                 return costs[a - blockStart] > costs[b - blockStart];
+                             });
+        }
+
+        std::cout << "analyzing on " << this->numThreads << " threads with 2^" << this->numHashBits
+                  << " entry transposition tables: " << this->get_settings() << std::endl;
+        util::ProgressBar progressBar((int)this->schedule.size(), "Analyzing positions ", util::FRACTION);
+        progressBar.print();
+
+        this->nextPosition = 0;
+        std::atomic<int> numComplete = 0;
+        std::atomic<bool> printLock = false;
+        std::vector<std::thread> threads;
+        threads.reserve(this->numThreads);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < this->numThreads; ++t) {
+            threads.emplace_back([&, t]() {
+                engine::Engine engine(this->numHashBits);
+                engine.set_search_options(this->searchOptions);
+                engine.set_evaluation_weights(this->weights);
+                engine.set_opening_book(this->book);
+                auto &limits = *this->limits[t];
+
+                for (auto s = this->nextPosition++; s < this->schedule.size(); s = this->nextPosition++) {
+                    limits.reset();
+                    if (this->maxDepth > 0)
+                        limits.set_depth_limit(this->maxDepth);
+                    if (this->maxTime > 0)
+                        limits.set_time_limit(this->maxTime);
+                    if (this->maxNodes > 0)
+                        limits.set_node_limit(this->maxNodes);
+
+                    // stop() sets the flag before it stops the limits, so a stop that the reset undid is seen here
+                    if (this->stopping)
+                        break;
+
+                    long long nodes = 0;
+                    engine.update();
+                    auto line = this->analyze(engine, this->schedule[s], limits, &nodes);
+                    if (this->stopping)
+                        break;  // the search may have been cut short
+                    this->add_result(this->schedule[s], std::move(line), nodes);
+
+                    // print progress
+                    ++numComplete;
+                    if (!printLock) {
+                        printLock = true;
+                        progressBar.update(numComplete);
+                        printLock = false;
+                    }
+                }
+            });
+        }
+        for (auto &thread: threads)
+            thread.join();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        bool isWritten = this->write_checkpoint();
+        this->out.close();
+
+        std::cout << "analyzed " << numComplete << " positions in " << util::format_time(duration) << ", "
+                  << util::format_number(this->numNodes * 1000 / std::max(1LL, (long long)duration)) << " nodes/s. "
+                  << this->numWritten << " of " << this->positions.size() << " positions are in " << outPath
+                  << std::endl;
+        return isWritten && this->numWritten == this->positions.size();
+    }
+
+    void BatchAnalyzer::stop() {
+        this->stopping = true;
+        for (auto &l: this->limits)
+            l->stop();
+    }
+
+    std::string BatchAnalyzer::analyze(engine::Engine &engine, uint64_t index, engine::SearchLimits &limits,
+                                       long long *numNodes) const {
+        auto &position = this->positions[index];
+        auto &board = position.board;
+
+        // a side that has to pass is scored by the search of its opponent
+        engine::SearchResult result(PASS, board.get_disc_difference());
+        result.mode = engine::SearchMode::EXACT;
+        if (board.get_legal_moves() != 0) {
+            result = engine.search(Game(board), limits, engine::Engine::Verbose::NONE);
+        } else if (!board.is_terminal()) {
+            result = engine.search(Game(board.pass_and_copy()), limits, engine::Engine::Verbose::NONE);
+            result.value = -result.value;
+            result.move = PASS;
+        }
+        *numNodes = result.numNodes;
+
+        std::ostringstream os;
+        os << "{\"index\": " << index;
+        if (position.game != BatchPosition::NO_GAME) {
+            os << ", \"game\": " << position.game << ", \"ply\": " << (int)position.ply << ", \"played\": \""
+               << Move(position.played, 0).to_string() << "\"";
+        }
+        os << ", \"board\": \"" << to_string(position) << "\", \"move\": \"" << result.move.to_string()
+           << "\", \"value\": " << result.value << ", \"mode\": \""
+           << (result.mode == engine::SearchMode::EXACT ? "exact" : result.mode == engine::SearchMode::WLD ? "wld"
+                                                                                                          : "midgame")
+           << "\", \"depth\": " << result.depth << ", \"nodes\": " << result.numNodes << ", \"time_ms\": "
+           << result.duration << "}";
+        return os.str();
+    }
+
+    void BatchAnalyzer::add_result(uint64_t index, std::string line, long long nodes) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->numNodes += nodes;
+        this->pending.emplace(index, std::move(line));
+
+        // write every result whose predecessors are all written
+        for (auto it = this->pending.begin(); it != this->pending.end() && it->first == this->numWritten;
+             it = this->pending.erase(it)) {
+            this->out << it->second << '\n';
+            ++this->numWritten;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - this->lastCheckpoint).count() >= CHECKPOINT_INTERVAL)
+            this->write_checkpoint();
+    }
+
+    bool BatchAnalyzer::write_checkpoint() {
+        this->lastCheckpoint = std::chrono::steady_clock::now();
+
+        // the output must hold everything the checkpoint counts before the checkpoint says so
+        this->out.flush();
+        std::error_code error;
+        auto outputSize = std::filesystem::file_size(this->outPath, error);
+        if (this->out.fail() || error) {
+            std::cerr << "could not write " << this->outPath << std::endl;
+            return false;
+        }
+
+        const auto checkpointPath = get_checkpoint_path(this->outPath);
+        const auto tmpPath = checkpointPath + ".tmp";
+        std::ofstream file(tmpPath);
+        file << "# batch analysis checkpoint of " << this->outPath << "\n";
+        file << "input " << this->inputFile << "\n";
+        file << "input-size " << this->inputSize << "\n";
+        file << "positions " << this->positions.size() << "\n";
+        file << "settings " << this->get_settings() << "\n";
+        file << "done " << this->numWritten << "\n";
+        file << "output-size " << outputSize << "\n";
+        for (auto &[index, line]: this->pending)
+            file << "result " << index << " " << line << "\n";
+        file.close();
+
+        // rename the finished file over the old one, so an interruption never leaves a partial checkpoint
+        if (file.fail() || std::rename(tmpPath.c_str(), checkpointPath.c_str()) != 0) {
+            std::cerr << "could not write " << checkpointPath << std::endl;
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool BatchAnalyzer::read_checkpoint(uint64_t *numDone, uint64_t *outputSize) {
+        *numDone = 0;
+        *outputSize = 0;
+        this->pending.clear();
+        const auto checkpointPath = get_checkpoint_path(this->outPath);
+        std::ifstream file(checkpointPath);
+        if (!file.is_open())
+            return true;  // nothing to resume
+
+        // one value per line: its name, a space, then the value. Lines starting with # are comments
+        std::string input, settings;
+        uint64_t inputSize = 0, numPositions = 0;
+        std::map<uint64_t, std::string> results;
+        bool hasDone = false, hasOutputSize = false;
+        std::string line;
+        while (std::getline(file, line)) {
+            auto space = line.find(' ');
+            if (line.empty() || line[0] == '#' || space == std::string::npos)
+                continue;
+            auto name = line.substr(0, space);
+            auto value = line.substr(space + 1);
+            try {
+                if (name == "input")
+                    input = value;
+                else if (name == "input-size")
+                    inputSize = std::stoull(value);
+                else if (name == "positions")
+                    numPositions = std::stoull(value);
+                else if (name == "settings")
+                    settings = value;
+                else if (name == "done")
+                    *numDone = std::stoull(value), hasDone = true;
+                else if (name == "output-size")
+                    *outputSize = std::stoull(value), hasOutputSize = true;
+                else if (name == "result")
+                    results[std::stoull(value)] = value.substr(value.find(' ') + 1);
+            } catch (const std::exception &) {
+                hasDone = false;
+                break;
+            }
+        }
+        if (!hasDone || !hasOutputSize) {
+            std::cerr << "invalid checkpoint " << checkpointPath << std::endl;
+            return false;
+        }
+
+        if (input != this->inputFile || inputSize != this->inputSize || numPositions != this->positions.size() ||
+            settings != this->get_settings()) {
+            std::cerr << checkpointPath << " is the checkpoint of another input or other settings:\n  " << input
+                      << ", " << settings << "\nDelete it or write to another file to start over" << std::endl;
+            return false;
+        }
+
+        std::error_code error;
+        auto size = std::filesystem::file_size(this->outPath, error);
+        if (error || size < *outputSize) {
+            std::cerr << this->outPath << " is shorter than its checkpoint says" << std::endl;
+            return false;
+        }
+
+        // results that were done but still waiting for earlier positions
+        for (auto &[index, line]: results)
+            if (index >= *numDone && index < this->positions.size())
+                this->pending.emplace(index, std::move(line));
+        return true;
+    }
+}
@@ -0,0 +1,149 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_BATCHANALYZER_H
+#define OTHELLO_BATCHANALYZER_H
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../Engine/Engine.h"
+
+namespace tools {
+
+    /**
+     * @brief a position to analyze, with where it came from
+     */
+    struct BatchPosition {
+        static constexpr uint32_t NO_GAME = 0xffffffff;
+
+        Board board;                 // the side to move is P
+        uint32_t game = NO_GAME;     // index of the game the position is from, or NO_GAME if it was read as a position
+        uint8_t ply = 0;             // number of moves played before the position in its game
+        uint8_t played = 64;         // move played from the position in its game, 64 if there is none
+        bool isBlackToMove = true;
+    };
+
+    /**
+     * @brief searches a large set of positions on every core and writes one JSON line per position.
+     *
+     * Each thread has an engine of its own, with a transposition table sized so that all of them fit in the memory
+     * given. The positions are split into blocks, and each block is searched longest expected search first, so that
+     * no thread is left with a long search while the others are idle. The results are written in the order of the
+     * input as soon as every position before them is done, so at most about a block of results is held in memory.
+     *
+     * Next to the output there is a checkpoint with the number of positions written, the size of the output at that
+     * point and the results still waiting for earlier positions. A run that finds a checkpoint for the same input and
+     * settings truncates the output to it and carries on from there, so an interrupted run loses at most the searches
+     * that were running.
+     */
+    class BatchAnalyzer {
+    public:
+        /**
+         * @param numThreads: number of engines searching in parallel
+         * @param numHashBits: size of each engine's transposition table, as a power of 2 number of entries
+         */
+        BatchAnalyzer(int numThreads, int numHashBits);
+
+        /**
+         * @brief the largest transposition tables that fit in a memory budget
+         * @param memory: memory for all the tables together, in MB
+         * @param numThreads: number of tables
+         * @return the size of each table, as a power of 2 number of entries
+         */
+        static int get_hash_bits(long long memory, int numThreads);
+
+        /**
+         * @brief limit the search of each position. At least one limit should be set
+         * @param maxDepth: maximum depth, or 0 for no depth limit
+         * @param maxTime: seconds per position, or 0 for no time limit
+         * @param maxNodes: nodes per position, or 0 for no node limit
+         */
+        void set_limits(int maxDepth, double maxTime, long long maxNodes);
+
+        void set_search_options(const engine::SearchOptions& options);
+
+        /**
+         * @brief search with other weights than the default ones
+         * @param filepath: midgame weight file
+         * @return whether the weights were loaded
+         */
+        bool load_weights(const std::string& filepath);
+
+        /**
+         * @brief play book moves without searching
+         * @param filepath: opening book
+         * @return whether the book was loaded
+         */
+        bool load_book(const std::string& filepath);
+
+        /**
+         * @brief read the positions to analyze. A WTHOR database (.wtb) is read as games; in a text file, each line
+         * is either a position or a game:
+         *  - a position is 64 squares from a1 to h8, X or * for black, O for white and - or . for empty, followed by
+         *    the side to move, like "---------------------------OX------XO--------------------------- X"
+         *  - a game is a transcript (f5d6c3...) or a logbook line (+f5-d6+c3...:score)
+         * Every position of a game that has a move played from it is analyzed.
+         * @param filepath: the file
+         * @return whether there are positions to analyze
+         */
+        bool load_positions(const std::string& filepath);
+
+        /**
+         * @brief analyze the positions, resuming from the checkpoint of an earlier run if there is one
+         * @param outPath: output file, one JSON object per line in the order of the positions
+         * @return whether every position was analyzed and written
+         */
+        bool run(const std::string& outPath);
+
+        /**
+         * @brief stop the searches and write the results that are done. Safe to call from any thread.
+         */
+        void stop();
+
+    private:
+        [[nodiscard]] std::string analyze(engine::Engine& engine, uint64_t index, engine::SearchLimits& limits,
+                                          long long* numNodes) const;
+        [[nodiscard]] double get_expected_cost(const BatchPosition& position) const;
+        [[nodiscard]] std::string get_settings() const;
+        void add_result(uint64_t index, std::string line, long long nodes);
+        bool write_checkpoint();
+        bool read_checkpoint(uint64_t* numDone, uint64_t* outputSize);
+
+        int numThreads;
+        int numHashBits;
+        int maxDepth = 14;
+        double maxTime = 0;
+        long long maxNodes = 0;
+        engine::SearchOptions searchOptions;
+        std::string weightFile;
+        std::string bookFile;
+        std::shared_ptr<const engine::eval::EvaluationWeights> weights;
+        std::shared_ptr<const engine::OpeningBook> book;
+
+        std::string inputFile;
+        uint64_t inputSize = 0;
+        std::vector<BatchPosition> positions;
+
+        std::vector<uint64_t> schedule;  // the positions left to analyze, in the order they are searched
+        std::atomic<uint64_t> nextPosition = 0;
+        std::atomic<bool> stopping = false;
+        std::vector<std::unique_ptr<engine::SearchLimits>> limits;  // the limits of each thread's search
+
+        std::mutex mutex;                             // guards everything below
+        std::map<uint64_t, std::string> pending;      // results waiting for the positions before them
+        uint64_t numWritten = 0;                      // positions written to the output, in order
+        std::ofstream out;
+        std::string outPath;
+        std::chrono::steady_clock::time_point lastCheckpoint;
+        long long numNodes = 0;
+    };
+}
+
+#endif //OTHELLO_BATCHANALYZER_H
@@ -0,0 +1,104 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include "BatchAnalyzer.h"
+#include "../Init.h"
+
+/**
+ * usage: OthelloAnalyze --input PATH [--out PATH] [--threads N] [--depth N] [--time SECONDS] [--nodes N]
+ *                       [--memory MB] [--hash-bits N] [--weights PATH] [--book PATH]
+ *                       [--mpc on|off] [--etc on|off] [--lock-tt on|off] [--mpc-depth N] [--etc-depth N]
+ *
+ * A depth, time or node limit of 0 means no limit. --hash-bits sets the size of each thread's transposition table
+ * instead of dividing --memory between the threads.
+ */
+int main(int argc, char *argv[]) {
+    std::string inputPath;
+    std::string outPath = "analysis.jsonl";
+    int numThreads = (int)std::thread::hardware_concurrency();
+    int maxDepth = 14;
+    double maxTime = 0;
+    long long maxNodes = 0;
+    long long memory = 2048;
+    int numHashBits = 0;
+    std::string weightPath;
+    std::string bookPath;
+    engine::SearchOptions searchOptions;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        if (arg == "--input")
+            inputPath = argv[++i];
+        else if (arg == "--out")
+            outPath = argv[++i];
+        else if (arg == "--threads")
+            numThreads = std::stoi(argv[++i]);
+        else if (arg == "--depth")
+            maxDepth = std::stoi(argv[++i]);
+        else if (arg == "--time")
+            maxTime = std::stod(argv[++i]);
+        else if (arg == "--nodes")
+            maxNodes = std::stoll(argv[++i]);
+        else if (arg == "--memory")
+            memory = std::stoll(argv[++i]);
+        else if (arg == "--hash-bits")
+            numHashBits = std::stoi(argv[++i]);
+        else if (arg == "--weights")
+            weightPath = argv[++i];
+        else if (arg == "--book")
+            bookPath = argv[++i];
+        else if (searchOptions.set(arg.substr(2), argv[i + 1]))
+            ++i;
+        else {
+            std::cerr << "unknown argument or invalid value " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (inputPath.empty()) {
+        std::cerr << "missing --input" << std::endl;
+        return 1;
+    }
+    if (maxDepth <= 0 && maxTime <= 0 && maxNodes <= 0) {
+        std::cerr << "set a depth, time or node limit" << std::endl;
+        return 1;
+    }
+
+    init();
+
+    numThreads = std::max(1, numThreads);
+    if (numHashBits <= 0)
+        numHashBits = tools::BatchAnalyzer::get_hash_bits(memory, numThreads);
+    tools::BatchAnalyzer analyzer(numThreads, numHashBits);
+    analyzer.set_limits(maxDepth, maxTime, maxNodes);
+    analyzer.set_search_options(searchOptions);
+    if ((!weightPath.empty() && !analyzer.load_weights(weightPath)) ||
+        (!bookPath.empty() && !analyzer.load_book(bookPath)) || !analyzer.load_positions(inputPath))
+        return 1;
+
+    // on ctrl-c, stop the searches and checkpoint what is written, so that running again resumes. The signals are
+    // blocked in every thread and taken by a thread of their own, since stop() isn't safe in a signal handler.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread([&analyzer, signals]() {
+        int signal;
+        sigwait(&signals, &signal);
+        std::cout << "stopping..." << std::endl;
+        analyzer.stop();
+    }).detach();
+
+    return analyzer.run(outPath) ? 0 : 1;
+}
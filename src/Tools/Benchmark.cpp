@@ -0,0 +1,447 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+namespace tools {
+
+    // seed for the random playout corpus. Don't change it, or old results stop being comparable.
+    constexpr uint64_t CORPUS_SEED = 0x0DDBA11C0FFEEULL;
+
+    /**
+     * @brief keep the compiler from optimizing away a value that is otherwise never read
+     */
+    template<typename T>
+    inline void do_not_optimize(T& value) {
+        asm volatile("" : : "r"(&value) : "memory");
+    }
+
+    Benchmark::Benchmark(int numGames, int numRepetitions, std::string filter, int searchDepth, int numSearchPositions) :
+            numGames(numGames),
+            numRepetitions(std::max(1, numRepetitions)),
+            filter(std::move(filter)),
+            searchDepth(searchDepth),
+            numSearchPositions(numSearchPositions) {}
+
+    void Benchmark::set_search_options(const engine::SearchOptions &options) {
+        this->engine.set_search_options(options);
+    }
+
+    void Benchmark::load_corpus(const std::string& logbookPath) {
+        this->games.clear();
+        this->games.reserve(this->numGames);
+
+        std::ifstream logbook(logbookPath);
+        std::string line;
+        while (logbook && (int)this->games.size() < this->numGames && std::getline(logbook, line)) {
+            if (!line.empty())
+                this->add_game(line);
+        }
+
+        if (this->games.empty()) {
+            std::cout << "could not read " << logbookPath << ", using random playouts" << std::endl;
+            this->corpusSource = "random";
+            std::mt19937_64 rng(CORPUS_SEED);
+            while ((int)this->games.size() < this->numGames)
+                this->add_random_game(rng);
+        } else {
+            this->corpusSource = "logbook";
+        }
+
+        this->build_positions();
+    }
+
+    void Benchmark::add_game(const std::string& transcript) {
+        // logbook lines look like +d3-c5+f6...:+12, where the signs give the colour of each move
+        std::string moveSequence;
+        for (char c: transcript) {
+            if (c == ':')
+                break;
+            if (c != '+' && c != '-')
+                moveSequence += c;
+        }
+
+        CorpusGame game;
+        Board board;
+        for (size_t i = 0; i + 1 < moveSequence.size(); i += 2) {
+            if (board.get_legal_moves() == 0) {
+                board.pass();
+                game.moves.push_back(PASS);
+            }
+
+            uint_fast8_t x = std::tolower(moveSequence[i]) - 'a' + ((moveSequence[i + 1] - '1') << 3);
+            if (x >= 64 || !(board.get_legal_moves() & (1ULL << x)))
+                break; // corrupt transcript, keep what we have so far
+
+            auto move = Move(board, x);
+            game.moves.push_back(move);
+            board.play_move(move);
+        }
+
+        if (!game.moves.empty())
+            this->games.push_back(game);
+    }
+
+    void Benchmark::add_random_game(std::mt19937_64& rng) {
+        CorpusGame game;
+        Board board;
+
+        while (!board.is_terminal()) {
+            auto legalMoves = board.get_legal_moves();
+            if (legalMoves == 0) {
+                board.pass();
+                game.moves.push_back(PASS);
+                continue;
+            }
+
+            // pick the n-th legal move. Uses the raw generator output so the corpus is the same on every platform
+            auto n = rng() % __builtin_popcountll(legalMoves);
+            while (n--)
+                legalMoves &= legalMoves - 1;
+
+            auto move = Move(board, __builtin_ctzll(legalMoves));
+            game.moves.push_back(move);
+            board.play_move(move);
+        }
+
+        this->games.push_back(game);
+    }
+
+    void Benchmark::build_positions() {
+        this->positions.clear();
+        this->moves.clear();
+        this->nodes.clear();
+
+        for (auto &game: this->games) {
+            Board board = game.start;
+            for (auto &move: game.moves) {
+                if (move.is_pass()) {
+                    board.pass();
+                    continue;
+                }
+                this->positions.push_back(board);
+                this->moves.push_back(move);
+                board.play_move(move);
+            }
+        }
+
+        this->nodes.reserve(this->positions.size());
+        for (auto &board: this->positions)
+            this->nodes.emplace_back(board);
+    }
+
+    template<typename Kernel>
+    void Benchmark::time_kernel(const std::string &name, long long numOps, Kernel kernel) {
+        if (numOps <= 0 || (!this->filter.empty() && name.find(this->filter) == std::string::npos))
+            return;
+
+        // warm up caches and branch predictors
+        kernel();
+
+        std::vector<double> samples;
+        samples.reserve(this->numRepetitions);
+        for (int i = 0; i < this->numRepetitions; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            kernel();
+            auto end = std::chrono::steady_clock::now();
+            samples.push_back((double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double)numOps);
+        }
+
+        KernelTiming timing;
+        timing.name = name;
+        timing.numOps = numOps;
+        timing.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / (double)samples.size();
+
+        double variance = 0;
+        for (double s: samples)
+            variance += (s - timing.mean) * (s - timing.mean);
+        timing.stddev = samples.size() > 1 ? std::sqrt(variance / (double)(samples.size() - 1)) : 0;
+
+        std::sort(samples.begin(), samples.end());
+        timing.min = samples.front();
+        timing.median = samples.size() & 1 ? samples[samples.size() / 2]
+                                           : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+
+        this->results.push_back(timing);
+    }
+
+    void Benchmark::run() {
+        this->results.clear();
+        std::cout << "\033[1mCorpus:\033[0m " << this->games.size() << " games, " << this->positions.size()
+                  << " positions (" << this->corpusSource << ")" << std::endl;
+
+        this->bench_board();
+        this->bench_evaluation();
+        this->bench_transposition_table();
+        this->bench_last_n();
+        this->bench_search();
+    }
+
+    void Benchmark::bench_board() {
+        const auto numPositions = (long long)this->positions.size();
+        const auto numMoves = (long long)this->moves.size();
+
+        this->time_kernel("Board::get_legal_moves", numPositions, [this]() {
+            uint64_t acc = 0;
+            for (auto &board: this->positions)
+                acc ^= board.get_legal_moves();
+            do_not_optimize(acc);
+        });
+
+        this->time_kernel("Board::get_flipped", numMoves, [this]() {
+            uint64_t acc = 0;
+            for (size_t i = 0; i < this->moves.size(); ++i)
+                acc ^= this->positions[i].get_flipped(this->moves[i].x);
+            do_not_optimize(acc);
+        });
+
+        this->time_kernel("Board::count_n_flipped", numMoves, [this]() {
+            int acc = 0;
+            for (size_t i = 0; i < this->moves.size(); ++i)
+                acc += Board::count_n_flipped(this->positions[i].P, this->moves[i].x);
+            do_not_optimize(acc);
+        });
+
+        this->time_kernel("eval::get_potential_mobility", numPositions, [this]() {
+            int acc = 0;
+            for (auto &board: this->positions)
+                acc += engine::eval::get_potential_mobility(board.P, board.O);
+            do_not_optimize(acc);
+        });
+    }
+
+    void Benchmark::bench_evaluation() {
+        using engine::eval::EvaluationFeatures;
+        const auto numPositions = (long long)this->positions.size();
+        const auto numMoves = (long long)this->moves.size();
+
+        this->time_kernel("EvaluationFeatures::calc_features", numPositions, [this]() {
+            EvaluationFeatures features;
+            for (auto &board: this->positions) {
+                features.calc_features(&board);
+                do_not_optimize(features);
+            }
+        });
+
+        // replay whole games so play_move and undo_move see realistic sequences of feature updates
+        std::vector<EvaluationFeatures> startFeatures, endFeatures;
+        startFeatures.reserve(this->games.size());
+        endFeatures.reserve(this->games.size());
+        for (auto &game: this->games) {
+            startFeatures.emplace_back(&game.start);
+            EvaluationFeatures features(&game.start);
+            for (auto &move: game.moves) {
+                if (move.is_pass())
+                    features.pass();
+                else
+                    features.play_move(&move);
+            }
+            endFeatures.push_back(features);
+        }
+
+        this->time_kernel("EvaluationFeatures::play_move", numMoves, [this, &startFeatures]() {
+            for (size_t g = 0; g < this->games.size(); ++g) {
+                auto features = startFeatures[g];
+                for (auto &move: this->games[g].moves) {
+                    if (move.is_pass())
+                        features.pass();
+                    else
+                        features.play_move(&move);
+                }
+                do_not_optimize(features);
+            }
+        });
+
+        this->time_kernel("EvaluationFeatures::undo_move", numMoves, [this, &endFeatures]() {
+            for (size_t g = 0; g < this->games.size(); ++g) {
+                auto features = endFeatures[g];
+                auto &gameMoves = this->games[g].moves;
+                for (auto move = gameMoves.rbegin(); move != gameMoves.rend(); ++move) {
+                    if (move->is_pass())
+                        features.pass();
+                    else
+                        features.undo_move(&*move);
+                }
+                do_not_optimize(features);
+            }
+        });
+
+        this->time_kernel("EvaluationFeatures::mid_evaluate", numPositions, [this]() {
+            int acc = 0;
+            for (auto &node: this->nodes)
+                acc += node.evalFeatures.mid_evaluate(&node);
+            do_not_optimize(acc);
+        });
+
+        this->time_kernel("EvaluationFeatures::end_evaluate_move_ordering", numPositions, [this]() {
+            int acc = 0;
+            for (auto &node: this->nodes)
+                acc += node.evalFeatures.end_evaluate_move_ordering(&node);
+            do_not_optimize(acc);
+        });
+    }
+
+    void Benchmark::bench_transposition_table() {
+        const auto numPositions = (long long)this->positions.size();
+        auto &tt = this->engine.transpositionTable;
+
+        std::vector<uint32_t> hashes;
+        hashes.reserve(this->positions.size());
+        for (auto &board: this->positions)
+            hashes.push_back(engine::TranspositionTable::get_hash(&board));
+
+        this->time_kernel("TranspositionTable::get_hash", numPositions, [this]() {
+            uint32_t acc = 0;
+            for (auto &board: this->positions)
+                acc ^= engine::TranspositionTable::get_hash(&board);
+            do_not_optimize(acc);
+        });
+
+        this->time_kernel("TranspositionTable::store", numPositions, [this, &tt, &hashes]() {
+            for (size_t i = 0; i < this->nodes.size(); ++i)
+                tt.store(&this->nodes[i], hashes[i], 10, -SCORE_MAX, SCORE_MAX, (int)(i & 31) - 16, this->moves[i].x);
+            do_not_optimize(tt);
+        });
+
+        // every position was just stored, so this measures the hit path
+        this->time_kernel("TranspositionTable::load", numPositions, [this, &tt, &hashes]() {
+            int acc = 0;
+            for (size_t i = 0; i < this->nodes.size(); ++i) {
+                int lower = -SCORE_MAX, upper = SCORE_MAX;
+                uint_fast8_t hashMoves[2] = {MOVE_UNDEFINED.x, MOVE_UNDEFINED.x};
+                tt.load(&this->nodes[i], hashes[i], 10, &lower, &upper, hashMoves);
+                acc += lower + upper + hashMoves[0];
+            }
+            do_not_optimize(acc);
+        });
+
+        tt.clear();
+    }
+
+    void Benchmark::bench_last_n() {
+        // collect the positions with one and two empty squares from the corpus
+        std::vector<Board> last1Boards, last2Boards;
+        for (auto &board: this->positions) {
+            if (board.get_disc_count() == 63)
+                last1Boards.push_back(board);
+            else if (board.get_disc_count() == 62)
+                last2Boards.push_back(board);
+        }
+
+        auto node = engine::SearchNode(Board());
+
+        this->time_kernel("Engine::last1", (long long)last1Boards.size(), [this, &last1Boards, &node]() {
+            int acc = 0;
+            for (auto &board: last1Boards)
+                acc += this->engine.last1(&node, __builtin_ctzll(~(board.P | board.O)), board.P);
+            do_not_optimize(acc);
+        });
+
+        this->time_kernel("Engine::last2", (long long)last2Boards.size(), [this, &last2Boards, &node]() {
+            int acc = 0;
+            for (auto &board: last2Boards) {
+                auto empty = ~(board.P | board.O);
+                uint_fast8_t x1 = __builtin_ctzll(empty);
+                uint_fast8_t x2 = __builtin_ctzll(empty & (empty - 1));
+                acc += this->engine.last2(&node, -SCORE_MAX, SCORE_MAX, x1, x2, board);
+            }
+            do_not_optimize(acc);
+        });
+    }
+
+    void Benchmark::bench_search() {
+        this->searchResult = SearchTiming();
+        if (this->numSearchPositions <= 0 || this->searchDepth <= 0 ||
+            (!this->filter.empty() && std::string("Engine::search_to_depth").find(this->filter) == std::string::npos))
+            return;
+
+        // take one midgame position from each game, spread over 20 to 40 discs
+        std::vector<Board> searchBoards;
+        for (size_t g = 0; g < this->games.size() && (int)searchBoards.size() < this->numSearchPositions; ++g) {
+            auto targetDiscs = 20 + (int)(g % 21);
+            Board board = this->games[g].start;
+            for (auto &move: this->games[g].moves) {
+                if (board.get_disc_count() >= targetDiscs)
+                    break;
+                if (move.is_pass())
+                    board.pass();
+                else
+                    board.play_move(move);
+            }
+            if (board.get_disc_count() == targetDiscs && board.get_legal_moves())
+                searchBoards.push_back(board);
+        }
+
+        this->engine.clear_transposition_table();
+        auto start = std::chrono::steady_clock::now();
+        for (auto &board: searchBoards) {
+            this->engine.update();
+            auto result = this->engine.search_to_depth(Game(board), this->searchDepth, engine::Engine::Verbose::NONE);
+            this->searchResult.numNodes += result.numNodes;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        this->searchResult.depth = this->searchDepth;
+        this->searchResult.numPositions = (int)searchBoards.size();
+        this->searchResult.duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    }
+
+    void Benchmark::print_results() const {
+        std::cout << "\033[1mResults (ns/op):\033[0m\n";
+        std::cout << std::left << std::setw(48) << "kernel" << std::right
+                  << std::setw(12) << "mean" << std::setw(12) << "stddev"
+                  << std::setw(12) << "median" << std::setw(12) << "min" << '\n';
+        for (auto &r: this->results) {
+            std::cout << std::left << std::setw(48) << r.name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(12) << r.mean << std::setw(12) << r.stddev
+                      << std::setw(12) << r.median << std::setw(12) << r.min << '\n';
+        }
+        if (this->searchResult.numPositions > 0) {
+            std::cout << "\033[1mSearch to depth " << this->searchResult.depth << ":\033[0m "
+                      << this->searchResult.numPositions << " positions, "
+                      << util::format_number(this->searchResult.numNodes) << " nodes, "
+                      << util::format_time(this->searchResult.duration) << " ("
+                      << this->engine.get_search_options().to_string() << ")\n";
+        }
+        std::cout << std::flush;
+    }
+
+    void Benchmark::write_json(std::ostream &os) const {
+        // corpus checksum, so that two result files can be checked for having used the same positions
+        uint64_t checksum = 0xcbf29ce484222325ULL;
+        for (auto &board: this->positions) {
+            checksum = (checksum ^ board.P) * 0x100000001b3ULL;
+            checksum = (checksum ^ board.O) * 0x100000001b3ULL;
+        }
+
+        // one kernel per line keeps the output easy to diff
+        os << "{\n";
+        os << "  \"corpus\": {\"source\": \"" << this->corpusSource << "\", \"games\": " << this->games.size()
+           << ", \"positions\": " << this->positions.size() << ", \"checksum\": \"" << std::hex << checksum
+           << std::dec << "\"},\n";
+        os << "  \"repetitions\": " << this->numRepetitions << ",\n";
+        os << "  \"kernels\": [\n";
+        os << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < this->results.size(); ++i) {
+            auto &r = this->results[i];
+            os << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.numOps
+               << ", \"mean_ns\": " << r.mean << ", \"stddev_ns\": " << r.stddev
+               << ", \"median_ns\": " << r.median << ", \"min_ns\": " << r.min << "}"
+               << (i + 1 < this->results.size() ? ",\n" : "\n");
+        }
+        os << "  ],\n";
+        os << "  \"search\": {\"depth\": " << this->searchResult.depth
+           << ", \"options\": \"" << this->engine.get_search_options().to_string() << "\""
+           << ", \"positions\": " << this->searchResult.numPositions
+           << ", \"nodes\": " << this->searchResult.numNodes
+           << ", \"time_ms\": " << this->searchResult.duration << "}\n";
+        os << "}" << std::endl;
+    }
+}
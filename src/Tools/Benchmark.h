@@ -0,0 +1,105 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_BENCHMARK_H
+#define OTHELLO_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <random>
+#include "../Engine/Engine.h"
+
+namespace tools {
+
+    /**
+     * @brief timing summary for a single kernel. All times are in nanoseconds per operation.
+     */
+    struct KernelTiming {
+        std::string name;
+        long long numOps = 0;
+        double mean = 0;
+        double stddev = 0;
+        double min = 0;
+        double median = 0;
+    };
+
+    /**
+     * @brief total work to search a set of corpus positions to a fixed depth
+     */
+    struct SearchTiming {
+        int depth = 0;
+        int numPositions = 0;
+        long long numNodes = 0;
+        long long duration = 0;  // milliseconds
+    };
+
+    /**
+     * @brief microbenchmarks for the engine's hot kernels over a fixed corpus of positions.
+     * The corpus is taken from the first games of the logbook when it is available, and from seeded
+     * random playouts otherwise, so that results are comparable between commits on the same machine.
+     */
+    class Benchmark {
+    public:
+        /**
+         * @param numGames: number of corpus games
+         * @param numRepetitions: number of timed repetitions of each kernel
+         * @param filter: only kernels whose name contains this string are run
+         * @param searchDepth: depth of the fixed-depth search benchmark
+         * @param numSearchPositions: number of positions in the fixed-depth search benchmark
+         */
+        explicit Benchmark(int numGames = 2000, int numRepetitions = 10, std::string filter = "",
+                           int searchDepth = 10, int numSearchPositions = 50);
+
+        /**
+         * @brief build the corpus. Falls back on seeded random playouts if the logbook can't be read.
+         * @param logbookPath: path to a logbook file
+         */
+        void load_corpus(const std::string& logbookPath = LOGBOOK_FILEPATH);
+
+        /** @brief search features of the fixed-depth search benchmark */
+        void set_search_options(const engine::SearchOptions& options);
+
+        void run();
+        void print_results() const;
+        void write_json(std::ostream& os) const;
+
+    private:
+        struct CorpusGame {
+            Board start;
+            std::vector<Move> moves; // passes are stored as PASS
+        };
+
+        void add_game(const std::string& transcript);
+        void add_random_game(std::mt19937_64& rng);
+        void build_positions();
+
+        template<typename Kernel>
+        void time_kernel(const std::string& name, long long numOps, Kernel kernel);
+
+        void bench_board();
+        void bench_evaluation();
+        void bench_transposition_table();
+        void bench_last_n();
+        void bench_search();
+
+        int numGames;
+        int numRepetitions;
+        std::string filter;
+        int searchDepth;
+        int numSearchPositions;
+        std::string corpusSource;
+
+        std::vector<CorpusGame> games;
+        std::vector<Board> positions;    // the position before each non-pass corpus move
+        std::vector<Move> moves;         // the move played from each position
+        std::vector<engine::SearchNode> nodes;
+
+        std::vector<KernelTiming> results;
+        SearchTiming searchResult;
+        engine::Engine engine;
+    };
+}
+
+#endif //OTHELLO_BENCHMARK_H
@@ -0,0 +1,72 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "Benchmark.h"
+#include "../Init.h"
+
+/**
+ * usage: OthelloBench [--games N] [--reps N] [--filter NAME] [--logbook PATH] [--json PATH]
+ *                     [--search-depth N] [--search-positions N]
+ *                     [--mpc on|off] [--etc on|off] [--lock-tt on|off] [--mpc-depth N] [--etc-depth N]
+ */
+int main(int argc, char *argv[]) {
+    int numGames = 2000;
+    int numRepetitions = 10;
+    int searchDepth = 10;
+    int numSearchPositions = 50;
+    std::string filter;
+    std::string logbookPath = LOGBOOK_FILEPATH;
+    std::string jsonPath;
+    engine::SearchOptions searchOptions;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        if (arg == "--games")
+            numGames = std::stoi(argv[++i]);
+        else if (arg == "--reps")
+            numRepetitions = std::stoi(argv[++i]);
+        else if (arg == "--filter")
+            filter = argv[++i];
+        else if (arg == "--logbook")
+            logbookPath = argv[++i];
+        else if (arg == "--json")
+            jsonPath = argv[++i];
+        else if (arg == "--search-depth")
+            searchDepth = std::stoi(argv[++i]);
+        else if (arg == "--search-positions")
+            numSearchPositions = std::stoi(argv[++i]);
+        else if (arg.starts_with("--") && searchOptions.set(arg.substr(2), argv[i + 1]))
+            ++i;
+        else {
+            std::cerr << "unknown argument or invalid value " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    init();
+
+    tools::Benchmark benchmark(numGames, numRepetitions, filter, searchDepth, numSearchPositions);
+    benchmark.set_search_options(searchOptions);
+    benchmark.load_corpus(logbookPath);
+    benchmark.run();
+    benchmark.print_results();
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "could not open " << jsonPath << std::endl;
+            return 1;
+        }
+        benchmark.write_json(out);
+    }
+    return 0;
+}
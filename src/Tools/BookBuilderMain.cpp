@@ -0,0 +1,47 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <iostream>
+#include <string>
+#include "../Engine/Book/OpeningBook.h"
+
+/**
+ * usage: OthelloBook [--logbook PATH] [--out PATH] [--max-ply N] [--min-count N]
+ *
+ * --logbook takes a .gam logbook or a WTHOR .wtb database
+ */
+int main(int argc, char *argv[]) {
+    std::string logbookPath = LOGBOOK_FILEPATH;
+    std::string bookPath = BOOK_FILEPATH;
+    int maxPly = BOOK_MAX_PLY;
+    int minCount = BOOK_MIN_COUNT;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        if (arg == "--logbook")
+            logbookPath = argv[++i];
+        else if (arg == "--out")
+            bookPath = argv[++i];
+        else if (arg == "--max-ply")
+            maxPly = std::stoi(argv[++i]);
+        else if (arg == "--min-count")
+            minCount = std::stoi(argv[++i]);
+        else {
+            std::cerr << "unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (!engine::OpeningBook::build(logbookPath, bookPath, maxPly, minCount))
+        return 1;
+
+    // check that the book maps back in
+    engine::OpeningBook book;
+    return book.load(bookPath) ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "BookExpander.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <unordered_set>
+
+namespace tools {
+    BookExpander::BookExpander(std::string bookPath, int numThreads, int numHashBits, int depth, int maxDepth,
+                               int maxDiscs, int checkpointInterval) :
+            bookPath(std::move(bookPath)),
+            numThreads(std::max(1, numThreads)),
+            numHashBits(numHashBits),
+            depth(depth),
+            maxDepth(maxDepth),
+            maxDiscs(maxDiscs),
+            checkpointInterval(std::max(1, checkpointInterval)) {}
+
+    BookExpander::Key BookExpander::get_key(const Board &board) {
+        int symmetry;
+        auto canonical = engine::OpeningBook::canonicalize(board, &symmetry);
+        return {canonical.P, canonical.O};
+    }
+
+    bool BookExpander::load() {
+        std::vector<engine::OpeningBook::Entry> entries;
+        if (!engine::OpeningBook::read(this->bookPath, entries))
+            return false;
+
+        this->nodes.clear();
+        this->nodes.reserve(entries.size());
+        for (auto &entry: entries)
+            this->nodes[{entry.P, entry.O}] = {entry.move, entry.score, entry.depth, entry.count};
+
+        std::cout << "loaded " << this->nodes.size() << " book positions from " << this->bookPath << std::endl;
+        return true;
+    }
+
+    void BookExpander::run() {
+        this->workerLimits.assign(this->numThreads, nullptr);
+        this->shutdown = false;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < this->numThreads; ++i)
+            threads.emplace_back(&BookExpander::worker, this, i);
+
+        while (!this->stopping) {
+            auto work = this->collect_work();
+            if (work.empty()) {
+                if (this->depth + 2 > this->maxDepth)
+                    break;
+                this->depth += 2;
+                continue;
+            }
+
+            std::cout << "\033[1mDepth " << this->depth << ":\033[0m searching " << work.size() << " of "
+                      << this->nodes.size() << " book positions" << std::endl;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->queue.insert(this->queue.end(), work.begin(), work.end());
+            }
+            this->workAvailable.notify_all();
+
+            auto roundStart = std::chrono::steady_clock::now();
+            size_t numSearched = 0;
+            while (true) {
+                bool roundDone;
+                {
+                    std::unique_lock<std::mutex> lock(this->mutex);
+                    this->workDone.wait_for(lock, std::chrono::seconds(this->checkpointInterval), [this]() {
+                        return this->stopping || (this->queue.empty() && this->numBusy == 0);
+                    });
+                    roundDone = this->queue.empty() && this->numBusy == 0;
+                }
+
+                numSearched += this->merge_results();
+                this->checkpoint();
+
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - roundStart).count();
+                std::cout << "\t" << numSearched << "/" << work.size() << " positions, "
+                          << util::format_time(elapsed) << std::endl;
+                if (roundDone || this->stopping)
+                    break;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->shutdown = true;
+            this->queue.clear();
+        }
+        this->workAvailable.notify_all();
+        for (auto &thread: threads)
+            thread.join();
+
+        this->merge_results();
+        this->checkpoint();
+    }
+
+    void BookExpander::stop() {
+        this->stopping = true;
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->queue.clear();
+        for (auto limits: this->workerLimits)
+            if (limits != nullptr)
+                limits->stop();
+        this->workDone.notify_all();
+    }
+
+    std::vector<Board> BookExpander::collect_work() {
+        std::vector<Board> work;
+        std::unordered_set<Key, KeyHash> extensions;
+
+        for (auto &[key, node]: this->nodes) {
+            Board board(key.first, key.second);
+            auto child = board.move_and_copy(node.move);
+            auto childKey = BookExpander::get_key(child);
+            if (this->nodes.contains(childKey))
+                continue;  // not a leaf
+
+            if (node.depth < this->depth) {
+                work.push_back(board);
+            } else if (child.get_disc_count() < this->maxDiscs && child.get_legal_moves() &&
+                       extensions.insert(childKey).second) {
+                work.emplace_back(childKey.first, childKey.second);
+            }
+        }
+        return work;
+    }
+
+    void BookExpander::worker(int id) {
+        engine::Engine engine(this->numHashBits);
+        engine::SearchLimits limits;
+
+        while (true) {
+            Board board;
+            int searchDepth;
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->workerLimits[id] = &limits;
+                this->workAvailable.wait(lock, [this]() {
+                    return this->shutdown || !this->queue.empty();
+                });
+                if (this->queue.empty())
+                    break;
+
+                board = this->queue.front();
+                this->queue.pop_front();
+                ++this->numBusy;
+                searchDepth = this->depth;
+
+                // reset under the lock, so that a concurrent stop() can't be lost
+                limits.reset();
+                limits.set_depth_limit(searchDepth);
+            }
+
+            engine.update();
+            auto result = engine.search(Game(board), limits, engine::Engine::Verbose::NONE);
+
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                --this->numBusy;
+                if (!limits.is_stopped())
+                    this->results.push_back({board, (uint8_t)result.move.x, result.value});
+                this->workerLimits[id] = nullptr;
+            }
+            this->workDone.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->workerLimits[id] = nullptr;
+    }
+
+    size_t BookExpander::merge_results() {
+        std::vector<Result> batch;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            batch.swap(this->results);
+        }
+
+        for (auto &result: batch) {
+            auto &node = this->nodes[{result.board.P, result.board.O}];
+            node.move = engine::OpeningBook::canonicalize_move(result.board, result.board, result.move);
+            node.score = (int8_t)std::clamp(result.score, -SCORE_MAX, SCORE_MAX);
+            node.depth = (uint8_t)this->depth;
+        }
+        return batch.size();
+    }
+
+    int BookExpander::minimax(const Board &board, std::unordered_map<Key, int, KeyHash> &values) {
+        int symmetry;
+        auto canonical = engine::OpeningBook::canonicalize(board, &symmetry);
+        Key key{canonical.P, canonical.O};
+
+        auto it = this->nodes.find(key);
+        if (it == this->nodes.end())
+            return SCORE_UNDEFINED;
+        if (auto value = values.find(key); value != values.end())
+            return value->second;
+
+        auto &node = it->second;
+        int best = SCORE_UNDEFINED;
+        uint_fast8_t bestMove = node.move;
+        bool isBookMoveInBook = false;
+
+        auto legalMask = canonical.get_legal_moves();
+        for (auto mask = bit::lsb(legalMask); legalMask; mask = bit::next_set_bit(legalMask)) {
+            auto x = bit::bitboard_to_coord(mask);
+            auto value = this->minimax(canonical.move_and_copy(x), values);
+            if (value == SCORE_UNDEFINED)
+                continue;
+
+            if (engine::OpeningBook::canonicalize_move(canonical, canonical, x) == node.move)
+                isBookMoveInBook = true;
+            if (-value > best) {
+                best = -value;
+                bestMove = x;
+            }
+        }
+
+        if (best == SCORE_UNDEFINED) {
+            best = node.score;  // leaf
+        } else {
+            // a searched move that leaves the book can still be better than every move that stays in it
+            if (!isBookMoveInBook && node.depth > 0 && node.score > best) {
+                best = node.score;
+                bestMove = node.move;
+            }
+            node.move = engine::OpeningBook::canonicalize_move(canonical, canonical, bestMove);
+            node.score = (int8_t)best;
+        }
+
+        values[key] = best;
+        return best;
+    }
+
+    bool BookExpander::checkpoint() {
+        std::unordered_map<Key, int, KeyHash> values;
+        values.reserve(this->nodes.size());
+        this->minimax(Board(), values);
+
+        std::vector<engine::OpeningBook::Entry> entries;
+        entries.reserve(this->nodes.size());
+        for (auto &[key, node]: this->nodes)
+            entries.push_back({key.first, key.second, node.count, node.move, node.score, node.depth, 0});
+        return engine::OpeningBook::write(this->bookPath, entries);
+    }
+}
@@ -0,0 +1,113 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_BOOKEXPANDER_H
+#define OTHELLO_BOOKEXPANDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../Engine/Engine.h"
+
+namespace tools {
+
+    /**
+     * @brief deepens an opening book by searching its leaves in parallel.
+     *
+     * A leaf is a book position whose book move leads out of the book. Each round searches every leaf that was scored
+     * shallower than the target depth, and extends every other leaf by the position after its book move, so the book
+     * grows one move at a time along its own lines. Once a round leaves nothing to do, the target depth goes up by 2.
+     *
+     * The searches run on a pool of engines that each have their own transposition table. The main thread merges
+     * their results, minimaxes the book from the start position and rewrites the book file every checkpoint. All the
+     * state is in the book file, so an interrupted expansion picks up where it left off.
+     */
+    class BookExpander {
+    public:
+        /**
+         * @param bookPath: book file to expand. It is rewritten at every checkpoint
+         * @param numThreads: number of search threads
+         * @param numHashBits: transposition table size of each search thread, as a power of 2 number of entries
+         * @param depth: search depth of the first round
+         * @param maxDepth: stop once every leaf is searched to this depth
+         * @param maxDiscs: don't extend the book past positions with this many discs
+         * @param checkpointInterval: seconds between checkpoints
+         */
+        BookExpander(std::string bookPath, int numThreads, int numHashBits, int depth, int maxDepth, int maxDiscs,
+                     int checkpointInterval);
+
+        /**
+         * @brief read the book file
+         * @return whether the book was read
+         */
+        bool load();
+
+        /**
+         * @brief expand the book until it reaches the maximum depth or stop() is called
+         */
+        void run();
+
+        /**
+         * @brief interrupt the running searches and make run() checkpoint and return. Safe to call from any thread.
+         */
+        void stop();
+
+    private:
+        using Key = std::pair<uint64_t, uint64_t>;
+
+        struct KeyHash {
+            size_t operator()(const Key &key) const {
+                return engine::OpeningBook::get_bucket(key.first, key.second, 63);
+            }
+        };
+
+        struct Node {
+            uint8_t move;    // in the canonical orientation
+            int8_t score;
+            uint8_t depth;
+            uint32_t count;
+        };
+
+        struct Result {
+            Board board;     // canonical position
+            uint8_t move;
+            int score;
+        };
+
+        static Key get_key(const Board &board);
+
+        std::vector<Board> collect_work();
+        void worker(int id);
+        size_t merge_results();
+        int minimax(const Board &board, std::unordered_map<Key, int, KeyHash> &values);
+        bool checkpoint();
+
+        std::string bookPath;
+        int numThreads;
+        int numHashBits;
+        int depth;
+        int maxDepth;
+        int maxDiscs;
+        int checkpointInterval;
+
+        std::unordered_map<Key, Node, KeyHash> nodes;  // only touched by the thread that calls run()
+
+        std::mutex mutex;
+        std::condition_variable workAvailable;
+        std::condition_variable workDone;
+        std::deque<Board> queue;
+        std::vector<Result> results;
+        int numBusy = 0;
+        std::vector<engine::SearchLimits*> workerLimits;
+        std::atomic<bool> stopping = false;
+        bool shutdown = false;
+    };
+}
+
+#endif //OTHELLO_BOOKEXPANDER_H
@@ -0,0 +1,75 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include "BookExpander.h"
+#include "../Init.h"
+
+/**
+ * usage: OthelloBookExpander [--book PATH] [--threads N] [--hash-bits N] [--depth N] [--max-depth N]
+ *                            [--max-discs N] [--checkpoint SECONDS]
+ */
+int main(int argc, char *argv[]) {
+    std::string bookPath = BOOK_FILEPATH;
+    int numThreads = (int)std::thread::hardware_concurrency();
+    int numHashBits = 22;
+    int depth = 16;
+    int maxDepth = 30;
+    int maxDiscs = 40;
+    int checkpointInterval = 600;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        if (arg == "--book")
+            bookPath = argv[++i];
+        else if (arg == "--threads")
+            numThreads = std::stoi(argv[++i]);
+        else if (arg == "--hash-bits")
+            numHashBits = std::stoi(argv[++i]);
+        else if (arg == "--depth")
+            depth = std::stoi(argv[++i]);
+        else if (arg == "--max-depth")
+            maxDepth = std::stoi(argv[++i]);
+        else if (arg == "--max-discs")
+            maxDiscs = std::stoi(argv[++i]);
+        else if (arg == "--checkpoint")
+            checkpointInterval = std::stoi(argv[++i]);
+        else {
+            std::cerr << "unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    init();
+
+    tools::BookExpander bookExpander(bookPath, numThreads, numHashBits, depth, maxDepth, maxDiscs, checkpointInterval);
+    if (!bookExpander.load())
+        return 1;
+
+    // on ctrl-c, checkpoint and exit instead of losing the searches since the last checkpoint. The signals are
+    // blocked in every thread and taken by a thread of their own, since stop() isn't safe in a signal handler.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread([&bookExpander, signals]() {
+        int signal;
+        sigwait(&signals, &signal);
+        std::cout << "stopping..." << std::endl;
+        bookExpander.stop();
+    }).detach();
+
+    bookExpander.run();
+    return 0;
+}
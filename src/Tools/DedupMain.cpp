@@ -0,0 +1,61 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include "../Engine/Evaluation/PositionDataset.h"
+#include "../Init.h"
+
+/**
+ * usage: OthelloDedup --dataset NAME [--out NAME] [--augment 0|1] [--threads N]
+ *
+ * --dataset is a move dataset in COMBINED_DATASET_DIRECTORY. The unique positions are written next to it, to the
+ * dataset's name with POSITION_DATASET_EXTENSION unless --out is given, and can be trained on like any other dataset.
+ */
+int main(int argc, char *argv[]) {
+    std::string dataset;
+    std::string output;
+    bool augment = false;
+    int numThreads = (int)std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        if (arg == "--dataset")
+            dataset = argv[++i];
+        else if (arg == "--out")
+            output = argv[++i];
+        else if (arg == "--augment")
+            augment = std::stoi(argv[++i]) != 0;
+        else if (arg == "--threads")
+            numThreads = std::stoi(argv[++i]);
+        else {
+            std::cerr << "unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (dataset.empty()) {
+        std::cerr << "missing --dataset" << std::endl;
+        return 1;
+    }
+    if (!dataset.ends_with(MOVE_DATASET_EXTENSION)) {
+        std::cerr << "only move datasets (" MOVE_DATASET_EXTENSION ") can be deduplicated" << std::endl;
+        return 1;
+    }
+    if (output.empty())
+        output = dataset.substr(0, dataset.size() - std::string(MOVE_DATASET_EXTENSION).size()) +
+                 POSITION_DATASET_EXTENSION;
+
+    init();
+    engine::eval::MoveDataset moves;
+    if (!moves.load(COMBINED_DATASET_DIRECTORY + dataset))
+        return 1;
+    return engine::eval::PositionDataset::deduplicate(moves, COMBINED_DATASET_DIRECTORY + output, augment,
+                                                      numThreads) ? 0 : 1;
+}
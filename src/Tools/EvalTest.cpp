@@ -0,0 +1,274 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "EvalTest.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include "../Game/WthorDatabase.h"
+
+namespace tools {
+    // games a thread evaluates before taking the next chunk
+    constexpr uint64_t GAME_CHUNK_SIZE = 256;
+
+    double PhaseError::get_rmse() const {
+        return this->numPositions > 0 ? std::sqrt(this->sumSquaredError / (double)this->numPositions) : 0;
+    }
+
+    double PhaseError::get_mae() const {
+        return this->numPositions > 0 ? this->sumAbsoluteError / (double)this->numPositions : 0;
+    }
+
+    double PhaseError::get_bias() const {
+        return this->numPositions > 0 ? this->sumError / (double)this->numPositions : 0;
+    }
+
+    EvalTest::EvalTest(int numThreads) : numThreads(std::max(1, numThreads)) {}
+
+    bool EvalTest::load_weights(const std::string &filepath) {
+        auto evaluationWeights = std::make_unique<engine::eval::EvaluationWeights>();
+        if (!evaluationWeights->load(filepath)) {
+            std::cerr << "could not load weights " << filepath << std::endl;
+            return false;
+        }
+        this->weights = std::move(evaluationWeights);
+        this->weightFile = filepath;
+        return true;
+    }
+
+    bool EvalTest::load_games(const std::string &filepath) {
+        this->moves.clear();
+        this->gameStarts.assign(1, 0);
+        this->gameFile = filepath;
+
+        // only finished games are kept, since the final score is what the evaluation is compared against
+        uint64_t numSkipped = 0;
+        auto addGame = [this, &numSkipped](const uint8_t *squares, int numMoves) {
+            Board board;
+            for (int i = 0; i < numMoves; ++i) {
+                if (board.get_legal_moves() == 0)
+                    board.pass();
+                board.play_move(squares[i]);
+            }
+            if (numMoves == 0 || !board.is_terminal()) {
+                ++numSkipped;
+                return;
+            }
+            this->moves.insert(this->moves.end(), squares, squares + numMoves);
+            this->gameStarts.push_back(this->moves.size());
+        };
+
+        uint8_t squares[WthorDatabase::MAX_MOVES];
+        auto extension = std::filesystem::path(filepath).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+        if (extension == ".wtb") {
+            WthorDatabase database;
+            if (!database.load(filepath))
+                return false;
+            for (uint64_t i = 0; i < database.size(); ++i) {
+                auto game = database.get_game(i);
+                auto numMoves = WthorDatabase::decode(game, squares);
+                if (numMoves != game.get_num_moves()) {
+                    ++numSkipped;
+                    continue;
+                }
+                addGame(squares, numMoves);
+            }
+        } else {
+            std::ifstream file(filepath);
+            if (!file.is_open()) {
+                std::cerr << "could not open " << filepath << std::endl;
+                return false;
+            }
+
+            // transcripts (f5d6c3...) and logbook lines (+f5-d6+c3...:score) both work
+            std::string line;
+            while (std::getline(file, line)) {
+                Board board;
+                int numMoves = 0;
+                for (size_t i = 0; i + 1 < line.size() && numMoves < WthorDatabase::MAX_MOVES;) {
+                    char c = line[i];
+                    if (c == ':' || std::isspace((unsigned char)c))
+                        break;
+                    if (c == '+' || c == '-') {
+                        ++i;
+                        continue;
+                    }
+
+                    if (board.get_legal_moves() == 0)
+                        board.pass();
+                    auto x = (uint_fast8_t)(std::tolower(c) - 'a' + ((line[i + 1] - '1') << 3));
+                    if (x >= 64 || !(board.get_legal_moves() & (1ULL << x)))
+                        break;  // corrupt transcript, the game won't be finished
+                    board.play_move(x);
+                    squares[numMoves++] = x;
+                    i += 2;
+                }
+                if (numMoves > 0)
+                    addGame(squares, numMoves);
+            }
+        }
+
+        std::cout << "loaded " << this->gameStarts.size() - 1 << " games from " << filepath;
+        if (numSkipped > 0)
+            std::cout << ", skipped " << numSkipped << " unfinished or corrupt games";
+        std::cout << std::endl;
+        return this->gameStarts.size() > 1;
+    }
+
+    void EvalTest::run(bool keepSamples) {
+        const uint64_t numGames = this->gameStarts.size() - 1;
+        const uint64_t numChunks = (numGames + GAME_CHUNK_SIZE - 1) / GAME_CHUNK_SIZE;
+
+        std::vector<std::vector<Sample>> chunkSamples(keepSamples ? numChunks : 0);
+        std::vector<std::array<PhaseError, engine::eval::NUM_PHASES>> threadErrors(this->numThreads);
+        std::atomic<uint64_t> nextChunk = 0;
+        std::vector<std::thread> threads;
+        threads.reserve(this->numThreads);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int t = 0; t < this->numThreads; ++t) {
+            threads.emplace_back([&, t]() {
+                auto &errors = threadErrors[t];
+
+                // evaluations of the current game, until its final score is known
+                int predicted[WthorDatabase::MAX_MOVES];
+                int numDiscs[WthorDatabase::MAX_MOVES];
+                bool isBlack[WthorDatabase::MAX_MOVES];
+
+                for (auto chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+                    const auto lastGame = std::min(numGames, (chunk + 1) * GAME_CHUNK_SIZE);
+                    for (auto g = chunk * GAME_CHUNK_SIZE; g < lastGame; ++g) {
+                        engine::SearchNode node{Board()};
+                        node.evalFeatures.set_weights(this->weights.get());
+
+                        int numPositions = 0;
+                        bool isBlackToMove = true;
+                        for (auto i = this->gameStarts[g]; i < this->gameStarts[g + 1]; ++i) {
+                            if (node.board.get_legal_moves() == 0) {
+                                node.pass();
+                                isBlackToMove = !isBlackToMove;
+                            }
+                            node.play_move(Move(node.board, this->moves[i]));
+                            isBlackToMove = !isBlackToMove;
+
+                            if (node.board.is_terminal())
+                                continue;
+                            predicted[numPositions] = node.evalFeatures.mid_evaluate(&node);
+                            numDiscs[numPositions] = node.discCount;
+                            isBlack[numPositions++] = isBlackToMove;
+                        }
+
+                        // the game ends on a finished position, scored for the side to move
+                        const int blackScore = isBlackToMove ? node.board.get_disc_difference()
+                                                             : -node.board.get_disc_difference();
+
+                        for (int i = 0; i < numPositions; ++i) {
+                            const int actual = isBlack[i] ? blackScore : -blackScore;
+                            const double error = predicted[i] - actual;
+                            auto &phaseError = errors[engine::eval::get_phase(numDiscs[i])];
+                            ++phaseError.numPositions;
+                            phaseError.sumSquaredError += error * error;
+                            phaseError.sumAbsoluteError += std::fabs(error);
+                            phaseError.sumError += error;
+
+                            if (keepSamples)
+                                chunkSamples[chunk].push_back({(uint32_t)g, (uint8_t)numDiscs[i], (int8_t)actual,
+                                                               (int16_t)predicted[i]});
+                        }
+                    }
+                }
+            });
+        }
+        for (auto &thread: threads)
+            thread.join();
+        auto end = std::chrono::high_resolution_clock::now();
+        this->duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+        this->total = PhaseError();
+        for (int p = 0; p < engine::eval::NUM_PHASES; ++p) {
+            this->phaseErrors[p] = PhaseError();
+            for (auto &errors: threadErrors) {
+                this->phaseErrors[p].numPositions += errors[p].numPositions;
+                this->phaseErrors[p].sumSquaredError += errors[p].sumSquaredError;
+                this->phaseErrors[p].sumAbsoluteError += errors[p].sumAbsoluteError;
+                this->phaseErrors[p].sumError += errors[p].sumError;
+            }
+            this->total.numPositions += this->phaseErrors[p].numPositions;
+            this->total.sumSquaredError += this->phaseErrors[p].sumSquaredError;
+            this->total.sumAbsoluteError += this->phaseErrors[p].sumAbsoluteError;
+            this->total.sumError += this->phaseErrors[p].sumError;
+        }
+
+        // chunks are kept apart so the samples stay in the order of the games
+        this->samples.clear();
+        this->samples.reserve(keepSamples ? this->total.numPositions : 0);
+        for (auto &chunk: chunkSamples)
+            this->samples.insert(this->samples.end(), chunk.begin(), chunk.end());
+    }
+
+    void EvalTest::print_results() const {
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Phase\tPositions\tRMSE\tMAE\tBias" << std::endl;
+        for (int p = 0; p < engine::eval::NUM_PHASES; ++p) {
+            auto &e = this->phaseErrors[p];
+            std::cout << p << "\t" << e.numPositions << "\t\t" << e.get_rmse() << "\t" << e.get_mae() << "\t"
+                      << e.get_bias() << std::endl;
+        }
+        std::cout << "all\t" << this->total.numPositions << "\t\t" << this->total.get_rmse() << "\t"
+                  << this->total.get_mae() << "\t" << this->total.get_bias() << std::endl;
+
+        auto seconds = (double)this->duration / 1e6;
+        std::cout << std::setprecision(0) << (seconds > 0 ? (double)this->total.numPositions / seconds : 0)
+                  << " positions/s on " << this->numThreads << " threads" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+
+    void EvalTest::write_json(std::ostream &os) const {
+        auto seconds = (double)this->duration / 1e6;
+        auto writeError = [&os](const PhaseError &e) {
+            os << "\"positions\": " << e.numPositions << ", \"rmse\": " << e.get_rmse() << ", \"mae\": "
+               << e.get_mae() << ", \"bias\": " << e.get_bias();
+        };
+
+        // one phase per line keeps the output easy to diff
+        os << std::fixed << std::setprecision(4);
+        os << "{\n";
+        os << "  \"games\": {\"file\": \"" << this->gameFile << "\", \"count\": " << this->gameStarts.size() - 1
+           << "},\n";
+        os << "  \"weights\": \"" << (this->weightFile.empty() ? std::string(WEIGHT_FILEPATH) : this->weightFile)
+           << "\",\n";
+        os << "  \"threads\": " << this->numThreads << ",\n";
+        os << "  \"time_ms\": " << (double)this->duration / 1000 << ",\n";
+        os << "  \"positions_per_sec\": " << (seconds > 0 ? (double)this->total.numPositions / seconds : 0) << ",\n";
+        os << "  \"total\": {";
+        writeError(this->total);
+        os << "},\n";
+        os << "  \"phases\": [\n";
+        for (int p = 0; p < engine::eval::NUM_PHASES; ++p) {
+            os << "    {\"phase\": " << p << ", ";
+            writeError(this->phaseErrors[p]);
+            os << "}" << (p + 1 < engine::eval::NUM_PHASES ? ",\n" : "\n");
+        }
+        os << "  ]\n";
+        os << "}" << std::endl;
+    }
+
+    void EvalTest::write_csv(std::ostream &os) const {
+        os << "game,discs,phase,actual,predicted\n";
+        for (auto &sample: this->samples)
+            os << sample.game << ',' << (int)sample.numDiscs << ',' << engine::eval::get_phase(sample.numDiscs) << ','
+               << (int)sample.actual << ',' << sample.predicted << '\n';
+        os.flush();
+    }
+}
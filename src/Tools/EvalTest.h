@@ -0,0 +1,96 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_EVALTEST_H
+#define OTHELLO_EVALTEST_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../Engine/Engine.h"
+
+namespace tools {
+
+    /**
+     * @brief error of the evaluation over the positions of one phase, in discs
+     */
+    struct PhaseError {
+        long long numPositions = 0;
+        double sumSquaredError = 0;
+        double sumAbsoluteError = 0;
+        double sumError = 0;
+
+        [[nodiscard]] double get_rmse() const;
+        [[nodiscard]] double get_mae() const;
+        [[nodiscard]] double get_bias() const;  // mean of evaluation - final score
+    };
+
+    /**
+     * @brief measures how well the evaluation predicts the final score of a set of held-out games, without a window.
+     *
+     * Every game is replayed through a search node, so the features are updated incrementally and each position is
+     * scored by EvaluationFeatures::mid_evaluate, the same code and the same weights the search uses. Games are split
+     * between threads in chunks. Finished positions are skipped, since the search never evaluates them.
+     */
+    class EvalTest {
+    public:
+        /**
+         * @param numThreads: number of threads
+         */
+        explicit EvalTest(int numThreads);
+
+        /**
+         * @brief evaluate with other weights than the default ones
+         * @param filepath: midgame weight file
+         * @return whether the weights were loaded
+         */
+        bool load_weights(const std::string& filepath);
+
+        /**
+         * @brief read the games to test on
+         * @param filepath: a transcript file (one game per line, like f5d6c3...) or a WTHOR database (.wtb)
+         * @return whether the file was read
+         */
+        bool load_games(const std::string& filepath);
+
+        /**
+         * @brief evaluate every position of every game
+         * @param keepSamples: keep each position's evaluation for write_csv
+         */
+        void run(bool keepSamples = false);
+
+        void print_results() const;
+        void write_json(std::ostream& os) const;
+
+        /**
+         * @brief write one line per position: game, disc count, phase, final score and evaluation, both for the
+         * side to move. Needs run(true)
+         */
+        void write_csv(std::ostream& os) const;
+
+    private:
+        struct Sample {
+            uint32_t game;
+            uint8_t numDiscs;
+            int8_t actual;
+            int16_t predicted;
+        };
+
+        int numThreads;
+        std::string gameFile;
+        std::string weightFile;
+        std::unique_ptr<engine::eval::EvaluationWeights> weights;  // nullptr for the default weights
+
+        std::vector<uint8_t> moves;        // the squares of every game, passes left out
+        std::vector<uint64_t> gameStarts;  // the moves of game i are [gameStarts[i], gameStarts[i + 1])
+
+        PhaseError phaseErrors[engine::eval::NUM_PHASES];
+        PhaseError total;
+        std::vector<Sample> samples;
+        long long duration = 0;  // microseconds
+    };
+}
+
+#endif //OTHELLO_EVALTEST_H
@@ -0,0 +1,82 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "EvalTest.h"
+#include "../Init.h"
+
+/**
+ * usage: OthelloEvalTest --games PATH [--weights PATH] [--threads N] [--json PATH] [--csv PATH]
+ *
+ * --games is a transcript file, a logbook or a WTHOR database of games that weren't trained on. The results are
+ * written as JSON to --json, or to stdout if it isn't given.
+ */
+int main(int argc, char *argv[]) {
+    std::string gamesPath;
+    std::string weightPath;
+    std::string jsonPath;
+    std::string csvPath;
+    int numThreads = (int)std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        if (arg == "--games")
+            gamesPath = argv[++i];
+        else if (arg == "--weights")
+            weightPath = argv[++i];
+        else if (arg == "--threads")
+            numThreads = std::stoi(argv[++i]);
+        else if (arg == "--json")
+            jsonPath = argv[++i];
+        else if (arg == "--csv")
+            csvPath = argv[++i];
+        else {
+            std::cerr << "unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (gamesPath.empty()) {
+        std::cerr << "missing --games" << std::endl;
+        return 1;
+    }
+
+    init();
+
+    tools::EvalTest test(numThreads);
+    if (!weightPath.empty() && !test.load_weights(weightPath))
+        return 1;
+    if (!test.load_games(gamesPath))
+        return 1;
+    test.run(!csvPath.empty());
+
+    if (jsonPath.empty()) {
+        test.write_json(std::cout);
+    } else {
+        test.print_results();
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "could not open " << jsonPath << std::endl;
+            return 1;
+        }
+        test.write_json(out);
+    }
+
+    if (!csvPath.empty()) {
+        std::ofstream out(csvPath);
+        if (!out) {
+            std::cerr << "could not open " << csvPath << std::endl;
+            return 1;
+        }
+        test.write_csv(out);
+    }
+    return 0;
+}
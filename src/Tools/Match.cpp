@@ -0,0 +1,352 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "Match.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <set>
+
+namespace tools {
+    constexpr int REPORT_INTERVAL = 10;  // games between progress reports and transcript checkpoints
+
+    static inline double elo_to_score(double elo) {
+        return 1 / (1 + std::pow(10, -elo / 400));
+    }
+
+    static inline double score_to_elo(double score) {
+        score = std::clamp(score, 1e-6, 1 - 1e-6);
+        return -400 * std::log10(1 / score - 1);
+    }
+
+    double MatchScore::get_score() const {
+        auto numGames = this->get_num_games();
+        return numGames > 0 ? (this->wins + 0.5 * this->draws) / numGames : 0.5;
+    }
+
+    double MatchScore::get_variance() const {
+        auto numGames = this->get_num_games();
+        if (numGames == 0)
+            return 0;
+
+        auto s = this->get_score();
+        return (this->wins * (1 - s) * (1 - s) + this->draws * (0.5 - s) * (0.5 - s) + this->losses * s * s) / numGames;
+    }
+
+    double MatchScore::get_elo(double *margin) const {
+        auto s = this->get_score();
+        auto error = 1.96 * std::sqrt(this->get_variance() / std::max(1, this->get_num_games()));
+        *margin = (score_to_elo(s + error) - score_to_elo(s - error)) / 2;
+        return score_to_elo(s);
+    }
+
+    double MatchScore::get_llr(double elo0, double elo1) const {
+        auto variance = this->get_variance();
+        if (variance == 0)
+            return 0;
+
+        auto s0 = elo_to_score(elo0);
+        auto s1 = elo_to_score(elo1);
+        return this->get_num_games() * (s1 - s0) * (2 * this->get_score() - s0 - s1) / (2 * variance);
+    }
+
+    Match::Match(MatchPlayer playerA, MatchPlayer playerB, int numGames, int numThreads, long long maxNodes,
+                 double maxTime, uint64_t seed) :
+            players{std::move(playerA), std::move(playerB)},
+            numGames((std::max(2, numGames) + 1) & ~1),
+            numThreads(std::max(1, numThreads)),
+            maxNodes(maxNodes),
+            maxTime(maxTime),
+            seed(seed) {
+        this->set_sprt(0, 5, 0.05, 0.05);
+    }
+
+    void Match::set_sprt(double elo0, double elo1, double alpha, double beta) {
+        this->elo0 = elo0;
+        this->elo1 = elo1;
+        this->lowerBound = std::log(beta / (1 - alpha));
+        this->upperBound = std::log((1 - beta) / alpha);
+    }
+
+    bool Match::load_players() {
+        for (int i = 0; i < 2; ++i) {
+            if (!this->players[i].weightPath.empty()) {
+                auto weights = std::make_shared<engine::eval::EvaluationWeights>();
+                if (!weights->load(this->players[i].weightPath))
+                    return false;
+                this->weights[i] = weights;
+            }
+            if (!this->players[i].bookPath.empty()) {
+                auto book = std::make_shared<engine::OpeningBook>();
+                if (!book->load(this->players[i].bookPath))
+                    return false;
+                this->books[i] = book;
+            }
+        }
+        return true;
+    }
+
+    bool Match::load_openings(const std::string &filepath, int numPlies, int depth, int window) {
+        this->openings.clear();
+
+        std::ifstream file(filepath);
+        if (file.is_open()) {
+            std::string line;
+            while (std::getline(file, line)) {
+                Board board;
+                std::vector<uint8_t> opening;
+                for (size_t i = 0; i + 1 < line.size(); i += 2) {
+                    if (board.get_legal_moves() == 0)
+                        board.pass();
+
+                    uint_fast8_t x = std::tolower(line[i]) - 'a' + ((line[i + 1] - '1') << 3);
+                    if (x >= 64 || !(board.get_legal_moves() & (1ULL << x))) {
+                        std::cerr << "illegal opening " << line << std::endl;
+                        return false;
+                    }
+                    board.play_move(x);
+                    opening.push_back(x);
+                }
+                if (!opening.empty())
+                    this->openings.push_back(opening);
+            }
+            std::cout << "read " << this->openings.size() << " openings from " << filepath << std::endl;
+        } else {
+            this->generate_openings(numPlies, depth, window);
+
+            std::ofstream out(filepath);
+            for (auto &opening: this->openings) {
+                for (auto x: opening)
+                    out << (char)('a' + (x & 7)) << (char)('1' + (x >> 3));
+                out << '\n';
+            }
+            if (!out) {
+                std::cerr << "could not write " << filepath << std::endl;
+                return false;
+            }
+            std::cout << "wrote " << this->openings.size() << " openings to " << filepath << std::endl;
+        }
+
+        // play the openings in a different order for each seed, so that short matches don't all start the same way
+        std::mt19937_64 rng(this->seed);
+        std::shuffle(this->openings.begin(), this->openings.end(), rng);
+        return !this->openings.empty();
+    }
+
+    void Match::generate_openings(int numPlies, int depth, int window) {
+        // every position after numPlies moves, up to symmetry
+        std::vector<std::vector<uint8_t>> candidates;
+        std::set<std::pair<uint64_t, uint64_t>> seen;
+        std::vector<uint8_t> line;
+        std::function<void(const Board&)> expand = [&](const Board &board) {
+            if ((int)line.size() == numPlies) {
+                int symmetry;
+                auto canonical = engine::OpeningBook::canonicalize(board, &symmetry);
+                if (seen.emplace(canonical.P, canonical.O).second)
+                    candidates.push_back(line);
+                return;
+            }
+
+            auto legalMask = board.get_legal_moves();
+            for (auto mask = bit::lsb(legalMask); legalMask; mask = bit::next_set_bit(legalMask)) {
+                auto x = bit::bitboard_to_coord(mask);
+                line.push_back(x);
+                expand(board.move_and_copy(x));
+                line.pop_back();
+            }
+        };
+        expand(Board());
+        std::cout << "scoring " << candidates.size() << " openings of " << numPlies << " moves at depth " << depth
+                  << std::endl;
+
+        // keep the ones that are about even. One byte per opening, since the threads write neighbouring entries at once
+        std::vector<uint8_t> isBalanced(candidates.size());
+        std::atomic<size_t> next = 0;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < this->numThreads; ++i) {
+            threads.emplace_back([&]() {
+                engine::Engine engine(20);
+                for (auto j = next++; j < candidates.size(); j = next++) {
+                    Board board;
+                    for (auto x: candidates[j])
+                        board.play_move(x);
+
+                    engine::SearchLimits limits;
+                    limits.set_depth_limit(depth);
+                    auto result = engine.search(Game(board), limits, engine::Engine::Verbose::NONE);
+                    isBalanced[j] = std::abs(result.value) <= window;
+                }
+            });
+        }
+        for (auto &thread: threads)
+            thread.join();
+
+        for (size_t j = 0; j < candidates.size(); ++j)
+            if (isBalanced[j])
+                this->openings.push_back(candidates[j]);
+    }
+
+    MatchScore Match::run(const std::string &transcriptPath) {
+        this->nextGame = 0;
+        this->stopping = false;
+        this->score = MatchScore();
+        this->transcripts.clear();
+        this->transcriptPath = transcriptPath;
+
+        std::cout << "\033[1m" << this->players[0].name << " vs " << this->players[1].name << ":\033[0m up to "
+                  << this->numGames << " games from " << this->openings.size() << " openings, ";
+        if (this->maxTime > 0)
+            std::cout << this->maxTime << "s per move";
+        else
+            std::cout << this->maxNodes << " nodes per move";
+        std::cout << ", SPRT elo0 = " << this->elo0 << ", elo1 = " << this->elo1 << std::endl;
+        for (auto &player: this->players)
+            std::cout << player.name << ": " << player.searchOptions.to_string() << std::endl;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < this->numThreads; ++i)
+            threads.emplace_back(&Match::worker, this);
+        for (auto &thread: threads)
+            thread.join();
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->report();
+        this->write_transcripts();
+        return this->score;
+    }
+
+    void Match::stop() {
+        this->stopping = true;
+    }
+
+    void Match::worker() {
+        engine::Engine engines[2] = {engine::Engine(this->players[0].numHashBits),
+                                     engine::Engine(this->players[1].numHashBits)};
+        for (int i = 0; i < 2; ++i) {
+            engines[i].set_evaluation_weights(this->weights[i]);
+            engines[i].set_opening_book(this->books[i]);
+            engines[i].set_search_options(this->players[i].searchOptions);
+        }
+
+        while (!this->stopping) {
+            int game = this->nextGame++;
+            if (game >= this->numGames)
+                break;
+
+            // both games of an opening are played back to back, with A as black in the first one
+            auto &opening = this->openings[(game / 2) % this->openings.size()];
+            bool isABlack = (game & 1) == 0;
+            engines[0].clear_transposition_table();
+            engines[1].clear_transposition_table();
+
+            std::string transcript;
+            auto blackDifference = isABlack ? this->play_game(engines[0], engines[1], opening, transcript)
+                                            : this->play_game(engines[1], engines[0], opening, transcript);
+            auto difference = isABlack ? blackDifference : -blackDifference;
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (difference > 0)
+                ++this->score.wins;
+            else if (difference < 0)
+                ++this->score.losses;
+            else
+                ++this->score.draws;
+            this->transcripts.push_back(transcript);
+
+            auto llr = this->score.get_llr(this->elo0, this->elo1);
+            bool isDecided = llr <= this->lowerBound || llr >= this->upperBound;
+            if (this->score.get_num_games() % REPORT_INTERVAL == 0 || isDecided) {
+                this->report();
+                this->write_transcripts();
+            }
+            if (isDecided)
+                this->stopping = true;
+        }
+    }
+
+    int Match::play_game(engine::Engine &black, engine::Engine &white, const std::vector<uint8_t> &opening,
+                         std::string &transcript) const {
+        Board board;
+        bool isBlackToMove = true;
+        auto play = [&](uint_fast8_t x) {
+            board.play_move(x);
+            transcript += (char)('a' + (x & 7));
+            transcript += (char)('1' + (x >> 3));
+            isBlackToMove = !isBlackToMove;
+        };
+
+        for (auto x: opening) {
+            if (board.get_legal_moves() == 0) {
+                board.pass();
+                isBlackToMove = !isBlackToMove;
+            }
+            play(x);
+        }
+
+        while (!board.is_terminal()) {
+            auto legalMask = board.get_legal_moves();
+            if (legalMask == 0) {
+                board.pass();
+                isBlackToMove = !isBlackToMove;
+                continue;
+            }
+
+            auto &engine = isBlackToMove ? black : white;
+            engine::SearchLimits limits(this->maxTime > 0 ? this->maxTime : -1, MAX_DEPTH,
+                                        this->maxTime > 0 ? engine::SearchLimits::NO_NODE_LIMIT : this->maxNodes);
+
+            auto result = engine.search(Game(board), limits, engine::Engine::Verbose::NONE);
+            auto x = (uint_fast8_t)result.move.x;
+            if (x >= 64 || !(legalMask & (1ULL << x))) {
+                // the side that played it forfeits with the largest possible loss
+                std::cerr << "illegal move " << result.move << " by " << (isBlackToMove ? "black" : "white")
+                          << " in game " << transcript << ", scored as a forfeit" << std::endl;
+                return isBlackToMove ? -SCORE_MAX : SCORE_MAX;
+            }
+
+            play(x);
+            black.update();
+            white.update();
+        }
+
+        return isBlackToMove ? board.get_disc_difference() : -board.get_disc_difference();
+    }
+
+    void Match::report() {
+        double margin;
+        auto elo = this->score.get_elo(&margin);
+        auto llr = this->score.get_llr(this->elo0, this->elo1);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "games " << this->score.get_num_games()
+                  << ": +" << this->score.wins << " =" << this->score.draws << " -" << this->score.losses
+                  << ", score " << 100 * this->score.get_score() << "%"
+                  << ", elo " << elo << " +/- " << margin
+                  << ", LLR " << std::setprecision(2) << llr
+                  << " [" << this->lowerBound << ", " << this->upperBound << "]";
+        if (llr >= this->upperBound)
+            std::cout << " \033[1mH1 accepted\033[0m";
+        else if (llr <= this->lowerBound)
+            std::cout << " \033[1mH0 accepted\033[0m";
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    bool Match::write_transcripts() {
+        std::ofstream file(this->transcriptPath);
+        file << this->transcripts.size() << '\n';
+        for (auto &transcript: this->transcripts)
+            file << transcript << '\n';
+
+        if (!file) {
+            std::cerr << "could not write " << this->transcriptPath << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,153 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_MATCH_H
+#define OTHELLO_MATCH_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../Engine/Engine.h"
+
+namespace tools {
+
+    /**
+     * @brief one side of a match
+     */
+    struct MatchPlayer {
+        std::string name;
+        std::string weightPath;     // midgame weights. Empty for the default weights
+        std::string bookPath;       // opening book. Empty to play without a book
+        int numHashBits = 20;       // transposition table size, as a power of 2 number of entries
+        engine::SearchOptions searchOptions;
+    };
+
+    /**
+     * @brief wins, draws and losses of the first player of a match, with the statistics derived from them
+     */
+    struct MatchScore {
+        int wins = 0;
+        int draws = 0;
+        int losses = 0;
+
+        [[nodiscard]] inline int get_num_games() const {
+            return this->wins + this->draws + this->losses;
+        }
+
+        /** @return the mean score per game, a win being 1 and a draw 0.5 */
+        [[nodiscard]] double get_score() const;
+
+        /** @return the variance of the score of a single game */
+        [[nodiscard]] double get_variance() const;
+
+        /**
+         * @param margin: receives half the width of the 95% confidence interval
+         * @return the Elo difference implied by the score
+         */
+        [[nodiscard]] double get_elo(double *margin) const;
+
+        /**
+         * @brief log-likelihood ratio of H1: elo = elo1 against H0: elo = elo0, with the normal approximation of the
+         * game score used by fishtest
+         */
+        [[nodiscard]] double get_llr(double elo0, double elo1) const;
+    };
+
+    /**
+     * @brief plays games between two engine configurations to tell whether one is stronger.
+     *
+     * Every opening is played twice with the colours swapped, so that unbalanced openings cancel out. The games run in
+     * parallel, one per thread, and each thread has its own pair of engines. After every game the score, the Elo
+     * difference with its 95% interval and the log-likelihood ratio of a sequential probability ratio test are
+     * updated; the match stops once the test accepts either hypothesis or all games are played.
+     */
+    class Match {
+    public:
+        /**
+         * @param playerA: the first player, whose score is reported
+         * @param playerB: the second player
+         * @param numGames: maximum number of games. Rounded up to an even number, since openings are played in pairs
+         * @param numThreads: number of games played at the same time
+         * @param maxNodes: nodes per move, if maxTime is not positive
+         * @param maxTime: seconds per move
+         * @param seed: seed of the order of the openings
+         */
+        Match(MatchPlayer playerA, MatchPlayer playerB, int numGames, int numThreads, long long maxNodes, double maxTime,
+              uint64_t seed);
+
+        /**
+         * @brief set the hypotheses of the sequential probability ratio test
+         * @param elo0: Elo difference of H0
+         * @param elo1: Elo difference of H1
+         * @param alpha: probability of accepting H1 when H0 is true
+         * @param beta: probability of accepting H0 when H1 is true
+         */
+        void set_sprt(double elo0, double elo1, double alpha, double beta);
+
+        /**
+         * @brief load the weights and books of both players
+         * @return whether everything was loaded
+         */
+        bool load_players();
+
+        /**
+         * @brief read the openings from a file of move sequences (f5d6c3...), one per line. If the file doesn't exist,
+         * generate balanced openings and write them to it, so that later matches use the same set.
+         * @param filepath: openings file
+         * @param numPlies: number of moves of generated openings
+         * @param depth: search depth used to score generated openings
+         * @param window: generated openings are kept if their score is within [-window, window]
+         * @return whether there are openings to play
+         */
+        bool load_openings(const std::string &filepath, int numPlies, int depth, int window);
+
+        /**
+         * @brief play the match
+         * @param transcriptPath: every finished game is written to this file, in the transcript format
+         * @return the final score of the first player
+         */
+        MatchScore run(const std::string &transcriptPath);
+
+        /**
+         * @brief don't start any more games. The games being played are finished. Safe to call from any thread.
+         */
+        void stop();
+
+    private:
+        void worker();
+        int play_game(engine::Engine &black, engine::Engine &white, const std::vector<uint8_t> &opening,
+                      std::string &transcript) const;
+        void generate_openings(int numPlies, int depth, int window);
+        void report();
+        bool write_transcripts();
+
+        MatchPlayer players[2];
+        std::shared_ptr<const engine::eval::EvaluationWeights> weights[2];
+        std::shared_ptr<const engine::OpeningBook> books[2];
+
+        int numGames;
+        int numThreads;
+        long long maxNodes;
+        double maxTime;
+        uint64_t seed;
+
+        double elo0 = 0;
+        double elo1 = 5;
+        double lowerBound;  // accept H0 below this log-likelihood ratio
+        double upperBound;  // accept H1 above it
+
+        std::vector<std::vector<uint8_t>> openings;
+
+        std::mutex mutex;
+        std::atomic<int> nextGame = 0;
+        std::atomic<bool> stopping = false;
+        MatchScore score;
+        std::vector<std::string> transcripts;
+        std::string transcriptPath;
+    };
+}
+
+#endif //OTHELLO_MATCH_H
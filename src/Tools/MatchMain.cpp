@@ -0,0 +1,121 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include "Match.h"
+#include "../Init.h"
+
+/**
+ * usage: OthelloMatch [--name-a NAME] [--weights-a PATH] [--book-a PATH] [--hash-bits-a N]
+ *                     [--name-b NAME] [--weights-b PATH] [--book-b PATH] [--hash-bits-b N]
+ *                     [--mpc-a on|off] [--etc-a on|off] [--lock-tt-a on|off] [--mpc-depth-a N] [--etc-depth-a N]
+ *                     [--mpc-b on|off] [--etc-b on|off] [--lock-tt-b on|off] [--mpc-depth-b N] [--etc-depth-b N]
+ *                     [--games N] [--threads N] [--nodes N] [--time SECONDS] [--seed N]
+ *                     [--openings PATH] [--opening-ply N] [--opening-depth N] [--opening-window N]
+ *                     [--elo0 ELO] [--elo1 ELO] [--alpha P] [--beta P] [--out PATH]
+ *
+ * Empty weight or book paths mean the default weights and no book.
+ */
+int main(int argc, char *argv[]) {
+    tools::MatchPlayer players[2];
+    players[0].name = "A";
+    players[1].name = "B";
+    int numGames = 1000;
+    int numThreads = (int)std::thread::hardware_concurrency();
+    long long maxNodes = 200000;
+    double maxTime = 0;
+    uint64_t seed = 0;
+    std::string openingsPath = OPENINGS_FILEPATH;
+    int openingPly = 8;
+    int openingDepth = 12;
+    int openingWindow = 4;
+    double elo0 = 0;
+    double elo1 = 5;
+    double alpha = 0.05;
+    double beta = 0.05;
+    std::string outPath = "match.txt";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        // per-player flags end in -a or -b
+        auto *player = arg.ends_with("-a") ? &players[0] : arg.ends_with("-b") ? &players[1] : nullptr;
+        auto name = player ? arg.substr(0, arg.size() - 2) : arg;
+
+        if (player && name == "--name")
+            player->name = argv[++i];
+        else if (player && name == "--weights")
+            player->weightPath = argv[++i];
+        else if (player && name == "--book")
+            player->bookPath = argv[++i];
+        else if (player && name == "--hash-bits")
+            player->numHashBits = std::stoi(argv[++i]);
+        else if (player && player->searchOptions.set(name.substr(2), argv[i + 1]))
+            ++i;
+        else if (arg == "--games")
+            numGames = std::stoi(argv[++i]);
+        else if (arg == "--threads")
+            numThreads = std::stoi(argv[++i]);
+        else if (arg == "--nodes")
+            maxNodes = std::stoll(argv[++i]);
+        else if (arg == "--time")
+            maxTime = std::stod(argv[++i]);
+        else if (arg == "--seed")
+            seed = std::stoull(argv[++i]);
+        else if (arg == "--openings")
+            openingsPath = argv[++i];
+        else if (arg == "--opening-ply")
+            openingPly = std::stoi(argv[++i]);
+        else if (arg == "--opening-depth")
+            openingDepth = std::stoi(argv[++i]);
+        else if (arg == "--opening-window")
+            openingWindow = std::stoi(argv[++i]);
+        else if (arg == "--elo0")
+            elo0 = std::stod(argv[++i]);
+        else if (arg == "--elo1")
+            elo1 = std::stod(argv[++i]);
+        else if (arg == "--alpha")
+            alpha = std::stod(argv[++i]);
+        else if (arg == "--beta")
+            beta = std::stod(argv[++i]);
+        else if (arg == "--out")
+            outPath = argv[++i];
+        else {
+            std::cerr << "unknown argument or invalid value " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    init();
+
+    tools::Match match(players[0], players[1], numGames, numThreads, maxNodes, maxTime, seed);
+    match.set_sprt(elo0, elo1, alpha, beta);
+    if (!match.load_players() || !match.load_openings(openingsPath, openingPly, openingDepth, openingWindow))
+        return 1;
+
+    // on ctrl-c, finish the games being played and write the transcripts. The signals are blocked in every thread and
+    // taken by a thread of their own, since stop() isn't safe in a signal handler.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread([&match, signals]() {
+        int signal;
+        sigwait(&signals, &signal);
+        std::cout << "stopping..." << std::endl;
+        match.stop();
+    }).detach();
+
+    match.run(outPath);
+    return 0;
+}
@@ -0,0 +1,88 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "../Engine/Search/ProbCutModel.h"
+#include "../Init.h"
+
+/**
+ * usage: OthelloProbCut [--games N] [--threads N] [--depth N] [--hash-bits N] [--samples PATH] [--out PATH]
+ *                       [--min-count N] [--fit-only 0|1]
+ *
+ * Plays --games random games, searching every position to each depth up to --depth, and writes the values to
+ * --samples. The ProbCut error model is then fitted to them and written to --out, which the engine reads at startup.
+ * With --fit-only 1, the model is fitted to the samples already in --samples.
+ */
+int main(int argc, char *argv[]) {
+    int numGames = 1000;
+    int numThreads = (int)std::thread::hardware_concurrency();
+    int maxDepth = 14;
+    int numHashBits = 18;
+    int minCount = 30;
+    bool fitOnly = false;
+    std::string samplePath = MPC_DATA_FILEPATH;
+    std::string outputPath = PROBCUT_PARAMS_FILEPATH;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        if (arg == "--games")
+            numGames = std::stoi(argv[++i]);
+        else if (arg == "--threads")
+            numThreads = std::stoi(argv[++i]);
+        else if (arg == "--depth")
+            maxDepth = std::stoi(argv[++i]);
+        else if (arg == "--hash-bits")
+            numHashBits = std::stoi(argv[++i]);
+        else if (arg == "--samples")
+            samplePath = argv[++i];
+        else if (arg == "--out")
+            outputPath = argv[++i];
+        else if (arg == "--min-count")
+            minCount = std::stoi(argv[++i]);
+        else if (arg == "--fit-only")
+            fitOnly = std::stoi(argv[++i]) != 0;
+        else {
+            std::cerr << "unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    init();
+
+    if (!fitOnly && !engine::Engine::collect_prob_cut_data(numGames, numThreads, maxDepth, samplePath, numHashBits))
+        return 1;
+
+    std::vector<engine::ProbCutSample> samples;
+    if (!engine::ProbCutModel::read_samples(samplePath, samples))
+        return 1;
+
+    // start from the current parameters, and keep their t values
+    engine::ProbCutModel model;
+    if (std::filesystem::exists(outputPath) && !model.load(outputPath))
+        return 1;
+
+    double rmse = 0;
+    int numPairs = 0;
+    auto numObservations = model.fit(samples, minCount, &rmse, &numPairs);
+    if (numObservations == 0) {
+        std::cerr << "not enough samples to fit the ProbCut model" << std::endl;
+        return 1;
+    }
+
+    auto summary = "fitted on " + std::to_string(numObservations) + " observations in " + std::to_string(numPairs) +
+                   " disc count and depth pairs of " + std::to_string(samples.size()) + " positions, weighted RMSE " +
+                   std::to_string(rmse);
+    std::cout << summary << std::endl;
+    for (int i = 0; i < engine::ProbCutModel::NUM_COEFFICIENTS; ++i)
+        std::cout << engine::ProbCutModel::COEFFICIENT_NAMES[i] << " = " << model.coefficients[i] << std::endl;
+    return model.save(outputPath, summary) ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include "SelfPlay.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "../Engine/Evaluation/EvalBuilder.h"
+#include "../Engine/Evaluation/MoveDataset.h"
+
+namespace tools {
+    constexpr const char *FILE_PREFIX = "selfplay-";
+
+    SelfPlay::SelfPlay(std::string outputDirectory, int numThreads, int numHashBits, int depth, int exactDepth,
+                       int numRandomMoves, int gamesPerFile, uint64_t seed, bool writeMoves) :
+            outputDirectory(std::move(outputDirectory)),
+            numThreads(std::max(1, numThreads)),
+            numHashBits(numHashBits),
+            depth(std::max(1, depth)),
+            exactDepth(exactDepth),
+            numRandomMoves(numRandomMoves),
+            gamesPerFile(std::max(1, gamesPerFile)),
+            seed(seed),
+            writeMoves(writeMoves) {}
+
+    void SelfPlay::run(long long numGames) {
+        this->numGames = numGames;
+        this->nextGame = 0;
+        this->nextFile = this->get_first_file_index();
+        this->stopping = false;
+        this->numGamesWritten = 0;
+        this->numPositionsWritten = 0;
+        this->numGamesDiscarded = 0;
+        this->start = std::chrono::steady_clock::now();
+
+        std::cout << "\033[1mSelf-play:\033[0m " << numGames << " games on " << this->numThreads << " threads, depth "
+                  << this->depth << ", solved from " << this->exactDepth << " empties, " << this->numRandomMoves
+                  << " random moves" << std::endl;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < this->numThreads; ++i)
+            threads.emplace_back(&SelfPlay::worker, this, i);
+        for (auto &thread: threads)
+            thread.join();
+
+        // the games left over after the last full file
+        std::vector<std::string> games;
+        games.swap(this->pending);
+        if (!games.empty())
+            this->write_file(games);
+
+        std::cout << "\033[1mSelf-play done:\033[0m " << this->numGamesWritten << " games, "
+                  << this->numPositionsWritten << " positions written, " << this->numGamesDiscarded
+                  << " games discarded" << std::endl;
+    }
+
+    void SelfPlay::stop() {
+        this->stopping = true;
+    }
+
+    void SelfPlay::worker(int id) {
+        engine::Engine engine(this->numHashBits);
+        std::mt19937_64 rng(this->seed + id);
+
+        while (!this->stopping && this->nextGame++ < this->numGames) {
+            std::string transcript;
+            if (!this->play_game(engine, rng, transcript)) {
+                ++this->numGamesDiscarded;
+                continue;
+            }
+
+            std::vector<std::string> games;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->pending.push_back(std::move(transcript));
+                if ((int)this->pending.size() >= this->gamesPerFile)
+                    games.swap(this->pending);
+            }
+
+            // computing the features takes a while, so don't hold up the other threads
+            if (!games.empty())
+                this->write_file(games);
+        }
+    }
+
+    bool SelfPlay::play_game(engine::Engine &engine, std::mt19937_64 &rng, std::string &transcript) const {
+        Board board;
+        transcript.reserve(120);
+
+        for (int ply = 0; !board.is_terminal(); ++ply) {
+            auto legalMask = board.get_legal_moves();
+            if (legalMask == 0) {
+                board.pass();
+                continue;
+            }
+
+            uint_fast8_t x;
+            if (ply < this->numRandomMoves) {
+                // pick the n-th legal move
+                auto n = std::uniform_int_distribution<int>(0, __builtin_popcountll(legalMask) - 1)(rng);
+                auto mask = bit::lsb(legalMask);
+                while (n-- > 0)
+                    mask = bit::next_set_bit(legalMask);
+                x = bit::bitboard_to_coord(mask);
+            } else {
+                int numEmpty = 64 - board.get_disc_count();
+                engine::SearchLimits limits;
+                limits.set_depth_limit(numEmpty <= this->exactDepth ? numEmpty : this->depth);
+                auto result = engine.search(Game(board), limits, engine::Engine::Verbose::NONE);
+                x = (uint_fast8_t)result.move.x;
+                engine.update();
+                if (x >= 64 || !(legalMask & (1ULL << x))) {
+                    // the rest of the game would not be the engine's, so none of it is training data
+                    std::cerr << "illegal move " << result.move << " in game " << transcript << ", discarding it"
+                              << std::endl;
+                    return false;
+                }
+            }
+
+            board.play_move(x);
+            transcript += (char)('a' + (x & 7));
+            transcript += (char)('1' + (x >> 3));
+        }
+        return true;
+    }
+
+    void SelfPlay::write_file(std::vector<std::string> &games) {
+        std::ostringstream filepath;
+        filepath << this->outputDirectory << FILE_PREFIX << std::setfill('0') << std::setw(7) << this->nextFile++
+                 << this->get_extension();
+        bool isWritten = this->writeMoves ? engine::eval::MoveDataset::write(filepath.str(), games)
+                                          : engine::eval::EvalBuilder::write_games(filepath.str(), games);
+        if (!isWritten)
+            return;
+
+        long long numPositions = 0;
+        for (auto &game: games)
+            numPositions += (long long)game.size() / 2;
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->numGamesWritten += (long long)games.size();
+        this->numPositionsWritten += numPositions;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - this->start).count();
+        std::cout << "wrote " << filepath.str() << ": " << this->numGamesWritten << " games, "
+                  << this->numPositionsWritten << " positions, "
+                  << (long long)(3.6e6 * (double)this->numPositionsWritten / (double)std::max(1LL, (long long)elapsed))
+                  << " positions/hour" << std::endl;
+    }
+
+    int SelfPlay::get_first_file_index() const {
+        int index = 0;
+        std::error_code error;
+        for (auto &entry: std::filesystem::directory_iterator(this->outputDirectory, error)) {
+            auto name = entry.path().filename().string();
+            if (name.starts_with(FILE_PREFIX) && name.ends_with(this->get_extension()))
+                index = std::max(index, 1 + std::atoi(name.c_str() + std::strlen(FILE_PREFIX)));
+        }
+        return index;
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#ifndef OTHELLO_SELFPLAY_H
+#define OTHELLO_SELFPLAY_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "../Engine/Engine.h"
+
+namespace tools {
+
+    /**
+     * @brief generates training games for EvalBuilder by letting the engine play itself.
+     *
+     * Every game starts with a number of uniformly random moves so that the games cover positions humans don't play.
+     * After that, every move is a fixed-depth search, and once few enough squares are empty, the rest of the game is
+     * solved, so the final score is the exact value of the position the midgame search led to.
+     *
+     * Each thread plays games on its own engine. Finished games are collected in memory and written straight to a
+     * dataset file every gamesPerFile games, either in the feature format preprocess_transcripts produces or as a much
+     * smaller move dataset. Both can be given to EvalBuilder::train without any other step.
+     */
+    class SelfPlay {
+    public:
+        /**
+         * @param outputDirectory: directory of the dataset files. Numbering continues after the files already in it
+         * @param numThreads: number of games played at the same time
+         * @param numHashBits: transposition table size of each thread, as a power of 2 number of entries
+         * @param depth: midgame search depth
+         * @param exactDepth: number of empty squares from which the game is solved
+         * @param numRandomMoves: number of random moves at the start of every game
+         * @param gamesPerFile: number of games in each dataset file
+         * @param seed: seed of the random moves
+         * @param writeMoves: write move datasets instead of feature datasets
+         */
+        SelfPlay(std::string outputDirectory, int numThreads, int numHashBits, int depth, int exactDepth,
+                 int numRandomMoves, int gamesPerFile, uint64_t seed, bool writeMoves = false);
+
+        /**
+         * @brief play games until numGames are played or stop() is called, then write the last file
+         * @param numGames: number of games to play
+         */
+        void run(long long numGames);
+
+        /**
+         * @brief don't start any more games. The games being played are finished and written. Safe to call from any
+         * thread.
+         */
+        void stop();
+
+    private:
+        void worker(int id);
+        bool play_game(engine::Engine &engine, std::mt19937_64 &rng, std::string &transcript) const;
+        void write_file(std::vector<std::string> &games);
+        int get_first_file_index() const;
+
+        [[nodiscard]] inline const char *get_extension() const {
+            return this->writeMoves ? MOVE_DATASET_EXTENSION : ".bin";
+        }
+
+        std::string outputDirectory;
+        int numThreads;
+        int numHashBits;
+        int depth;
+        int exactDepth;
+        int numRandomMoves;
+        int gamesPerFile;
+        uint64_t seed;
+        bool writeMoves;
+
+        std::mutex mutex;
+        std::vector<std::string> pending;  // finished games that aren't written yet
+        std::atomic<long long> nextGame = 0;
+        std::atomic<long long> numGames = 0;
+        std::atomic<int> nextFile = 0;
+        std::atomic<bool> stopping = false;
+
+        std::atomic<long long> numGamesDiscarded = 0;  // games dropped because a search returned an illegal move
+
+        long long numGamesWritten = 0;
+        long long numPositionsWritten = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#endif //OTHELLO_SELFPLAY_H
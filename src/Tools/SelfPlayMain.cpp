@@ -0,0 +1,91 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include "SelfPlay.h"
+#include "../Engine/Evaluation/EvalBuilder.h"
+#include "../Init.h"
+
+/**
+ * usage: OthelloSelfPlay [--out DIRECTORY] [--games N] [--threads N] [--hash-bits N] [--depth N] [--exact N]
+ *                        [--random-moves N] [--games-per-file N] [--seed N] [--format features|moves]
+ */
+int main(int argc, char *argv[]) {
+    std::string outputDirectory = COMBINED_DATASET_DIRECTORY;
+    long long numGames = 1000000;
+    int numThreads = (int)std::thread::hardware_concurrency();
+    int numHashBits = 18;
+    int depth = 6;
+    int exactDepth = 12;
+    int numRandomMoves = 10;
+    int gamesPerFile = 10000;
+    uint64_t seed = std::random_device()();
+    std::string format = "features";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        if (arg == "--out")
+            outputDirectory = argv[++i];
+        else if (arg == "--games")
+            numGames = std::stoll(argv[++i]);
+        else if (arg == "--threads")
+            numThreads = std::stoi(argv[++i]);
+        else if (arg == "--hash-bits")
+            numHashBits = std::stoi(argv[++i]);
+        else if (arg == "--depth")
+            depth = std::stoi(argv[++i]);
+        else if (arg == "--exact")
+            exactDepth = std::stoi(argv[++i]);
+        else if (arg == "--random-moves")
+            numRandomMoves = std::stoi(argv[++i]);
+        else if (arg == "--games-per-file")
+            gamesPerFile = std::stoi(argv[++i]);
+        else if (arg == "--seed")
+            seed = std::stoull(argv[++i]);
+        else if (arg == "--format")
+            format = argv[++i];
+        else {
+            std::cerr << "unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (format != "features" && format != "moves") {
+        std::cerr << "unknown format " << format << std::endl;
+        return 1;
+    }
+    if (!outputDirectory.empty() && outputDirectory.back() != '/')
+        outputDirectory += '/';
+
+    init();
+    engine::eval::EvalBuilder::init();
+
+    tools::SelfPlay selfPlay(outputDirectory, numThreads, numHashBits, depth, exactDepth, numRandomMoves, gamesPerFile,
+                             seed, format == "moves");
+
+    // on ctrl-c, finish the games being played and write them instead of losing the last file. The signals are blocked
+    // in every thread and taken by a thread of their own, since stop() isn't safe in a signal handler.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread([&selfPlay, signals]() {
+        int signal;
+        sigwait(&signals, &signal);
+        std::cout << "stopping..." << std::endl;
+        selfPlay.stop();
+    }).detach();
+
+    selfPlay.run(numGames);
+    return 0;
+}
@@ -0,0 +1,71 @@
+//
+// Created by Benjamin Lee on 10/19/26.
+//
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include "../Engine/Evaluation/EvalBuilder.h"
+#include "../Init.h"
+
+/**
+ * usage: OthelloTrain --dataset NAME [--epochs N] [--batch-size N] [--threads N] [--optimizer adam|sgd] [--lr X]
+ *                     [--resume 0|1] [--position-store 0|1]
+ *
+ * With --position-store 0, a move dataset is replayed in every phase instead of being decoded into a position store.
+ */
+int main(int argc, char *argv[]) {
+    std::string dataset;
+    int numEpochs = 1000;
+    int batchSize = 256;
+    int numThreads = (int)std::thread::hardware_concurrency();
+    std::string optimizer = "adam";
+    float learningRate = 0.01;
+    bool resume = false;
+    bool usePositionStore = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+
+        if (arg == "--dataset")
+            dataset = argv[++i];
+        else if (arg == "--epochs")
+            numEpochs = std::stoi(argv[++i]);
+        else if (arg == "--batch-size")
+            batchSize = std::stoi(argv[++i]);
+        else if (arg == "--threads")
+            numThreads = std::stoi(argv[++i]);
+        else if (arg == "--optimizer")
+            optimizer = argv[++i];
+        else if (arg == "--lr")
+            learningRate = std::stof(argv[++i]);
+        else if (arg == "--resume")
+            resume = std::stoi(argv[++i]) != 0;
+        else if (arg == "--position-store")
+            usePositionStore = std::stoi(argv[++i]) != 0;
+        else {
+            std::cerr << "unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (dataset.empty()) {
+        std::cerr << "missing --dataset" << std::endl;
+        return 1;
+    }
+    if (optimizer != "adam" && optimizer != "sgd") {
+        std::cerr << "unknown optimizer " << optimizer << std::endl;
+        return 1;
+    }
+
+    auto rule = optimizer == "adam" ? engine::eval::SparseTrainer::Optimizer::ADAM
+                                    : engine::eval::SparseTrainer::Optimizer::SGD;
+
+    init();
+    engine::eval::EvalBuilder::train_sparse(dataset, numEpochs, batchSize, resume, true, numThreads, rule,
+                                            learningRate, usePositionStore);
+    return 0;
+}
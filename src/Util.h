@@ -8,6 +8,7 @@
 #include <string>
 #include <iostream>
 #include <cstdint>
+#include <chrono>
 
 namespace util {
     std::string format_time(long long duration, bool showMs = false);
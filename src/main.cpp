@@ -11,9 +11,13 @@
         QApplication app(argc, argv);
         std::cout << "Starting..." << std::endl;
         engine::eval::EvalBuilder::init();
-        //engine::eval::EvalBuilder::init_batches(8);
-        //engine::eval::EvalBuilder::combine_batches(8, 213, 1);
-        engine::eval::EvalBuilder::train("0000001.bin", 1000, 120000, true, true, 1);
+        //engine::eval::EvalBuilder::ingest_transcripts(8);
+        //engine::eval::EvalBuilder::combine_batches(8, 520, 1);
+        #if USE_TORCH
+            engine::eval::EvalBuilder::train("0000001.bin", 1000, 120000, true, true, 1);
+        #else
+            engine::eval::EvalBuilder::train_sparse("0000001.bin", 1000, 256, true, true);
+        #endif
 
         engine::eval::EvalBuilder::test(MODEL_NAME ".bin", "0000000.txt", "0");
         return QApplication::exec();
@@ -21,9 +25,7 @@
 #elif TUNE_PROBCUT
     int main() {
         init();
-        auto e = engine::Engine();
-        e.collect_prob_cut_data(1000, 6);
-        return 0;
+        return engine::Engine::collect_prob_cut_data(1000, 6, 14) ? 0 : 1;
     }
 #else
     int main(int argc, char *argv[]) {